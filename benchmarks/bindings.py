@@ -0,0 +1,50 @@
+"""
+Measure the cost of a call to the hottest DWARFDie bindings from Python:
+
+    python benchmarks/bindings.py build/CMakeFiles/dwarf2cpp-benchmark-fixture.dir/benchmarks/fixture.cpp.o
+
+Each accessor is called once for every DIE of the compile units, as BM_ShortName, BM_DeclFileName, BM_Children and
+BM_Attributes of dwarf2cpp-benchmark do in C++. The difference between both is the overhead of the bindings.
+"""
+
+import argparse
+import operator
+import time
+from pathlib import Path
+
+from dwarf2cpp import DWARFContext, DWARFDie
+
+ACCESSORS = ["short_name", "decl_file", "children", "attributes"]
+
+
+def collect(die: DWARFDie, dies: list[DWARFDie]) -> None:
+    dies.append(die)
+    for child in die.children:
+        collect(child, dies)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("path", type=Path, help="binary or object file with DWARF")
+    parser.add_argument("--min-time", type=float, default=0.5, help="seconds to run each accessor for")
+    args = parser.parse_args()
+
+    context = DWARFContext(str(args.path))
+    dies = []
+    for unit in context.compile_units:
+        collect(unit.unit_die, dies)
+
+    for name in ACCESSORS:
+        accessor = operator.attrgetter(name)
+        calls = 0
+        start = time.perf_counter()
+        while (elapsed := time.perf_counter() - start) < args.min_time:
+            for die in dies:
+                accessor(die)
+            calls += len(dies)
+
+        print(f"{name:<12} {elapsed / calls * 1e9:10.1f} ns/call")
+
+
+if __name__ == "__main__":
+    main()
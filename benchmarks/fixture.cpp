@@ -0,0 +1,75 @@
+// Types the microbenchmarks print, compiled with debug information into the object file they load.
+// The names of the nested templates double in length at each level.
+
+namespace fixture {
+
+template <typename T, typename U>
+struct Pair {
+    T first;
+    U second;
+};
+
+template <typename... Ts>
+struct Tuple {};
+
+template <int N>
+struct Nest {
+    using type = Pair<typename Nest<N - 1>::type, Tuple<typename Nest<N - 1>::type, int, char>>;
+};
+
+template <>
+struct Nest<0> {
+    using type = int;
+};
+
+Nest<2>::type nested2;
+Nest<4>::type nested4;
+Nest<6>::type nested6;
+Nest<8>::type nested8;
+Nest<10>::type nested10;
+
+// types printed in two parts, before and after the name of a declaration
+Nest<4>::type (*(*split_array)[4])(const Nest<3>::type &, int Pair<int, char>::*);
+int (Pair<Nest<2>::type, char>::*split_member)(double) const;
+Tuple<Nest<3>::type, long> (&(*split_function)(int))[8];
+
+namespace a::b::c::d::e::f::g::h {
+struct Outer {
+    struct Middle {
+        template <typename T>
+        struct Inner {
+            T value;
+        };
+    };
+};
+} // namespace a::b::c::d::e::f::g::h
+
+a::b::c::d::e::f::g::h::Outer::Middle::Inner<Nest<2>::type> scoped;
+
+// member functions defined out of line, whose names are found through DW_AT_specification
+class Widget {
+public:
+    Widget(int value);
+    int get(int offset) const;
+    void set(int value);
+    static Widget make();
+
+private:
+    int value_;
+};
+
+Widget::Widget(int value) : value_(value) {}
+
+int Widget::get(int offset) const {
+    return value_ + offset;
+}
+
+void Widget::set(int value) {
+    value_ = value;
+}
+
+Widget Widget::make() {
+    return Widget(0);
+}
+
+} // namespace fixture
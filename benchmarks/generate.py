@@ -0,0 +1,204 @@
+"""
+Generate a synthetic C++ project to benchmark dwarf2cpp on:
+
+    python benchmarks/generate.py path/to/project --units 32 --classes 256 --template-depth 4 --namespace-depth 3
+
+The classes are spread over headers, each one in its own nested namespaces, with an enum, a nested template type of
+the given depth, virtual functions and a base class. Their members are defined out of line in the translation units,
+which also use classes of other headers so that the same types are found in several compile units.
+"""
+
+import argparse
+from dataclasses import dataclass
+from pathlib import Path
+
+CLASSES_PER_HEADER = 8
+# classes of other headers used by each translation unit
+USES_PER_UNIT = 8
+
+COMMON_HEADER = """\
+#pragma once
+
+namespace bench {
+
+template <typename T>
+struct Wrap {
+    T inner;
+
+    const T &get() const { return inner; }
+};
+
+template <typename T, int N>
+struct Array {
+    T values[N];
+
+    int size() const { return N; }
+};
+
+template <typename K, typename V>
+struct Pair {
+    K key;
+    V value;
+};
+
+} // namespace bench
+"""
+
+
+@dataclass
+class Config:
+    units: int = 32
+    classes: int = 256
+    template_depth: int = 4
+    namespace_depth: int = 3
+
+    @property
+    def headers(self) -> int:
+        return (self.classes + CLASSES_PER_HEADER - 1) // CLASSES_PER_HEADER
+
+
+def namespace(config: Config, header: int) -> str:
+    """Qualified namespace of the classes of a header, headers share their outer namespaces."""
+    names = ["bench"] + [f"ns{level}_{header % (level + 2)}" for level in range(config.namespace_depth)]
+    names.append(f"h{header}")
+    return "::".join(names)
+
+
+def nested_type(config: Config, j: int) -> str:
+    name = f"Pair<int, Item{j}>"
+    for _ in range(config.template_depth):
+        name = f"Wrap<{name}>"
+    return name
+
+
+def qualified(config: Config, j: int) -> str:
+    return f"{namespace(config, j // CLASSES_PER_HEADER)}::Class{j}"
+
+
+def header(config: Config, h: int) -> str:
+    lines = ["#pragma once", "", '#include "common.h"', "", f"namespace {namespace(config, h)} {{", ""]
+    first = h * CLASSES_PER_HEADER
+    for j in range(first, min(first + CLASSES_PER_HEADER, config.classes)):
+        base = f" : public Class{j - 1}" if j > first else ""
+        lines += [
+            f"enum class Color{j} : unsigned char {{ red, green, blue }};",
+            "",
+            f"struct Item{j} {{",
+            "    int id;",
+            "    double weight;",
+            f"    Color{j} color;",
+            "};",
+            "",
+            f"class Class{j}{base} {{",
+            "public:",
+            f"    typedef {nested_type(config, j)} nested_type;",
+            "",
+            f"    Class{j}();",
+            f"    virtual ~Class{j}();",
+            f"    virtual int compute(int count, const Item{j} &item) const;",
+            f"    void update(double factor, Color{j} color);",
+            f"    static Class{j} *create(const char *name);",
+            "",
+            "private:",
+            f"    int count{j}_;",
+            f"    Array<Item{j}, 4> items{j}_;",
+            f"    nested_type nested{j}_;",
+            "};",
+            "",
+        ]
+
+    lines += [f"}} // namespace {namespace(config, h)}", ""]
+    return "\n".join(lines)
+
+
+def unit(config: Config, i: int) -> str:
+    defined = range(i, config.classes, config.units)
+    used = sorted({(i * 31 + k * 17) % config.classes for k in range(USES_PER_UNIT)})
+    headers = sorted({j // CLASSES_PER_HEADER for j in (*defined, *used)})
+    getter = ".get()" * config.template_depth
+
+    lines = [f'#include "module{h}.h"' for h in headers] + [""]
+    for j in defined:
+        lines += [
+            f"namespace {namespace(config, j // CLASSES_PER_HEADER)} {{",
+            "",
+            f"Class{j}::Class{j}() : count{j}_(0), items{j}_(), nested{j}_() {{}}",
+            "",
+            f"Class{j}::~Class{j}() {{}}",
+            "",
+            f"int Class{j}::compute(int count, const Item{j} &item) const {{",
+            f"    return count + item.id + count{j}_ + items{j}_.size() + nested{j}_{getter}.key;",
+            "}",
+            "",
+            f"void Class{j}::update(double factor, Color{j} color) {{",
+            f"    count{j}_ = static_cast<int>(factor * count{j}_);",
+            f"    items{j}_.values[0].color = color;",
+            "}",
+            "",
+            f"Class{j} *Class{j}::create(const char *name) {{ return name ? new Class{j}() : nullptr; }}",
+            "",
+            f"}} // namespace {namespace(config, j // CLASSES_PER_HEADER)}",
+            "",
+        ]
+
+    lines += ["namespace bench {", ""]
+    for j in used:
+        lines += [
+            f"int use{i}_{j}(const {qualified(config, j)} &object) {{",
+            f"    {qualified(config, j)}::nested_type nested{{}};",
+            f"    return object.compute(1, nested{getter}.value);",
+            "}",
+            "",
+        ]
+
+    lines += ["} // namespace bench", ""]
+    return "\n".join(lines)
+
+
+def generate(project_dir: Path, config: Config) -> list[Path]:
+    """Write the project and return the paths of its translation units."""
+    include_dir = project_dir / "include"
+    src_dir = project_dir / "src"
+    include_dir.mkdir(parents=True, exist_ok=True)
+    src_dir.mkdir(parents=True, exist_ok=True)
+
+    (include_dir / "common.h").write_text(COMMON_HEADER, encoding="utf-8")
+    for h in range(config.headers):
+        (include_dir / f"module{h}.h").write_text(header(config, h), encoding="utf-8")
+
+    sources = []
+    for i in range(config.units):
+        source = src_dir / f"unit{i}.cpp"
+        source.write_text(unit(config, i), encoding="utf-8")
+        sources.append(source)
+
+    return sources
+
+
+def add_arguments(parser: argparse.ArgumentParser) -> None:
+    parser.add_argument("--units", type=int, default=Config.units, help="number of translation units")
+    parser.add_argument("--classes", type=int, default=Config.classes, help="number of classes")
+    parser.add_argument(
+        "--template-depth", type=int, default=Config.template_depth, help="nesting depth of the template types"
+    )
+    parser.add_argument(
+        "--namespace-depth", type=int, default=Config.namespace_depth, help="nesting depth of the namespaces"
+    )
+
+
+def config_from_args(args: argparse.Namespace) -> Config:
+    return Config(args.units, args.classes, args.template_depth, args.namespace_depth)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("project_dir", type=Path, help="where to write the project")
+    add_arguments(parser)
+    args = parser.parse_args()
+
+    sources = generate(args.project_dir, config_from_args(args))
+    print(f"Generated {len(sources)} translation units in {args.project_dir}")
+
+
+if __name__ == "__main__":
+    main()
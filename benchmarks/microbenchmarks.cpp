@@ -0,0 +1,186 @@
+// Microbenchmarks of the type printer and of the DIE accessors behind the hottest bindings, on the
+// DIEs of fixture.cpp or of the object file given as the first argument.
+
+#include "dwarf_utils.h"
+#include "type_printer.h"
+
+#include <benchmark/benchmark.h>
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+#ifdef DWARF2CPP_BENCHMARK_FIXTURE
+std::string FixturePath = DWARF2CPP_BENCHMARK_FIXTURE;
+#else
+std::string FixturePath;
+#endif
+
+struct Fixture {
+    llvm::object::OwningBinary<llvm::object::ObjectFile> binary;
+    std::unique_ptr<llvm::DWARFContext> context;
+    // every DIE of the compile units, in depth-first order
+    std::vector<llvm::DWARFDie> dies;
+
+    explicit Fixture(const std::string &path) {
+        auto object = llvm::object::ObjectFile::createObjectFile(path);
+        if (!object) {
+            throw std::runtime_error(toString(object.takeError()));
+        }
+        binary = std::move(*object);
+        context = llvm::DWARFContext::create(*binary.getBinary());
+
+        std::function<void(const llvm::DWARFDie &)> collect = [&](const llvm::DWARFDie &die) {
+            dies.push_back(die);
+            for (const auto &child : die.children()) {
+                collect(child);
+            }
+        };
+        for (const auto &unit : context->compile_units()) {
+            collect(unit->getUnitDIE(false));
+        }
+    }
+
+    // The type of the variable with the given name.
+    [[nodiscard]] llvm::DWARFDie variableType(const char *name) const {
+        for (const auto &die : dies) {
+            if (die.getTag() == llvm::dwarf::DW_TAG_variable) {
+                const char *short_name = dwarf2cpp::ShortName(die);
+                if (short_name && std::strcmp(short_name, name) == 0) {
+                    return die.getAttributeValueAsReferencedDie(llvm::dwarf::DW_AT_type)
+                        .resolveTypeUnitReference();
+                }
+            }
+        }
+        throw std::runtime_error(std::string("No variable named ") + name + " in " + FixturePath);
+    }
+};
+
+const Fixture &GetFixture() {
+    static const Fixture fixture(FixturePath);
+    return fixture;
+}
+
+// the type of the variable `nested<depth>`, a template nested that many times, rather than the
+// typedef it is declared with
+llvm::DWARFDie NestedType(const benchmark::State &state) {
+    auto die = GetFixture().variableType(("nested" + std::to_string(state.range(0))).c_str());
+    while (die.getTag() == llvm::dwarf::DW_TAG_typedef) {
+        die = die.getAttributeValueAsReferencedDie(llvm::dwarf::DW_AT_type)
+                  .resolveTypeUnitReference();
+    }
+    return die;
+}
+
+template <typename Print>
+void BenchmarkPrinter(benchmark::State &state, const Print &print) {
+    size_t length = 0;
+    for (auto _ : state) {
+        std::string buffer;
+        llvm::raw_string_ostream os(buffer);
+        llvm::DWARFTypePrinter printer(os);
+        print(printer);
+        os.flush();
+        length = buffer.size();
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.counters["length"] = static_cast<double>(length);
+}
+
+void BM_AppendQualifiedName(benchmark::State &state) {
+    auto die = NestedType(state);
+    BenchmarkPrinter(state, [&](llvm::DWARFTypePrinter &printer) {
+        printer.appendQualifiedName(die);
+    });
+}
+BENCHMARK(BM_AppendQualifiedName)->DenseRange(2, 10, 2);
+
+void BM_AppendTemplateParameters(benchmark::State &state) {
+    auto die = NestedType(state);
+    BenchmarkPrinter(state, [&](llvm::DWARFTypePrinter &printer) {
+        printer.appendTemplateParameters(die);
+    });
+}
+BENCHMARK(BM_AppendTemplateParameters)->DenseRange(2, 10, 2);
+
+void BM_AppendScopes(benchmark::State &state) {
+    // the scopes of Inner: fixture::a::...::h::Outer::Middle::
+    auto die = GetFixture().variableType("scoped").getParent();
+    BenchmarkPrinter(state, [&](llvm::DWARFTypePrinter &printer) { printer.appendScopes(die); });
+}
+BENCHMARK(BM_AppendScopes);
+
+// the type printed around the name of a declaration, as Visitor::resolveSplitType does
+void BM_SplitPrinting(benchmark::State &state, const char *variable) {
+    auto die = GetFixture().variableType(variable);
+    BenchmarkPrinter(state, [&](llvm::DWARFTypePrinter &printer) {
+        auto inner = printer.appendQualifiedNameBefore(die);
+        printer.appendUnqualifiedNameAfter(die, inner);
+    });
+}
+BENCHMARK_CAPTURE(BM_SplitPrinting, array, "split_array");
+BENCHMARK_CAPTURE(BM_SplitPrinting, member, "split_member");
+BENCHMARK_CAPTURE(BM_SplitPrinting, function, "split_function");
+
+// The accessors behind DWARFDie.short_name, decl_file, children and attributes, called once for
+// every DIE of the fixture. The difference with the same loop in Python is the binding overhead.
+template <typename Accessor>
+void BenchmarkAccessor(benchmark::State &state, Accessor accessor) {
+    const auto &dies = GetFixture().dies;
+    for (auto _ : state) {
+        for (const auto &die : dies) {
+            benchmark::DoNotOptimize(accessor(die));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * dies.size()));
+}
+
+void BM_ShortName(benchmark::State &state) {
+    BenchmarkAccessor(state, dwarf2cpp::ShortName);
+}
+BENCHMARK(BM_ShortName);
+
+void BM_DeclFileName(benchmark::State &state) {
+    BenchmarkAccessor(state, dwarf2cpp::DeclFileName);
+}
+BENCHMARK(BM_DeclFileName);
+
+void BM_Children(benchmark::State &state) {
+    BenchmarkAccessor(state, dwarf2cpp::Children);
+}
+BENCHMARK(BM_Children);
+
+void BM_Attributes(benchmark::State &state) {
+    BenchmarkAccessor(state, dwarf2cpp::Attributes);
+}
+BENCHMARK(BM_Attributes);
+} // namespace
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    if (argc > 1) {
+        FixturePath = argv[1];
+    }
+    if (FixturePath.empty()) {
+        llvm::errs() << "Usage: " << argv[0] << " [benchmark options] <object file>\n";
+        return 1;
+    }
+
+    try {
+        GetFixture();
+    } catch (const std::exception &e) {
+        llvm::errs() << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
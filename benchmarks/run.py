@@ -0,0 +1,204 @@
+"""
+Benchmark an extraction end to end on a synthetic project:
+
+    python benchmarks/run.py --units 32 --classes 256 --template-depth 4 --namespace-depth 3 -o results.json
+
+The project is generated, compiled into a shared library for each variant of the debug information, then extracted
+with `python -m dwarf2cpp --timings` a few times. The time spent in each phase of every run and their medians are
+written as JSON, along with the versions of dwarf2cpp, Python and the compiler to compare results over time.
+"""
+
+import argparse
+import importlib.metadata
+import json
+import os
+import platform
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import asdict
+from pathlib import Path
+
+from generate import Config, add_arguments, config_from_args, generate
+
+VARIANTS = {
+    "g": ["-g"],
+    "types": ["-g", "-fdebug-types-section"],
+    # type units in .debug_types instead of .debug_info
+    "types-dwarf4": ["-gdwarf-4", "-fdebug-types-section"],
+}
+
+
+def compile_project(project_dir: Path, sources: list[Path], compiler: str, flags: list[str], jobs: int) -> Path:
+    """Compile the project into a shared library, from its directory so that it is the compilation directory."""
+    build_dir = project_dir / "build"
+    shutil.rmtree(build_dir, ignore_errors=True)
+    build_dir.mkdir()
+    include_dir = project_dir / "include"
+
+    def compile_unit(source: Path) -> Path:
+        obj = build_dir / source.with_suffix(".o").name
+        command = [
+            compiler,
+            "-std=c++17",
+            "-O0",
+            "-fPIC",
+            *flags,
+            f"-I{include_dir}",
+            "-c",
+            str(source),
+            "-o",
+            str(obj),
+        ]
+        subprocess.run(command, cwd=project_dir, check=True)
+        return obj
+
+    with ThreadPoolExecutor(jobs) as executor:
+        objects = list(executor.map(compile_unit, sources))
+
+    library = build_dir / "libbench.so"
+    subprocess.run([compiler, "-shared", *map(str, objects), "-o", str(library)], cwd=project_dir, check=True)
+    return library
+
+
+def extract(library: Path, base_dir: Path, output_dir: Path, timings: Path, memory_report: Path | None) -> dict:
+    shutil.rmtree(output_dir, ignore_errors=True)
+    options = ["--memory-report", str(memory_report)] if memory_report else []
+    start = time.perf_counter()
+    subprocess.run(
+        [
+            sys.executable,
+            "-m",
+            "dwarf2cpp",
+            "extract",
+            str(library),
+            "--base-dir",
+            str(base_dir),
+            "--output-path",
+            str(output_dir),
+            "--checkpoint-interval",
+            "0",
+            "--timings",
+            str(timings),
+            *options,
+        ],
+        check=True,
+    )
+    elapsed = time.perf_counter() - start
+
+    result = json.loads(timings.read_text(encoding="utf-8"))
+    # including the start of the interpreter and the imports
+    result["process_seconds"] = elapsed
+    if memory_report:
+        result["memory"] = json.loads(memory_report.read_text(encoding="utf-8"))["snapshots"]
+    return result
+
+
+def median(runs: list[dict]) -> dict:
+    result = {
+        "process_seconds": statistics.median(run["process_seconds"] for run in runs),
+        "wall_seconds": statistics.median(run["wall_seconds"] for run in runs),
+        "phases": {
+            name: statistics.median(run["phases"][name]["seconds"] for run in runs) for name in runs[0]["phases"]
+        },
+    }
+    if "memory" in runs[0]:
+        result["peak_rss_bytes"] = statistics.median(run["memory"][-1]["peak_rss_bytes"] or 0 for run in runs)
+    return result
+
+
+def version(compiler: str) -> str:
+    output = subprocess.run([compiler, "--version"], capture_output=True, text=True, check=True).stdout
+    return output.splitlines()[0]
+
+
+def benchmark(
+    work_dir: Path, config: Config, compiler: str, variants: list[str], repeat: int, jobs: int, memory: bool
+) -> dict:
+    project_dir = work_dir / "project"
+    shutil.rmtree(project_dir, ignore_errors=True)
+    sources = generate(project_dir, config)
+
+    try:
+        dwarf2cpp_version = importlib.metadata.version("dwarf2cpp")
+    except importlib.metadata.PackageNotFoundError:
+        dwarf2cpp_version = None
+
+    results = {
+        "dwarf2cpp": dwarf2cpp_version,
+        "python": sys.version,
+        "platform": platform.platform(),
+        "compiler": version(compiler),
+        "config": asdict(config),
+        "variants": {},
+    }
+    for variant in variants:
+        flags = VARIANTS[variant]
+        print(f"Compiling {len(sources)} translation units with {' '.join(flags)}", flush=True)
+        library = compile_project(project_dir, sources, compiler, flags, jobs)
+
+        runs = []
+        for i in range(repeat):
+            print(f"Extracting {variant} [{i + 1}/{repeat}]", flush=True)
+            timings = work_dir / f"timings-{variant}-{i}.json"
+            memory_report = work_dir / f"memory-{variant}-{i}.json" if memory else None
+            runs.append(extract(library, project_dir, work_dir / "out", timings, memory_report))
+
+        results["variants"][variant] = {
+            "flags": flags,
+            "library_size": library.stat().st_size,
+            "runs": runs,
+            "median": median(runs),
+        }
+
+    return results
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    add_arguments(parser)
+    parser.add_argument(
+        "--compiler", default=os.environ.get("CXX", "clang++"), help="C++ compiler, defaults to $CXX or clang++"
+    )
+    parser.add_argument(
+        "--variant", choices=VARIANTS, action="append", help="debug information to benchmark, defaults to all"
+    )
+    parser.add_argument(
+        "--memory",
+        action="store_true",
+        help="also record the memory used at each phase boundary with --memory-report, which slows the phases down",
+    )
+    parser.add_argument("--repeat", type=int, default=3, help="number of extractions of each variant")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="number of parallel compilations")
+    parser.add_argument("--work-dir", type=Path, default=None, help="where to keep the project, defaults to a temp dir")
+    parser.add_argument("--output", "-o", type=Path, default=Path("benchmark.json"), help="where to write results")
+    args = parser.parse_args()
+
+    config = config_from_args(args)
+    variants = args.variant or list(VARIANTS)
+    if args.work_dir:
+        args.work_dir.mkdir(parents=True, exist_ok=True)
+        results = benchmark(
+            args.work_dir.resolve(), config, args.compiler, variants, args.repeat, args.jobs, args.memory
+        )
+    else:
+        with tempfile.TemporaryDirectory() as tmp:
+            results = benchmark(
+                Path(tmp).resolve(), config, args.compiler, variants, args.repeat, args.jobs, args.memory
+            )
+
+    with args.output.open("w", encoding="utf-8") as f:
+        json.dump(results, f, indent=2)
+        f.write("\n")
+
+    for variant, result in results["variants"].items():
+        phases = ", ".join(f"{name} {seconds:.2f}s" for name, seconds in result["median"]["phases"].items())
+        print(f"{variant}: {result['median']['wall_seconds']:.2f}s ({phases})")
+
+
+if __name__ == "__main__":
+    main()
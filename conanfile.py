@@ -0,0 +1,23 @@
+from conan import ConanFile
+from conan.tools.cmake import cmake_layout
+
+
+class Dwarf2CppConan(ConanFile):
+    settings = "os", "compiler", "build_type", "arch"
+    generators = "CMakeDeps", "CMakeToolchain"
+    # Google Benchmark is only needed by dwarf2cpp-benchmark (DWARF2CPP_BUILD_BENCHMARKS=ON), so that building the
+    # wheel does not fetch it
+    options = {"benchmarks": [True, False]}
+    default_options = {"benchmarks": False}
+
+    def requirements(self):
+        self.requires("llvm-core/19.1.7")
+        self.requires("libxml2/[>=2.13 <2.14]")
+        self.requires("pybind11/3.0.1")
+
+    def build_requirements(self):
+        if self.options.benchmarks:
+            self.test_requires("benchmark/1.9.1")
+
+    def layout(self):
+        cmake_layout(self)
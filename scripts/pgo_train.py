@@ -0,0 +1,106 @@
+"""
+Build a profile-guided optimized wheel of dwarf2cpp.
+
+The extension module is built once with instrumentation, trained by extracting the headers of the given binaries,
+then built again with the collected profile:
+
+    python scripts/pgo_train.py path/to/libfoo.so path/to/bar --base-dir /path/of/compilation --wheel-dir dist
+
+The training binaries should resemble what the wheel will be used on, e.g. large C++ binaries built with clang and
+with gcc. The instrumented module replaces the installed dwarf2cpp, so run this in a virtual environment.
+
+Only the sources of dwarf2cpp are profiled. The static LLVM libraries that parse the DWARF sections come prebuilt from
+Conan, and are linked as they are in both builds.
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+
+
+def build(args: list[str], pgo: str, profile_dir: Path, build_dir: Path, lto: bool) -> None:
+    env = dict(os.environ)
+    env["DWARF2CPP_PGO"] = pgo
+    env["DWARF2CPP_PGO_DIR"] = str(profile_dir)
+    env["DWARF2CPP_ENABLE_LTO"] = "ON" if lto else "OFF"
+    # gcc names the profile of each object file after its path, which must not change between the two builds
+    env["SKBUILD_BUILD_DIR"] = str(build_dir)
+    subprocess.run([sys.executable, "-m", "pip", *args, str(ROOT)], env=env, check=True)
+
+
+def train(binaries: list[Path], base_dir: str) -> None:
+    """Run the hot paths of an extraction: the visitor, the type printer, the caches and the extra outputs."""
+    for binary in binaries:
+        with tempfile.TemporaryDirectory() as tmp:
+            out = Path(tmp)
+            print(f"Training on {binary}", flush=True)
+            subprocess.run(
+                [
+                    sys.executable,
+                    "-m",
+                    "dwarf2cpp",
+                    "extract",
+                    str(binary),
+                    "--base-dir",
+                    base_dir,
+                    "--output-path",
+                    str(out / "headers"),
+                    "--cache-dir",
+                    str(out / "cache"),
+                    "--layout-report",
+                    str(out / "layout.txt"),
+                    "--symbol-table",
+                    str(out / "symbols.bin"),
+                ],
+                check=True,
+            )
+            subprocess.run(
+                [sys.executable, "-m", "dwarf2cpp", "build-index", str(binary), "-o", str(out / "index.dieidx")],
+                check=True,
+            )
+
+
+def merge(profile_dir: Path) -> None:
+    """Merge the raw profiles written by clang instrumentation. gcc reads its .gcda files as they are."""
+    raw = glob.glob(str(profile_dir / "*.profraw"))
+    if not raw:
+        return
+
+    llvm_profdata = os.environ.get("LLVM_PROFDATA", "llvm-profdata")
+    subprocess.run(
+        [llvm_profdata, "merge", f"-output={profile_dir / 'dwarf2cpp.profdata'}", *raw],
+        check=True,
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("binaries", nargs="+", type=Path, help="binaries with DWARF to train on")
+    parser.add_argument("--base-dir", required=True, help="base directory used during compilation of the binaries")
+    parser.add_argument("--wheel-dir", type=Path, default=ROOT / "dist", help="where to write the optimized wheel")
+    parser.add_argument("--profile-dir", type=Path, default=ROOT / "build" / "pgo", help="where to write profiles")
+    parser.add_argument("--build-dir", type=Path, default=ROOT / "build" / "pgo-build", help="CMake build directory")
+    parser.add_argument("--no-lto", dest="lto", action="store_false", help="do not enable link-time optimization")
+    args = parser.parse_args()
+
+    profile_dir = args.profile_dir.resolve()
+    build_dir = args.build_dir.resolve()
+    shutil.rmtree(profile_dir, ignore_errors=True)
+    shutil.rmtree(build_dir, ignore_errors=True)
+    profile_dir.mkdir(parents=True)
+
+    build(["install", "--force-reinstall", "--no-deps"], "GENERATE", profile_dir, build_dir, args.lto)
+    train([binary.resolve() for binary in args.binaries], args.base_dir)
+    merge(profile_dir)
+    build(["wheel", "--no-deps", "--wheel-dir", str(args.wheel_dir)], "USE", profile_dir, build_dir, args.lto)
+
+
+if __name__ == "__main__":
+    main()
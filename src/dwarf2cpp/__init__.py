@@ -9,9 +9,13 @@ __getattr__, __dir__, __all__ = lazy.attach(
             "DWARFAttribute",
             "DWARFContext",
             "DWARFDie",
+            "DWARFIndex",
+            "DWARFIndexEntry",
             "DWARFUnit",
             "DWARFTypePrinter",
             "VirtualityAttribute",
+            "demangle_many",
         ],
+        "aio": ["extract_async"],
     },
 )
@@ -1,106 +1,75 @@
+#include "die_index.h"
+#include "dwarf_utils.h"
+#include "linkage_index.h"
+#include "symbolizer.h"
+#include "trace.h"
 #include "type_printer.h"
 
-#include <llvm/ADT/SmallSet.h>
-#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringSwitch.h>
 #include <llvm/DebugInfo/DWARF/DWARFContext.h>
 #include <llvm/DebugInfo/DWARF/DWARFTypeUnit.h>
 #include <llvm/Demangle/Demangle.h>
+#include <llvm/Object/ELFObjectFile.h>
+#include <llvm/Support/Parallel.h>
+#include <llvm/Support/WithColor.h>
 #include <pybind11/native_enum.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
-namespace py = pybind11;
-
-namespace {
-std::string ToString(llvm::dwarf::Attribute attr) {
-    static const std::unordered_map<llvm::dwarf::Attribute, std::string> map = {
-#define HANDLE_DW_AT(ID, NAME, VERSION, VENDOR) {llvm::dwarf::DW_AT_##NAME, "DW_AT_" #NAME},
-#include "llvm/BinaryFormat/Dwarf.def"
-
-#undef HANDLE_DW_AT
-    };
-    return map.at(attr);
-}
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 
-llvm::dwarf::Attribute ToAttribute(const std::string &key) {
-    static const std::unordered_map<std::string, llvm::dwarf::Attribute> map = {
-#define HANDLE_DW_AT(ID, NAME, VERSION, VENDOR) {"DW_AT_" #NAME, llvm::dwarf::DW_AT_##NAME},
-#include "llvm/BinaryFormat/Dwarf.def"
-
-#undef HANDLE_DW_AT
-    };
-    return map.at(key);
-}
-
-// POLYFILL BEGINS TODO: remove after updating to LLVM 20
-llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
-                                                const llvm::DWARFFormValue &V) {
-    llvm::DWARFDie Result;
-    if (std::optional<uint64_t> Offset = V.getAsRelativeReference()) {
-        Result = const_cast<llvm::DWARFUnit *>(V.getUnit())
-                     ->getDIEForOffset(V.getUnit()->getOffset() + *Offset);
-    } else if (Offset = V.getAsDebugInfoReference(); Offset) {
-        if (llvm::DWARFUnit *SpecUnit
-            = die.getDwarfUnit()->getUnitVector().getUnitForOffset(*Offset))
-            Result = SpecUnit->getDIEForOffset(*Offset);
-    } else if (std::optional<uint64_t> Sig = V.getAsSignatureReference()) {
-        if (llvm::DWARFTypeUnit *TU = die.getDwarfUnit()->getContext().getTypeUnitForHash(
-                die.getDwarfUnit()->getVersion(), *Sig, die.getDwarfUnit()->isDWOUnit()))
-            Result = TU->getDIEForOffset(TU->getTypeOffset() + TU->getOffset());
-    }
-    return Result;
-}
+namespace py = pybind11;
 
-llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
-                                                llvm::dwarf::Attribute Attr) {
-    if (std::optional<llvm::DWARFFormValue> F = die.find(Attr))
-        return getAttributeValueAsReferencedDie(die, *F);
-    return {};
-}
+using dwarf2cpp::Attributes;
+using dwarf2cpp::Children;
+using dwarf2cpp::DeclFileName;
+using dwarf2cpp::DeclLine;
+using dwarf2cpp::ForgetLineTables;
+using dwarf2cpp::HasCrossUnitReferences;
+using dwarf2cpp::LineTableFiles;
+using dwarf2cpp::LinkageName;
+using dwarf2cpp::ReferencedDie;
+using dwarf2cpp::ShortName;
+using dwarf2cpp::ToAttribute;
+using dwarf2cpp::ToString;
+using dwarf2cpp::TraceSpan;
+using dwarf2cpp::TypeAlignment;
+using dwarf2cpp::UnitFingerprint;
 
-std::optional<llvm::DWARFFormValue> findRecursively(const llvm::DWARFDie &die,
-                                                    llvm::ArrayRef<llvm::dwarf::Attribute> Attrs) {
-    // polyfill from LLVM 20
-    llvm::SmallVector<llvm::DWARFDie, 3> Worklist;
-    Worklist.push_back(die);
-    llvm::SmallSet<llvm::DWARFDie, 3> Seen;
-    Seen.insert(die);
-
-    while (!Worklist.empty()) {
-        llvm::DWARFDie Die = Worklist.pop_back_val();
-        if (!Die.isValid()) {
-            continue;
-        }
-        if (auto Value = Die.find(Attrs)) {
-            return Value;
-        }
-        for (llvm::dwarf::Attribute Attr : {llvm::dwarf::DW_AT_abstract_origin,
-                                            llvm::dwarf::DW_AT_specification,
-                                            llvm::dwarf::DW_AT_signature}) {
-            if (auto D = getAttributeValueAsReferencedDie(Die, Attr)) {
-                if (Seen.insert(D).second) {
-                    Worklist.push_back(D);
-                }
+class PyDWARFContext {
+public:
+    explicit PyDWARFContext(const std::string &path) : path_(path) {
+        {
+            TraceSpan span("load_object");
+            auto result = llvm::object::ObjectFile::createObjectFile(path);
+            if (!result) {
+                throw std::runtime_error(toString(result.takeError()));
             }
+            object_ = std::move(*result);
         }
+        TraceSpan span("create_context");
+        // the context guards the units, line tables and sections it parses lazily, so that calls
+        // can parse them without the GIL, or on free-threaded builds. symbolize and
+        // find_linkage_name walk every unit without the GIL and rely on it as well.
+        context_ = llvm::DWARFContext::create(*object_.getBinary(),
+                                              llvm::DWARFContext::ProcessDebugRelocations::Process,
+                                              nullptr,
+                                              "",
+                                              llvm::WithColor::defaultErrorHandler,
+                                              llvm::WithColor::defaultWarningHandler,
+                                              /*ThreadSafe=*/true);
     }
 
-    return std::nullopt;
-};
-// POLYFILL ENDS TODO: remove after updating to LLVM 20
-} // namespace
-
-class PyDWARFContext {
-public:
-    explicit PyDWARFContext(const std::string &path) {
-        auto result = llvm::object::ObjectFile::createObjectFile(path);
-        if (!result) {
-            throw std::runtime_error(toString(result.takeError()));
+    ~PyDWARFContext() {
+        if (context_) {
+            ForgetLineTables(*context_);
         }
-        object_ = std::move(*result);
-        context_ = llvm::DWARFContext::create(*object_.getBinary());
     }
 
     [[nodiscard]] auto info_section_units() const {
@@ -143,38 +112,263 @@ public:
 
     [[nodiscard]] auto getCUAddrSize() const { return context_->getCUAddrSize(); }
 
+    [[nodiscard]] std::optional<llvm::DWARFDie> dieAt(uint64_t offset, bool types_section) const {
+        if (auto die = dwarf2cpp::DieForOffset(*context_, offset, types_section); die.isValid()) {
+            return die;
+        }
+        return std::nullopt;
+    }
+
+    // Memory held by the DIEs and line tables parsed so far, as estimated by ContextMemoryStats.
+    [[nodiscard]] std::map<std::string, uint64_t> memoryStats() const {
+        auto stats = dwarf2cpp::ContextMemoryStats(*context_);
+        return {
+            {"units", stats.units},
+            {"extracted_units", stats.extracted_units},
+            {"dies", stats.dies},
+            {"die_bytes", stats.die_bytes},
+            {"line_tables", stats.line_tables},
+            {"line_table_rows", stats.line_table_rows},
+            {"line_table_sequences", stats.line_table_sequences},
+            {"line_table_files", stats.line_table_files},
+            {"line_table_bytes", stats.line_table_bytes},
+        };
+    }
+
+    void writeIndex(const std::string &path) const {
+        TraceSpan span("write_index");
+        dwarf2cpp::DieIndex::write(*context_, path_, path);
+    }
+
+    // Defined function symbols of the symbol table, and of the dynamic symbol table of ELF files,
+    // as (name, address, size) tuples.
+    [[nodiscard]] auto functionSymbols() const {
+        std::vector<std::tuple<std::string, uint64_t, uint64_t>> result;
+        const auto *binary = object_.getBinary();
+        const auto *elf = llvm::dyn_cast<llvm::object::ELFObjectFileBase>(binary);
+        auto add = [&](const llvm::object::SymbolRef &symbol) {
+            auto type = symbol.getType();
+            auto flags = symbol.getFlags();
+            auto name = symbol.getName();
+            auto address = symbol.getAddress();
+            if (!type || !flags || !name || !address) {
+                llvm::consumeError(type.takeError());
+                llvm::consumeError(flags.takeError());
+                llvm::consumeError(name.takeError());
+                llvm::consumeError(address.takeError());
+                return;
+            }
+            if (*type != llvm::object::SymbolRef::ST_Function
+                || (*flags & llvm::object::SymbolRef::SF_Undefined) || name->empty()) {
+                return;
+            }
+            uint64_t size = elf ? llvm::object::ELFSymbolRef(symbol).getSize() : 0;
+            result.emplace_back(name->str(), *address, size);
+        };
+
+        for (const auto &symbol : binary->symbols()) {
+            add(symbol);
+        }
+        if (elf) {
+            for (const auto &symbol : elf->getDynamicSymbolIterators()) {
+                add(symbol);
+            }
+        }
+        return result;
+    }
+
+    // DIEs holding the given linkage name, the index is built on the first call.
+    [[nodiscard]] std::vector<llvm::DWARFDie> findLinkageName(const std::string &linkage_name) {
+        std::call_once(linkage_index_once_, [this] {
+            TraceSpan span("build_linkage_index");
+            linkage_index_ = std::make_unique<dwarf2cpp::LinkageNameIndex>(*context_);
+        });
+        return linkage_index_->find(linkage_name);
+    }
+
+    // Resolve an array of 64-bit code addresses to (qualified name, declaration file, declaration
+    // line) tuples, or None for the addresses outside of any function. The interval index is built
+    // on the first call, and the tuple of each function is only created once.
+    py::list symbolize(const py::buffer &buffer) {
+        auto addresses = toAddresses(buffer);
+        std::vector<uint32_t> symbols;
+        {
+            py::gil_scoped_release release;
+            std::call_once(symbolizer_once_, [this] {
+                TraceSpan span("build_symbolizer");
+                symbolizer_ = std::make_unique<dwarf2cpp::Symbolizer>(*context_);
+            });
+            symbols = symbolizer_->lookup(addresses);
+
+            auto unique = symbols;
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            for (auto symbol : unique) {
+                if (symbol != dwarf2cpp::Symbolizer::kNone) {
+                    symbolizer_->describe(symbol);
+                }
+            }
+        }
+
+        // wait for other callers without blocking the interpreter, then create the tuples
+        std::unique_lock lock(symbol_objects_mutex_, std::defer_lock);
+        {
+            py::gil_scoped_release release;
+            lock.lock();
+        }
+
+        py::list result(symbols.size());
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            if (symbols[i] == dwarf2cpp::Symbolizer::kNone) {
+                result[i] = py::none();
+                continue;
+            }
+
+            auto &cached = symbol_objects_[symbols[i]];
+            if (!cached) {
+                const auto &symbol = symbolizer_->describe(symbols[i]);
+                cached = py::make_tuple(symbol.name, symbol.decl_file, symbol.decl_line);
+            }
+            result[i] = cached;
+        }
+        return result;
+    }
+
 private:
+    static std::vector<uint64_t> toAddresses(const py::buffer &buffer) {
+        auto info = buffer.request();
+        auto format = info.format;
+        format.erase(0, format.find_first_not_of("@=<>!"));
+        if (info.ndim != 1 || info.itemsize != 8
+            || (format != "Q" && format != "L" && format != "q" && format != "l")) {
+            throw py::type_error(
+                "Expected a one-dimensional buffer of 64-bit integers, got format " + info.format);
+        }
+
+        std::vector<uint64_t> addresses(info.shape[0]);
+        const auto *data = static_cast<const char *>(info.ptr);
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            std::memcpy(&addresses[i], data + i * info.strides[0], sizeof(uint64_t));
+        }
+        return addresses;
+    }
+
+    std::string path_;
     llvm::object::OwningBinary<llvm::object::ObjectFile> object_;
     std::unique_ptr<llvm::DWARFContext> context_;
+    std::once_flag linkage_index_once_;
+    std::unique_ptr<dwarf2cpp::LinkageNameIndex> linkage_index_;
+    std::once_flag symbolizer_once_;
+    std::unique_ptr<dwarf2cpp::Symbolizer> symbolizer_;
+    std::mutex symbol_objects_mutex_;
+    std::unordered_map<uint32_t, py::object> symbol_objects_;
+};
+
+struct PyDWARFIndexEntry {
+    std::shared_ptr<const dwarf2cpp::DieIndex> index;
+    uint32_t position;
+
+    [[nodiscard]] const dwarf2cpp::DieIndexEntry &entry() const { return (*index)[position]; }
+};
+
+class PyDWARFIndex {
+public:
+    explicit PyDWARFIndex(const std::string &path) : index_(dwarf2cpp::DieIndex::open(path)) {}
+
+    [[nodiscard]] auto matches(const std::string &binary_path) const {
+        return index_->matches(binary_path);
+    }
+
+    [[nodiscard]] auto size() const { return index_->size(); }
+
+    [[nodiscard]] PyDWARFIndexEntry at(uint32_t i) const {
+        if (i >= index_->size()) {
+            throw py::index_error("DIE index entry out of range");
+        }
+        return {index_, i};
+    }
+
+    [[nodiscard]] auto lookup(const std::string &name) const { return wrap(index_->lookup(name)); }
+
+    [[nodiscard]] auto roots() const { return wrap(index_->roots()); }
+
+    [[nodiscard]] auto children(const PyDWARFIndexEntry &entry) const {
+        return wrap(index_->children(entry.position));
+    }
+
+    // All descendants of an entry in depth-first order, or all entries if no entry is given.
+    [[nodiscard]] auto flatten(const std::optional<PyDWARFIndexEntry> &entry) const {
+        uint32_t begin = 0;
+        uint32_t end = index_->size();
+        if (entry) {
+            begin = entry->position + 1;
+            end = std::min(entry->entry().subtree_end, end);
+        }
+
+        std::vector<PyDWARFIndexEntry> result;
+        result.reserve(end > begin ? end - begin : 0);
+        for (auto i = begin; i < end; ++i) {
+            result.push_back({index_, i});
+        }
+        return result;
+    }
+
+private:
+    [[nodiscard]] std::vector<PyDWARFIndexEntry>
+    wrap(const std::vector<uint32_t> &positions) const {
+        std::vector<PyDWARFIndexEntry> result;
+        result.reserve(positions.size());
+        for (auto position : positions) {
+            result.push_back({index_, position});
+        }
+        return result;
+    }
+
+    std::shared_ptr<const dwarf2cpp::DieIndex> index_;
 };
 
+// The methods are called without the GIL, the mutex serializes threads sharing a printer.
 class PyDWARFTypePrinter {
 public:
     PyDWARFTypePrinter() : os(buffer), printer(os) {}
     std::string string() {
+        std::lock_guard lock(mutex);
         os.flush();
         return buffer;
     }
-    auto appendQualifiedName(llvm::DWARFDie die) { printer.appendQualifiedName(die); }
+    auto appendQualifiedName(llvm::DWARFDie die) {
+        std::lock_guard lock(mutex);
+        printer.appendQualifiedName(die);
+    }
     llvm::DWARFDie appendQualifiedNameBefore(llvm::DWARFDie die) {
+        std::lock_guard lock(mutex);
         return printer.appendQualifiedNameBefore(die);
     }
-    auto appendUnqualifiedName(llvm::DWARFDie die) { printer.appendUnqualifiedName(die); }
+    auto appendUnqualifiedName(llvm::DWARFDie die) {
+        std::lock_guard lock(mutex);
+        printer.appendUnqualifiedName(die);
+    }
     auto appendUnqualifiedNameBefore(llvm::DWARFDie die) {
+        std::lock_guard lock(mutex);
         return printer.appendUnqualifiedNameBefore(die);
     }
     auto appendUnqualifiedNameAfter(llvm::DWARFDie die, llvm::DWARFDie inner) {
+        std::lock_guard lock(mutex);
         printer.appendUnqualifiedNameAfter(die, inner);
     }
-    auto appendScopes(llvm::DWARFDie die) { printer.appendScopes(die); }
+    auto appendScopes(llvm::DWARFDie die) {
+        std::lock_guard lock(mutex);
+        printer.appendScopes(die);
+    }
 
 private:
+    std::mutex mutex;
     std::string buffer;
     llvm::raw_string_ostream os;
     llvm::DWARFTypePrinter printer;
 };
 
-PYBIND11_MODULE(_dwarf, m) {
+PYBIND11_MODULE(_dwarf, m, py::mod_gil_not_used()) {
     py::native_enum<llvm::dwarf::AccessAttribute>(m, "AccessAttribute", "enum.IntEnum")
         .value("PUBLIC", llvm::dwarf::DW_ACCESS_public)
         .value("PROTECTED", llvm::dwarf::DW_ACCESS_protected)
@@ -194,8 +388,46 @@ PYBIND11_MODULE(_dwarf, m) {
         .value("DECLARED_INLINED", llvm::dwarf::DW_INL_declared_inlined)
         .finalize();
 
+    m.def(
+        "demangle_many",
+        [](const std::vector<std::string> &names) {
+            py::gil_scoped_release release;
+            TraceSpan span("demangle_many");
+            std::vector<std::string> result(names.size());
+            llvm::parallelFor(0, names.size(), [&](size_t i) {
+                result[i] = llvm::demangle(names[i]);
+            });
+            return result;
+        },
+        py::arg("names"),
+        "Demangle names in parallel, names that cannot be demangled are returned as is.");
+
+    m.def("trace_clock",
+          &dwarf2cpp::TraceClock,
+          "Nanoseconds on the monotonic clock of the native spans.");
+    m.def("start_trace",
+          &dwarf2cpp::StartTrace,
+          "Start recording the native spans of every thread, dropping those of a previous trace.");
+    m.def(
+        "stop_trace",
+        [] {
+            py::list result;
+            for (const auto &event : dwarf2cpp::StopTrace()) {
+                result.append(py::make_tuple(event.name,
+                                             event.start_ns,
+                                             event.duration_ns,
+                                             event.thread_id,
+                                             event.unit_offset));
+            }
+            return result;
+        },
+        "Stop recording and return the native spans as (name, start_ns, duration_ns, thread_id, "
+        "unit_offset) tuples.");
+
     py::class_<PyDWARFContext>(m, "DWARFContext")
-        .def(py::init<const std::string &>(), py::arg("path"))
+        .def(py::init<const std::string &>(),
+             py::arg("path"),
+             py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("info_section_units",
                                &PyDWARFContext::info_section_units,
                                py::return_value_policy::reference_internal)
@@ -212,20 +444,143 @@ PYBIND11_MODULE(_dwarf, m) {
         .def_property_readonly("max_version", &PyDWARFContext::getMaxVersion)
         .def_property_readonly("max_dwo_version", &PyDWARFContext::getMaxDWOVersion)
         .def_property_readonly("is_little_endian", &PyDWARFContext::isLittleEndian)
-        .def_property_readonly("cu_addr_size", &PyDWARFContext::getCUAddrSize);
+        .def_property_readonly("cu_addr_size", &PyDWARFContext::getCUAddrSize)
+        .def("die_at",
+             &PyDWARFContext::dieAt,
+             py::arg("offset"),
+             py::arg("types_section") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def("write_index",
+             &PyDWARFContext::writeIndex,
+             py::arg("path"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("function_symbols",
+             &PyDWARFContext::functionSymbols,
+             py::call_guard<py::gil_scoped_release>())
+        .def("memory_stats",
+             &PyDWARFContext::memoryStats,
+             py::call_guard<py::gil_scoped_release>())
+        .def("find_linkage_name",
+             &PyDWARFContext::findLinkageName,
+             py::arg("linkage_name"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("symbolize", &PyDWARFContext::symbolize, py::arg("addresses"));
+
+    py::class_<PyDWARFIndex>(m, "DWARFIndex")
+        .def(py::init<const std::string &>(),
+             py::arg("path"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("matches", &PyDWARFIndex::matches, py::arg("binary_path"))
+        .def("lookup", &PyDWARFIndex::lookup, py::arg("name"))
+        .def_property_readonly("roots", &PyDWARFIndex::roots)
+        .def("children", &PyDWARFIndex::children, py::arg("entry"))
+        .def("flatten", &PyDWARFIndex::flatten, py::arg("entry") = py::none())
+        .def("__len__", &PyDWARFIndex::size)
+        .def("__getitem__", &PyDWARFIndex::at);
+
+    py::class_<PyDWARFIndexEntry>(m, "DWARFIndexEntry")
+        .def_readonly("index", &PyDWARFIndexEntry::position)
+        .def_property_readonly("offset",
+                               [](const PyDWARFIndexEntry &self) { return self.entry().offset; })
+        .def_property_readonly(
+            "tag",
+            [](const PyDWARFIndexEntry &self) {
+                return TagString(static_cast<llvm::dwarf::Tag>(self.entry().tag)).str();
+            })
+        .def_property_readonly(
+            "parent",
+            [](const PyDWARFIndexEntry &self) -> std::optional<PyDWARFIndexEntry> {
+                auto parent = self.entry().parent;
+                if (parent >= self.index->size()) {
+                    return std::nullopt;
+                }
+                return PyDWARFIndexEntry{self.index, parent};
+            })
+        .def_property_readonly(
+            "short_name",
+            [](const PyDWARFIndexEntry &self) -> std::optional<std::string> {
+                if (auto name = self.index->name(self.position); !name.empty()) {
+                    return name.str();
+                }
+                return std::nullopt;
+            })
+        .def_property_readonly("decl_file",
+                               [](const PyDWARFIndexEntry &self) -> std::optional<std::string> {
+                                   if (auto file = self.index->declFile(self.position)) {
+                                       return file->str();
+                                   }
+                                   return std::nullopt;
+                               })
+        .def_property_readonly(
+            "decl_line", [](const PyDWARFIndexEntry &self) { return self.entry().decl_line; })
+        .def_property_readonly(
+            "types_section",
+            [](const PyDWARFIndexEntry &self) { return self.entry().types_section != 0; })
+        .def("__eq__",
+             [](const PyDWARFIndexEntry &self, const PyDWARFIndexEntry &other) {
+                 return self.index == other.index && self.position == other.position;
+             })
+        .def("__hash__", [](const PyDWARFIndexEntry &self) { return self.position; });
 
     py::class_<llvm::DWARFUnit>(m, "DWARFUnit")
         .def_property_readonly("offset", &llvm::DWARFUnit::getOffset)
         .def_property_readonly("length", &llvm::DWARFUnit::getLength)
         .def_property_readonly("is_type_unit", &llvm::DWARFUnit::isTypeUnit)
-        .def_property_readonly("unit_die",
-                               [](llvm::DWARFUnit &self) -> std::optional<llvm::DWARFDie> {
-                                   if (auto die = self.getUnitDIE(false); die.isValid()) {
-                                       return die;
-                                   }
-                                   return std::nullopt;
-                               })
-        .def_property_readonly("compilation_dir", &llvm::DWARFUnit::getCompilationDir);
+        .def_property_readonly(
+            "type_signature",
+            [](llvm::DWARFUnit &self) -> std::optional<uint64_t> {
+                if (auto *type_unit = llvm::dyn_cast<llvm::DWARFTypeUnit>(&self)) {
+                    return type_unit->getTypeHash();
+                }
+                return std::nullopt;
+            })
+        .def_property_readonly(
+            "type_die",
+            py::cpp_function(
+                [](llvm::DWARFUnit &self) -> std::optional<llvm::DWARFDie> {
+                    if (auto *type_unit = llvm::dyn_cast<llvm::DWARFTypeUnit>(&self)) {
+                        auto die = type_unit->getDIEForOffset(type_unit->getTypeOffset()
+                                                              + type_unit->getOffset());
+                        if (die.isValid()) {
+                            return die;
+                        }
+                    }
+                    return std::nullopt;
+                },
+                py::call_guard<py::gil_scoped_release>()))
+        // parses every DIE of the unit on the first access
+        .def_property_readonly(
+            "unit_die",
+            py::cpp_function(
+                [](llvm::DWARFUnit &self) -> std::optional<llvm::DWARFDie> {
+                    std::optional<TraceSpan> span;
+                    if (dwarf2cpp::Tracing() && !dwarf2cpp::DIEsExtracted(self)) {
+                        span.emplace("extract_dies", self.getOffset());
+                    }
+                    if (auto die = self.getUnitDIE(false); die.isValid()) {
+                        return die;
+                    }
+                    return std::nullopt;
+                },
+                py::call_guard<py::gil_scoped_release>()))
+        .def_property_readonly("compilation_dir", &llvm::DWARFUnit::getCompilationDir)
+        .def_property_readonly("fingerprint",
+                               py::cpp_function(
+                                   [](llvm::DWARFUnit &self) {
+                                       TraceSpan span("fingerprint", self.getOffset());
+                                       return UnitFingerprint(self);
+                                   },
+                                   py::call_guard<py::gil_scoped_release>()))
+        .def_property_readonly("has_cross_unit_references",
+                               &HasCrossUnitReferences,
+                               py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("line_table_files",
+                               py::cpp_function(
+                                   [](llvm::DWARFUnit &self) {
+                                       TraceSpan span("line_table", self.getOffset());
+                                       return LineTableFiles(self);
+                                   },
+                                   py::call_guard<py::gil_scoped_release>()));
 
     py::class_<llvm::DWARFDie>(m, "DWARFDie")
         .def_property_readonly("unit", &llvm::DWARFDie::getDwarfUnit)
@@ -239,58 +594,28 @@ PYBIND11_MODULE(_dwarf, m) {
                                    }
                                    return std::nullopt;
                                })
-        .def_property_readonly("short_name",
-                               [](const llvm::DWARFDie &self) {
-                                   return llvm::dwarf::toString(
-                                       findRecursively(self, llvm::dwarf::DW_AT_name), nullptr);
-                               })
-        .def_property_readonly("linkage_name",
-                               [](const llvm::DWARFDie &self) {
-                                   return llvm::dwarf::toString(
-                                       findRecursively(self,
-                                                       {llvm::dwarf::DW_AT_MIPS_linkage_name,
-                                                        llvm::dwarf::DW_AT_linkage_name}),
-                                       nullptr);
-                               })
-        .def_property_readonly("decl_line",
-                               [](const llvm::DWARFDie &self) {
-                                   return llvm::dwarf::toUnsigned(
-                                       findRecursively(self, llvm::dwarf::DW_AT_decl_line), 0);
+        .def_property_readonly("short_name", &ShortName)
+        .def_property_readonly("linkage_name", &LinkageName)
+        .def_property_readonly("decl_line", &DeclLine)
+        .def_property_readonly("decl_file", &DeclFileName)
+        .def_property_readonly("type_size",
+                               [](llvm::DWARFDie &self) {
+                                   return self.getTypeSize(
+                                       self.getDwarfUnit()->getAddressByteSize());
                                })
-        .def_property_readonly(
-            "decl_file",
-            [](const llvm::DWARFDie &self) -> std::optional<std::string> {
-                if (auto form = findRecursively(self, llvm::dwarf::DW_AT_decl_file))
-                    return form->getAsFile(
-                        llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath);
-                return std::nullopt;
-            })
-        .def_property_readonly("attributes",
-                               [](const llvm::DWARFDie &self) {
-                                   std::vector<llvm::DWARFAttribute> attrs;
-                                   for (const auto &attr : self.attributes()) {
-                                       attrs.emplace_back(attr);
-                                   }
-                                   return attrs;
-                               })
-        .def_property_readonly("children",
-                               [](const llvm::DWARFDie &self) {
-                                   std::vector<llvm::DWARFDie> children;
-                                   for (const auto &child : self.children()) {
-                                       if (child.isValid()) {
-                                           children.emplace_back(child);
-                                       }
-                                   }
-                                   return children;
-                               })
-        .def("dump",
-             [](const llvm::DWARFDie &self) {
-                 std::string result;
-                 llvm::raw_string_ostream os(result);
-                 self.dump(os);
-                 os.flush();
-                 return result;
-             })
+        .def_property_readonly("type_alignment", &TypeAlignment)
+        .def_property_readonly("attributes", &Attributes)
+        .def_property_readonly("children", &Children)
+        .def(
+            "dump",
+            [](const llvm::DWARFDie &self) {
+                std::string result;
+                llvm::raw_string_ostream os(result);
+                self.dump(os);
+                os.flush();
+                return result;
+            },
+            py::call_guard<py::gil_scoped_release>())
         .def("find",
              [](const llvm::DWARFDie &self, const std::string &attribute) {
                  return self.find(ToAttribute(attribute));
@@ -320,24 +645,8 @@ PYBIND11_MODULE(_dwarf, m) {
                                })
         .def("as_referenced_die",
              [](const llvm::DWARFFormValue &self) -> std::optional<llvm::DWARFDie> {
-                 llvm::DWARFDie result;
-                 auto &V = self;
-                 auto *U = self.getUnit();
-                 if (std::optional<uint64_t> offset = V.getAsRelativeReference()) {
-                     result = const_cast<llvm::DWARFUnit *>(V.getUnit())
-                                  ->getDIEForOffset(V.getUnit()->getOffset() + offset.value());
-                 } else if (offset = V.getAsDebugInfoReference(); offset) {
-                     if (llvm::DWARFUnit *spec_unit
-                         = U->getUnitVector().getUnitForOffset(offset.value()))
-                         result = spec_unit->getDIEForOffset(*offset);
-                 } else if (std::optional<uint64_t> sig = V.getAsSignatureReference()) {
-                     if (llvm::DWARFTypeUnit *TU = U->getContext().getTypeUnitForHash(
-                             U->getVersion(), sig.value(), U->isDWOUnit()))
-                         result = TU->getDIEForOffset(TU->getTypeOffset() + TU->getOffset());
-                 }
-
-                 if (result.isValid()) {
-                     return result;
+                 if (auto die = ReferencedDie(self); die.isValid()) {
+                     return die;
                  }
                  return std::nullopt;
              })
@@ -349,23 +658,50 @@ PYBIND11_MODULE(_dwarf, m) {
                  }
                  throw py::value_error(toString(e.takeError()));
              })
-        .def("as_constant", [](const llvm::DWARFFormValue &self) -> py::int_ {
-            if (auto s = self.getAsSignedConstant(); s) {
-                return s.value();
-            }
-            if (auto u = self.getAsUnsignedConstant(); u) {
-                return u.value();
+        .def("as_constant",
+             [](const llvm::DWARFFormValue &self) -> py::int_ {
+                 if (auto s = self.getAsSignedConstant(); s) {
+                     return s.value();
+                 }
+                 if (auto u = self.getAsUnsignedConstant(); u) {
+                     return u.value();
+                 }
+                 throw py::value_error("Invalid constant value");
+             })
+        .def("as_block",
+             [](const llvm::DWARFFormValue &self) {
+                 if (auto block = self.getAsBlock(); block) {
+                     return py::bytes(reinterpret_cast<const char *>(block->data()),
+                                      block->size());
+                 }
+                 throw py::value_error("Invalid block value");
+             })
+        .def("as_address", [](const llvm::DWARFFormValue &self) {
+            if (auto address = self.getAsAddress(); address) {
+                return address.value();
             }
-            throw py::value_error("Invalid constant value");
+            throw py::value_error("Invalid address value");
         });
 
     py::class_<PyDWARFTypePrinter>(m, "DWARFTypePrinter")
         .def(py::init())
-        .def("append_qualified_name", &PyDWARFTypePrinter::appendQualifiedName)
-        .def("append_qualified_name_before", &PyDWARFTypePrinter::appendQualifiedNameBefore)
-        .def("append_unqualified_name", &PyDWARFTypePrinter::appendUnqualifiedName)
-        .def("append_unqualified_name_before", &PyDWARFTypePrinter::appendUnqualifiedNameBefore)
-        .def("append_unqualified_name_after", &PyDWARFTypePrinter::appendUnqualifiedNameAfter)
-        .def("append_scopes", &PyDWARFTypePrinter::appendScopes)
-        .def("__str__", &PyDWARFTypePrinter::string);
+        .def("append_qualified_name",
+             &PyDWARFTypePrinter::appendQualifiedName,
+             py::call_guard<py::gil_scoped_release>())
+        .def("append_qualified_name_before",
+             &PyDWARFTypePrinter::appendQualifiedNameBefore,
+             py::call_guard<py::gil_scoped_release>())
+        .def("append_unqualified_name",
+             &PyDWARFTypePrinter::appendUnqualifiedName,
+             py::call_guard<py::gil_scoped_release>())
+        .def("append_unqualified_name_before",
+             &PyDWARFTypePrinter::appendUnqualifiedNameBefore,
+             py::call_guard<py::gil_scoped_release>())
+        .def("append_unqualified_name_after",
+             &PyDWARFTypePrinter::appendUnqualifiedNameAfter,
+             py::call_guard<py::gil_scoped_release>())
+        .def("append_scopes",
+             &PyDWARFTypePrinter::appendScopes,
+             py::call_guard<py::gil_scoped_release>())
+        .def("__str__", &PyDWARFTypePrinter::string, py::call_guard<py::gil_scoped_release>());
 }
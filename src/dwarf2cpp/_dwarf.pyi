@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 import enum
+from collections.abc import Buffer
 
 __all__: list[str] = [
     "AccessAttribute",
@@ -8,10 +9,16 @@ __all__: list[str] = [
     "DWARFContext",
     "DWARFDie",
     "DWARFFormValue",
+    "DWARFIndex",
+    "DWARFIndexEntry",
     "DWARFTypePrinter",
     "DWARFUnit",
     "InlineAttribute",
     "VirtualityAttribute",
+    "demangle_many",
+    "start_trace",
+    "stop_trace",
+    "trace_clock",
 ]
 
 class AccessAttribute(enum.IntEnum):
@@ -31,6 +38,12 @@ class DWARFAttribute:
 
 class DWARFContext:
     def __init__(self, path: str) -> None: ...
+    def die_at(self, offset: int, types_section: bool = False) -> DWARFDie | None: ...
+    def find_linkage_name(self, linkage_name: str) -> list[DWARFDie]: ...
+    def function_symbols(self) -> list[tuple[str, int, int]]: ...
+    def memory_stats(self) -> dict[str, int]: ...
+    def symbolize(self, addresses: Buffer) -> list[tuple[str | None, str | None, int] | None]: ...
+    def write_index(self, path: str) -> None: ...
     @property
     def compile_units(self) -> list[DWARFUnit]: ...
     @property
@@ -79,15 +92,52 @@ class DWARFDie:
     @property
     def tag(self) -> str: ...
     @property
+    def type_alignment(self) -> int | None: ...
+    @property
+    def type_size(self) -> int | None: ...
+    @property
     def unit(self) -> DWARFUnit: ...
 
 class DWARFFormValue:
+    def as_address(self) -> int: ...
+    def as_block(self) -> bytes: ...
     def as_constant(self) -> int: ...
     def as_referenced_die(self) -> DWARFDie | None: ...
     def as_string(self) -> str: ...
     @property
     def form(self) -> str: ...
 
+class DWARFIndex:
+    def __init__(self, path: str) -> None: ...
+    def __getitem__(self, index: int) -> DWARFIndexEntry: ...
+    def __len__(self) -> int: ...
+    def children(self, entry: DWARFIndexEntry) -> list[DWARFIndexEntry]: ...
+    def flatten(self, entry: DWARFIndexEntry | None = None) -> list[DWARFIndexEntry]: ...
+    def lookup(self, name: str) -> list[DWARFIndexEntry]: ...
+    def matches(self, binary_path: str) -> bool: ...
+    @property
+    def roots(self) -> list[DWARFIndexEntry]: ...
+
+class DWARFIndexEntry:
+    def __eq__(self, value: DWARFIndexEntry) -> bool: ...
+    def __hash__(self) -> int: ...
+    @property
+    def decl_file(self) -> str | None: ...
+    @property
+    def decl_line(self) -> int: ...
+    @property
+    def index(self) -> int: ...
+    @property
+    def offset(self) -> int: ...
+    @property
+    def parent(self) -> DWARFIndexEntry | None: ...
+    @property
+    def short_name(self) -> str | None: ...
+    @property
+    def tag(self) -> str: ...
+    @property
+    def types_section(self) -> bool: ...
+
 class DWARFTypePrinter:
     def __init__(self) -> None: ...
     def __str__(self) -> str: ...
@@ -102,12 +152,22 @@ class DWARFUnit:
     @property
     def compilation_dir(self) -> str: ...
     @property
+    def fingerprint(self) -> str: ...
+    @property
+    def has_cross_unit_references(self) -> bool: ...
+    @property
     def is_type_unit(self) -> bool: ...
     @property
     def length(self) -> int: ...
     @property
+    def line_table_files(self) -> list[str]: ...
+    @property
     def offset(self) -> int: ...
     @property
+    def type_die(self) -> DWARFDie | None: ...
+    @property
+    def type_signature(self) -> int | None: ...
+    @property
     def unit_die(self) -> DWARFDie | None: ...
 
 class InlineAttribute(enum.IntEnum):
@@ -120,3 +180,8 @@ class VirtualityAttribute(enum.IntEnum):
     NONE = 0
     VIRTUAL = 1
     PURE_VIRTUAL = 2
+
+def demangle_many(names: list[str]) -> list[str]: ...
+def start_trace() -> None: ...
+def stop_trace() -> list[tuple[str, int, int, int, int | None]]: ...
+def trace_clock() -> int: ...
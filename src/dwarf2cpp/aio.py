@@ -0,0 +1,111 @@
+import asyncio
+import concurrent.futures
+import contextlib
+import logging
+import threading
+from pathlib import Path
+from typing import Any, AsyncGenerator
+
+from ._dwarf import DWARFContext
+from .models import Object
+from .visitor import Visitor
+
+logger = logging.getLogger("dwarf2cpp")
+
+_DONE = object()
+
+# interval, in seconds, at which the background thread checks whether the consumer went away while the queue is full
+_POLL_INTERVAL = 0.1
+
+
+class _Stopped(Exception):
+    pass
+
+
+class _Failure:
+    def __init__(self, error: BaseException):
+        self.error = error
+
+
+async def extract_async(
+    path: str | Path,
+    base_dir: str,
+    max_pending: int = 8,
+    **kwargs: Any,
+) -> AsyncGenerator[tuple[str, dict[int, list[Object]]], None]:
+    """Extract the files of a binary without blocking the event loop.
+
+    The binary is opened and visited on a background thread, and the files are handed over through a bounded queue as
+    soon as they are complete. The background thread waits while ``max_pending`` files have not been consumed yet.
+
+    Breaking out of the iteration, cancelling the task that iterates or closing the event loop stops the background
+    thread before it visits the next unit, even while it is waiting for room in the queue.
+
+    Args:
+        path: Path to the binary
+        base_dir: Base directory used during compilation
+        max_pending: Maximum number of files waiting to be consumed
+        **kwargs: Other arguments of the Visitor, such as ``cache`` or ``selection``
+
+    Yields:
+        Relative path and contents of each file
+    """
+    loop = asyncio.get_running_loop()
+    queue: asyncio.Queue = asyncio.Queue(maxsize=max_pending)
+    cancelled = threading.Event()
+    visitor: Visitor | None = None
+
+    def put(item: Any) -> None:
+        # wait for room in the queue, but give up once the generator is closed or the loop is gone, which would
+        # otherwise leave the future pending forever
+        future = None
+        while not cancelled.is_set() and not loop.is_closed():
+            try:
+                if future is None:
+                    future = asyncio.run_coroutine_threadsafe(queue.put(item), loop)
+                future.result(timeout=_POLL_INTERVAL)
+                return
+            except concurrent.futures.TimeoutError:
+                continue
+            except (RuntimeError, concurrent.futures.CancelledError):
+                # the loop was closed while scheduling the call, or cancelled it while shutting down
+                break
+
+        if future is not None:
+            future.cancel()
+        raise _Stopped
+
+    def extract() -> None:
+        nonlocal visitor
+        try:
+            # the GIL is released while the binary is opened
+            context = DWARFContext(str(path))
+            visitor = Visitor(context, base_dir, **kwargs)
+            if cancelled.is_set():
+                visitor.cancel()
+
+            for item in visitor.files:
+                put(item)
+            put(_DONE)
+        except _Stopped:
+            logger.debug("Stopped extracting, the files are no longer consumed")
+        except BaseException as e:
+            with contextlib.suppress(_Stopped):
+                put(_Failure(e))
+
+    thread = threading.Thread(target=extract, name="dwarf2cpp-extract", daemon=True)
+    thread.start()
+    try:
+        while (item := await queue.get()) is not _DONE:
+            if isinstance(item, _Failure):
+                raise item.error
+
+            yield item
+    finally:
+        cancelled.set()
+        if visitor is not None:
+            visitor.cancel()
+
+        # unblock the background thread if it is waiting for room in the queue, it stops on its own afterward
+        while not queue.empty():
+            queue.get_nowait()
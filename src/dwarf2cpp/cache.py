@@ -0,0 +1,173 @@
+import contextlib
+import hashlib
+import logging
+import os
+import tempfile
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Generator
+
+from . import serialization
+from ._dwarf import DWARFUnit
+from .models import Attribute, Enum, Function, Object, Struct, Template, TypeDef
+
+logger = logging.getLogger("dwarf2cpp")
+
+# Bump this whenever a change to the models or the visitor invalidates previously cached results.
+CACHE_VERSION = 9
+
+
+def write_atomic(path: Path, data: bytes) -> None:
+    """Write data to a temporary file and atomically rename it into place."""
+    fd, tmp = tempfile.mkstemp(dir=path.parent, suffix=".tmp")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            f.write(data)
+        os.replace(tmp, path)
+    except BaseException:
+        with contextlib.suppress(OSError):
+            os.unlink(tmp)
+        raise
+
+
+class Store:
+    """
+    A directory of serialized values keyed by hex digests.
+
+    Entries are written to a temporary file and atomically renamed into place, so that concurrent runs sharing the
+    same directory never observe partially written entries. Entries are serialized with the serialization module,
+    so that a directory shared with other users cannot run code when loading them.
+    """
+
+    def __init__(self, path: Path):
+        self.path = path
+        self.path.mkdir(parents=True, exist_ok=True)
+
+    def load(self, key: str) -> Any | None:
+        try:
+            return serialization.loads(self._path(key).read_bytes())
+        except FileNotFoundError:
+            return None
+        except Exception as e:
+            logger.warning(f"Ignoring unreadable cache entry {key}: {e}")
+            return None
+
+    def store(self, key: str, value: Any) -> None:
+        path = self._path(key)
+        path.parent.mkdir(exist_ok=True)
+        write_atomic(path, serialization.dumps(value))
+
+    def _path(self, key: str) -> Path:
+        return self.path / key[:2] / f"{key}.json.z"
+
+
+@dataclass
+class UnitContribution:
+    """Everything the visit of a single unit contributes to the state shared across units."""
+
+    # location of the unit in the binary it was visited from
+    unit_offset: int = 0
+    unit_length: int = 0
+    # (decl_file, decl_line, object) in the order they were added to the files
+    objects: list[tuple[str, int, Object]] = field(default_factory=list)
+    # (key, functions, parameter names) in the order they were registered for the parameter name sync
+    functions: list[tuple[tuple[str, int], list[Function], list[str | None]]] = field(default_factory=list)
+    # (offset of a function definition, functions whose address it gives), the addresses themselves are not cached
+    # since relinking moves the code of a unit without changing its fingerprint, they are read again from the DIEs
+    addresses: list[tuple[int, list[Function]]] = field(default_factory=list)
+
+    def rebase(self, unit_offset: int) -> None:
+        """Shift the DIE offsets of the objects from this unit to where the unit is located in another binary."""
+        delta = unit_offset - self.unit_offset
+        if delta == 0:
+            return
+
+        end = self.unit_offset + self.unit_length
+        for obj in self.reachable():
+            if obj.die_offset is not None and self.unit_offset <= obj.die_offset < end:
+                obj.die_offset += delta
+
+        self.addresses = [(offset + delta, functions) for offset, functions in self.addresses]
+        self.unit_offset = unit_offset
+
+    def reachable(self) -> Generator[Object, None, None]:
+        """Yield every object this unit contributed or references, once."""
+        seen = set()
+        stack = [obj for _, _, obj in self.objects] + [f for _, functions, _ in self.functions for f in functions]
+        while stack:
+            obj = stack.pop()
+            if not isinstance(obj, Object) or id(obj) in seen:
+                continue
+
+            seen.add(id(obj))
+            yield obj
+
+            stack.append(obj.template)
+            if isinstance(obj, Struct):
+                for members in obj.members.values():
+                    stack.extend(members)
+            elif isinstance(obj, Attribute):
+                stack.append(obj.type)
+            elif isinstance(obj, TypeDef):
+                stack.append(obj.value)
+            elif isinstance(obj, Template):
+                stack.append(obj.declaration)
+
+
+@dataclass
+class TypeContribution:
+    """The type described by a type unit, along with the functions it registered for the parameter name sync."""
+
+    type: Struct | Enum | None = None
+    functions: list[tuple[tuple[str, int], list[Function], list[str | None]]] = field(default_factory=list)
+
+
+class UnitCache:
+    """
+    Cache of unit contributions keyed by the fingerprint of the unit contents.
+    """
+
+    def __init__(self, path: Path, base_dir: str):
+        self._store = Store(path)
+        self._base_dir = base_dir
+
+    def key(self, unit: DWARFUnit) -> str:
+        return hashlib.sha256(f"{CACHE_VERSION}:{self._base_dir}:{unit.fingerprint}".encode()).hexdigest()
+
+    def load(self, key: str) -> UnitContribution | None:
+        fields = self._store.load(key)
+        return UnitContribution(**fields) if fields is not None else None
+
+    def store(self, key: str, contribution: UnitContribution) -> None:
+        functions = [obj for obj in contribution.reachable() if isinstance(obj, Function) and obj.address]
+        addresses = [function.address for function in functions]
+        for function in functions:
+            function.address = None
+
+        try:
+            self._store.store(key, vars(contribution))
+        finally:
+            for function, address in zip(functions, addresses):
+                function.address = address
+
+
+class TypeCache:
+    """
+    Cache of the types described by type units, keyed by their 64-bit type signature.
+
+    Type signatures are derived from the contents of the type, so entries can be shared between binaries and builds.
+    """
+
+    def __init__(self, path: Path):
+        self._store = Store(path)
+
+    def load(self, signature: int) -> TypeContribution | None:
+        fields = self._store.load(self._key(signature))
+        return TypeContribution(**fields) if fields is not None else None
+
+    def store(self, signature: int, contribution: TypeContribution) -> None:
+        self._store.store(self._key(signature), vars(contribution))
+
+    @staticmethod
+    def _key(signature: int) -> str:
+        return f"{signature:016x}-v{CACHE_VERSION}"
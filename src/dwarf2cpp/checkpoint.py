@@ -0,0 +1,74 @@
+import hashlib
+import logging
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any
+
+from . import serialization
+from .cache import CACHE_VERSION, write_atomic
+
+logger = logging.getLogger("dwarf2cpp")
+
+CHECKPOINT_NAME = ".dwarf2cpp-checkpoint"
+
+
+@dataclass
+class Checkpoint:
+    """The state of the visitor after a compile unit was visited."""
+
+    identity: tuple
+    # index of the first compile unit that was not visited yet
+    next_unit: int
+    state: dict[str, Any]
+
+
+def run_identity(path: Path, base_dir: str, selection: set[str] | None) -> tuple:
+    """Identify the inputs of a run, a checkpoint can only be resumed by a run with the same identity."""
+    stat = path.stat()
+    selection_hash = None
+    if selection is not None:
+        selection_hash = hashlib.sha256("\n".join(sorted(selection)).encode()).hexdigest()
+
+    return CACHE_VERSION, str(path.absolute()), stat.st_size, stat.st_mtime_ns, base_dir, selection_hash
+
+
+class CheckpointJournal:
+    """
+    Journal of the most recent checkpoint of a run, written at most once per interval.
+
+    Each checkpoint atomically replaces the previous one, so that a run that is killed at any point can be resumed
+    from the last complete checkpoint.
+    """
+
+    def __init__(self, path: Path, identity: tuple, interval: float):
+        self.path = path
+        self._identity = identity
+        self._interval = interval
+        self._last = time.monotonic()
+
+    def load(self) -> Checkpoint | None:
+        try:
+            checkpoint = Checkpoint(*serialization.loads(self.path.read_bytes()))
+        except FileNotFoundError:
+            return None
+
+        if checkpoint.identity != self._identity:
+            raise ValueError(
+                f"Checkpoint {self.path} was written for a different binary, base directory or version of dwarf2cpp"
+            )
+
+        return checkpoint
+
+    def due(self) -> bool:
+        return self._interval > 0 and time.monotonic() - self._last >= self._interval
+
+    def write(self, next_unit: int, state: dict[str, Any]) -> None:
+        start = time.monotonic()
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        write_atomic(self.path, serialization.dumps((self._identity, next_unit, state)))
+        self._last = time.monotonic()
+        logger.debug(f"Checkpoint written after {next_unit} compile units in {self._last - start:.1f}s")
+
+    def remove(self) -> None:
+        self.path.unlink(missing_ok=True)
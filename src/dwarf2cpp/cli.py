@@ -1,20 +1,99 @@
+import asyncio
+import contextlib
+import json
 import logging
+import posixpath
 from pathlib import Path
+from typing import Iterable
 
 import click
-from jinja2 import Environment, FileSystemLoader
 from tqdm import tqdm
 
+from . import profiling
 from ._dwarf import DWARFContext
-from .filters import do_insert_name, do_ns_actions, do_ns_chain
-from .post_process import cleanup
+from .cache import TypeCache, UnitCache
+from .checkpoint import CHECKPOINT_NAME, CheckpointJournal, run_identity
+from .delta import find_changed_files
+from .diff import diff, format_changes
+from .index import DeclarationIndex
+from .ir import IRWriter, read_ir
+from .layout import CACHE_LINE_SIZE, LayoutReport
+from .models import Object
+from .reflection import ReflectionHeader
+from .render import create_environment, render_file
+from .server import QueryEngine, Server, find_entries, open_index
+from .subset import Scrambler, subset
+from .symbols import SymbolAddressTable
 from .visitor import Visitor
+from .vtables import VTableSlots
 
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger("dwarf2cpp")
 
 
-@click.command()
+class DefaultGroup(click.Group):
+    """
+    Group that falls back to a default command when the first argument is not a command, so that
+    ``python -m dwarf2cpp PATH`` keeps working.
+    """
+
+    def __init__(self, *args, default: str, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.default = default
+
+    def parse_args(self, ctx: click.Context, args: list[str]) -> list[str]:
+        if args and args[0] not in self.commands and args[0] not in self.get_help_option_names(ctx):
+            args.insert(0, self.default)
+
+        return super().parse_args(ctx, args)
+
+
+def write_files(
+    files: Iterable[tuple[str, dict[int, list[Object]]]],
+    output_path: Path,
+    sinks: Iterable = (),
+    patch: bool = False,
+) -> set[str]:
+    """Render files into the output directory.
+
+    Args:
+        files: Files to render, by relative path
+        output_path: Output directory
+        sinks: Other outputs, each file is also passed to their ``add_file`` method
+        patch: Whether to leave the files whose contents did not change untouched
+
+    Returns:
+        Relative paths of the files that were generated
+    """
+    env = create_environment()
+    generated = set()
+    for rel_path, file in (pbar := tqdm(files)):
+        with profiling.trace_span("file", path=rel_path):
+            for sink in sinks:
+                sink.add_file(rel_path, file)
+
+            result = render_file(env, file)
+            output_file = output_path / rel_path
+            generated.add(rel_path)
+            with profiling.span("write"):
+                if patch and output_file.is_file() and output_file.read_text(encoding="utf-8") == result:
+                    continue
+
+                output_file.parent.mkdir(parents=True, exist_ok=True)
+                with output_file.open("w", encoding="utf-8") as f:
+                    f.write(result)
+
+        pbar.set_description_str(f"Generating file: {rel_path}")
+
+    return generated
+
+
+@click.group(cls=DefaultGroup, default="extract")
+def main():
+    """Generate C++ headers from DWARF Debugging Information Format."""
+
+
+@main.command()
 @click.argument("path", type=click.Path(exists=True, path_type=Path))
 @click.option("--base-dir", type=str, required=True, help="Base directory used during compilation.")
 @click.option(
@@ -24,27 +103,363 @@ logger = logging.getLogger("dwarf2cpp")
     default=None,
     help="Output directory for generated files. Defaults to 'out' inside the input file's directory.",
 )
-def main(path: Path, base_dir: str, output_path: Path | None):
+@click.option(
+    "--cache-dir",
+    type=click.Path(file_okay=False, path_type=Path),
+    default=None,
+    help="Directory for caching extracted units and type units across runs. Unchanged units are loaded from it.",
+)
+@click.option(
+    "--since",
+    type=click.Path(exists=True, dir_okay=False, path_type=Path),
+    default=None,
+    help="Previous version of the binary. Only the files affected by the compile units that changed since then are "
+    "regenerated in the existing output directory.",
+)
+@click.option(
+    "--emit-ir",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the merged models to an intermediate representation file, which can be rendered again with "
+    "the render command.",
+)
+@click.option(
+    "--index",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write every generated declaration to an SQLite database for lookups by name or linkage name.",
+)
+@click.option(
+    "--layout-report",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the memory layout of every struct, class and union with its holes, padding and members "
+    "straddling cache lines. Written as JSON if the path ends with .json.",
+)
+@click.option(
+    "--cache-line-size",
+    type=click.IntRange(min=1),
+    default=CACHE_LINE_SIZE,
+    show_default=True,
+    help="Cache line size in bytes used by the layout report.",
+)
+@click.option(
+    "--reflection-header",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write a C++ header with a constexpr perfect hash table of the offset, size and type of every data "
+    "member, keyed by qualified name.",
+)
+@click.option(
+    "--reflection-namespace",
+    type=str,
+    default="dwarf2cpp::reflection",
+    show_default=True,
+    help="C++ namespace of the reflection header.",
+)
+@click.option(
+    "--symbol-table",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the addresses of every function with a linkage name to a sorted binary table, along with a C++ "
+    "header with the same name ending with .h to look them up. The table cannot end with .h.",
+)
+@click.option(
+    "--vtable-slots",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the vtable slot of every virtual function of every class to a binary table, along with a C++ "
+    "header with the same name ending with .h holding the same slots as constexpr data. The table cannot end with .h.",
+)
+@click.option(
+    "--timings",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the time spent in each phase of the extraction to a JSON file.",
+)
+@click.option(
+    "--memory-report",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also write the peak memory, the Python heap, the number of live models and the DIEs and line tables held "
+    "by LLVM at each phase boundary of the extraction to a JSON file.",
+)
+@click.option(
+    "--trace",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Also record the spans of the extraction, including those of the native code, in Chrome trace event format "
+    "to open in Perfetto.",
+)
+@click.option(
+    "--resume",
+    is_flag=True,
+    help="Resume from the last checkpoint of an interrupted run with the same arguments.",
+)
+@click.option(
+    "--checkpoint-interval",
+    type=click.IntRange(min=0),
+    default=900,
+    show_default=True,
+    help="Seconds between checkpoints written to the output directory. Use 0 to disable checkpoints.",
+)
+def extract(
+    path: Path,
+    base_dir: str,
+    output_path: Path | None,
+    cache_dir: Path | None,
+    since: Path | None,
+    emit_ir: Path | None,
+    index: Path | None,
+    layout_report: Path | None,
+    cache_line_size: int,
+    reflection_header: Path | None,
+    reflection_namespace: str,
+    symbol_table: Path | None,
+    vtable_slots: Path | None,
+    timings: Path | None,
+    memory_report: Path | None,
+    trace: Path | None,
+    resume: bool,
+    checkpoint_interval: int,
+):
+    """Extract the headers from a binary. This is the default command."""
     output_path = output_path or (path.parent / "out")
+    whole_outputs = emit_ir or index or layout_report or reflection_header or symbol_table or vtable_slots
+    if resume and (since or whole_outputs):
+        raise click.UsageError(
+            "--resume cannot be combined with --since, --emit-ir, --index, --layout-report, --reflection-header, "
+            "--symbol-table or --vtable-slots, which need every file."
+        )
+    if since and whole_outputs:
+        raise click.UsageError(
+            "--since cannot be combined with --emit-ir, --index, --layout-report, --reflection-header, "
+            "--symbol-table or --vtable-slots, which would only cover the files affected by the changes."
+        )
+    for option, table in (("--symbol-table", symbol_table), ("--vtable-slots", vtable_slots)):
+        if table and table.suffix == ".h":
+            raise click.UsageError(
+                f"{option} cannot end with .h, the header written next to the table would overwrite it."
+            )
+
+    profiler = profiling.enable() if timings else None
+    report = profiling.enable_memory_report(memory_report) if memory_report else None
+    tracer = profiling.enable_trace(trace) if trace else None
+    profiling.boundary("start")
+
+    logger.info(f'Creating DWARF context for "{path.absolute()}"')
+    with profiling.span("context", path=str(path)):
+        ctx = DWARFContext(str(path))
+    if report:
+        report.context = ctx
+    profiling.boundary("context")
+
+    selection = None
+    if since:
+        logger.info(f'Creating DWARF context for "{since.absolute()}"')
+        since_ctx = DWARFContext(str(since))
+        selection = find_changed_files(since_ctx, ctx, base_dir)
+        # release the sections and the units of the previous binary before the extraction
+        del since_ctx
+
+    cache = UnitCache(cache_dir / "units", base_dir) if cache_dir else None
+    type_cache = TypeCache(cache_dir / "types") if cache_dir else None
+    journal = None
+    if checkpoint_interval or resume:
+        identity = run_identity(path, base_dir, selection)
+        journal = CheckpointJournal(output_path / CHECKPOINT_NAME, identity, checkpoint_interval)
+
+    visitor = Visitor(ctx, base_dir, cache=cache, type_cache=type_cache, selection=selection, journal=journal)
+    if resume:
+        try:
+            checkpoint = journal.load()
+        except ValueError as e:
+            raise click.ClickException(str(e))
+
+        if checkpoint:
+            logger.info(f"Resuming after {checkpoint.next_unit} compile units from {journal.path}")
+            visitor.restore(checkpoint)
+        else:
+            logger.warning(f"No checkpoint found in {output_path}, starting from the beginning")
+
+    with contextlib.ExitStack() as stack:
+        sinks = []
+        if emit_ir:
+            sinks.append(stack.enter_context(IRWriter(emit_ir)))
+        if index:
+            sinks.append(stack.enter_context(DeclarationIndex(index)))
+        if layout_report:
+            sinks.append(stack.enter_context(LayoutReport(layout_report, cache_line_size)))
+        if reflection_header:
+            sinks.append(stack.enter_context(ReflectionHeader(reflection_header, reflection_namespace)))
+        if symbol_table:
+            sinks.append(stack.enter_context(SymbolAddressTable(symbol_table, ctx.function_symbols())))
+        if vtable_slots:
+            sinks.append(stack.enter_context(VTableSlots(vtable_slots)))
+
+        generated = write_files(visitor.files, output_path, sinks=sinks, patch=since is not None)
+
+    if since:
+        # files that were affected by the changes but are no longer generated
+        for file in selection:
+            rel_path = posixpath.relpath(file, base_dir)
+            if rel_path not in generated and not rel_path.startswith("../"):
+                (output_path / rel_path).unlink(missing_ok=True)
+
+    profiling.boundary("done")
+    if profiler:
+        profiler.write(timings)
+    if tracer:
+        tracer.write()
+    profiling.disable()
+
+    logger.info(f"Done! Files generated in: {output_path.absolute()}")
+
+
+@main.command("diff")
+@click.argument("old", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.argument("new", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.option("--base-dir", type=str, required=True, help="Base directory used during compilation.")
+@click.option("--json", "as_json", is_flag=True, help="Print the changes as JSON.")
+def diff_command(old: Path, new: Path, base_dir: str, as_json: bool):
+    """Report the structs, functions and enums whose layout or signature changed between two binaries."""
+    changes = diff(old, new, base_dir)
+    if as_json:
+        click.echo(json.dumps([change.__dict__ for change in changes], indent=2))
+    else:
+        click.echo(format_changes(changes))
+
+    logger.info(f"{len(changes)} entities changed")
+
+
+@main.command("build-index")
+@click.argument("path", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.option(
+    "--output-path",
+    "-o",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Output file. Defaults to the path of the binary with a '.dieidx' suffix appended.",
+)
+def build_index(path: Path, output_path: Path | None):
+    """Write a memory-mappable index of every DIE next to a binary, which can be reopened with DWARFIndex."""
+    output_path = output_path or path.with_name(path.name + ".dieidx")
 
     logger.info(f'Creating DWARF context for "{path.absolute()}"')
     ctx = DWARFContext(str(path))
-    visitor = Visitor(ctx, base_dir)
-
-    template_dir = Path(__file__).parent / "templates"
-    env = Environment(loader=FileSystemLoader(template_dir), keep_trailing_newline=True)
-    env.filters["ns_chain"] = do_ns_chain
-    env.filters["ns_actions"] = do_ns_actions
-    env.filters["insert_name"] = do_insert_name
-
-    for rel_path, file in (pbar := tqdm(visitor.files)):
-        result = env.get_template("file.jinja").render(file=file)
-        result = cleanup(result)
-        output_file = output_path / rel_path
-        output_file.parent.mkdir(parents=True, exist_ok=True)
-        with output_file.open("w", encoding="utf-8") as f:
-            f.write(result)
+    ctx.write_index(str(output_path))
+    logger.info(f"Done! Index written to: {output_path.absolute()}")
+
+
+@main.command()
+@click.argument("path", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.option(
+    "--socket",
+    "socket_path",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="Unix socket to listen on. Defaults to reading requests from stdin and writing responses to stdout.",
+)
+@click.option(
+    "--index-file",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="DIE index of the binary, built if it is missing or stale. Defaults to the path of the binary with a "
+    "'.dieidx' suffix appended.",
+)
+@click.option("--workers", type=click.IntRange(min=1), default=4, show_default=True, help="Number of worker threads.")
+def serve(path: Path, socket_path: Path | None, index_file: Path | None, workers: int):
+    """Answer JSON-RPC queries about the declarations of a binary, keeping it open between queries."""
+    logger.info(f'Creating DWARF context for "{path.absolute()}"')
+    ctx = DWARFContext(str(path))
+    server = Server(QueryEngine(ctx, open_index(ctx, path, index_file)), workers=workers)
+    if socket_path:
+        asyncio.run(server.serve_unix(socket_path))
+    else:
+        asyncio.run(server.serve_stdio())
 
-        pbar.set_description_str(f"Generating file: {rel_path}")
 
+@main.command()
+@click.argument("path", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.option(
+    "--output-path",
+    "-o",
+    type=click.Path(path_type=Path),
+    default=None,
+    help="Output directory for generated files. Defaults to 'out' inside the input file's directory.",
+)
+def render(path: Path, output_path: Path | None):
+    """Render the headers from an intermediate representation file written by extract --emit-ir."""
+    output_path = output_path or (path.parent / "out")
+    try:
+        write_files(read_ir(path), output_path)
+    except ValueError as e:
+        raise click.ClickException(str(e))
     logger.info(f"Done! Files generated in: {output_path.absolute()}")
+
+
+@main.command("subset")
+@click.argument("path", type=click.Path(exists=True, dir_okay=False, path_type=Path))
+@click.option(
+    "--output-path", "-o", type=click.Path(dir_okay=False, path_type=Path), required=True, help="ELF file to write."
+)
+@click.option(
+    "--compile-units", type=click.IntRange(min=1), default=None, help="Keep the first N compile units of the binary."
+)
+@click.option(
+    "--type",
+    "types",
+    multiple=True,
+    help="Keep the units defining the type with this qualified name. May be given several times.",
+)
+@click.option(
+    "--index-file",
+    type=click.Path(dir_okay=False, path_type=Path),
+    default=None,
+    help="DIE index used to find the types, built if it is missing or stale. Defaults to the path of the binary with "
+    "a '.dieidx' suffix appended.",
+)
+@click.option("--scramble", is_flag=True, help="Replace the identifiers in names and paths by random ones.")
+@click.option("--seed", type=int, default=0, show_default=True, help="Seed of the scrambled identifiers.")
+@click.option(
+    "--base-dir",
+    type=str,
+    default=None,
+    help="Base directory used during compilation, printed as scrambled with --scramble to extract the subset.",
+)
+def subset_command(
+    path: Path,
+    output_path: Path,
+    compile_units: int | None,
+    types: tuple[str, ...],
+    index_file: Path | None,
+    scramble: bool,
+    seed: int,
+    base_dir: str | None,
+):
+    """
+    Write a small ELF file holding only some units of the DWARF of a binary, and the units they reference, to share a
+    reproducible case without the binary.
+    """
+    if compile_units is None and not types:
+        raise click.UsageError("Select the units to keep with --compile-units or --type")
+
+    candidates = {}
+    if types:
+        logger.info(f'Creating DWARF context for "{path.absolute()}"')
+        index = open_index(DWARFContext(str(path)), path, index_file)
+        for name in types:
+            candidates[name] = [(entry.offset, entry.types_section) for entry in find_entries(index, name)]
+
+    scrambler = Scrambler(seed) if scramble else None
+    try:
+        result = subset(path, output_path, compile_units, candidates, scrambler)
+    except ValueError as e:
+        raise click.ClickException(str(e))
+
+    logger.info(
+        f"Kept {result.compile_units} compile units and {result.type_units} type units, {result.size} bytes written "
+        f"to: {output_path.absolute()}"
+    )
+    if base_dir is not None:
+        click.echo(scrambler.path(base_dir) if scrambler else base_dir)
@@ -0,0 +1,55 @@
+import logging
+import posixpath
+
+from tqdm import tqdm
+
+from ._dwarf import DWARFContext
+
+logger = logging.getLogger("dwarf2cpp")
+
+
+def _unit_files(context: DWARFContext, base_dir: str, desc: str) -> dict[str, set[str]]:
+    """Map the fingerprint of each compile unit under the base directory to the files its line table references."""
+    units: dict[str, set[str]] = {}
+    for cu in tqdm(
+        context.compile_units,
+        desc=desc,
+        total=context.num_compile_units,
+        bar_format="[{n_fmt}/{total_fmt}] {desc} [{elapsed}, {rate_fmt}]",
+    ):
+        if not cu.compilation_dir.replace("\\", "/").startswith(base_dir):
+            continue
+
+        files = units.setdefault(cu.fingerprint, set())
+        for path in cu.line_table_files:
+            path = posixpath.normpath(path.replace("\\", "/"))
+            if path.startswith(base_dir):
+                files.add(path)
+
+    return units
+
+
+def find_changed_files(old: DWARFContext, new: DWARFContext, base_dir: str) -> set[str]:
+    """Find the files whose contents may differ between two binaries.
+
+    Compile units are matched by fingerprint. A file is considered changed if it is referenced by a unit that only
+    exists in one of the binaries, i.e. a unit that was added, removed or modified.
+
+    Returns:
+        Set of absolute file paths under the base directory
+    """
+    old_units = _unit_files(old, base_dir, "Fingerprinting old compile units")
+    new_units = _unit_files(new, base_dir, "Fingerprinting new compile units")
+
+    changed: set[str] = set()
+    num_changed = 0
+    for units, others in ((new_units, old_units), (old_units, new_units)):
+        for fingerprint, files in units.items():
+            if fingerprint not in others:
+                num_changed += 1
+                changed.update(files)
+
+    logger.info(
+        f"{num_changed} of {len(old_units) + len(new_units)} compile units differ, {len(changed)} files may change"
+    )
+    return changed
@@ -0,0 +1,349 @@
+#include "die_index.h"
+
+#include "dwarf_utils.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/DJB.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace dwarf2cpp {
+namespace {
+uint64_t AlignTo8(uint64_t offset) { return (offset + 7) & ~uint64_t{7}; }
+
+llvm::sys::fs::file_status BinaryStatus(const std::string &binary_path) {
+    llvm::sys::fs::file_status status;
+    if (auto ec = llvm::sys::fs::status(binary_path, status)) {
+        throw std::runtime_error(binary_path + ": " + ec.message());
+    }
+    return status;
+}
+
+uint64_t ModificationTime(const llvm::sys::fs::file_status &status) {
+    return status.getLastModificationTime().time_since_epoch().count();
+}
+
+class IndexBuilder {
+public:
+    void addUnit(llvm::DWARFUnit &unit, bool types_section) {
+        // entry index of each DIE of the unit, by its index in the unit
+        std::vector<uint32_t> positions(unit.getNumDIEs(), kDieIndexNone);
+        for (const auto &debug_info_entry : unit.dies()) {
+            llvm::DWARFDie die(&unit, &debug_info_entry);
+            if (die.isNULL()) {
+                continue;
+            }
+
+            if (entries_.size() >= kDieIndexNone) {
+                throw std::runtime_error("Too many DIEs for a DIE index");
+            }
+
+            DieIndexEntry entry{};
+            entry.offset = die.getOffset();
+            entry.parent = kDieIndexNone;
+            if (auto parent = die.getParent(); parent.isValid()) {
+                entry.parent = positions[unit.getDIEIndex(parent)];
+            }
+            entry.name = intern(
+                llvm::dwarf::toStringRef(findRecursively(die, llvm::dwarf::DW_AT_name)));
+            entry.decl_file = declFile(die);
+            entry.decl_line = static_cast<uint32_t>(
+                llvm::dwarf::toUnsigned(findRecursively(die, llvm::dwarf::DW_AT_decl_line), 0));
+            entry.tag = die.getTag();
+            entry.types_section = types_section;
+
+            positions[unit.getDIEIndex(die)] = static_cast<uint32_t>(entries_.size());
+            entries_.push_back(entry);
+        }
+    }
+
+    void write(const std::string &path, const llvm::sys::fs::file_status &binary_status) {
+        // entries are in depth-first order, so every descendant of an entry comes after it
+        for (auto i = static_cast<uint32_t>(entries_.size()); i-- > 0;) {
+            auto &entry = entries_[i];
+            entry.subtree_end = std::max(entry.subtree_end, i + 1);
+            if (entry.parent != kDieIndexNone) {
+                auto &parent = entries_[entry.parent];
+                parent.subtree_end = std::max(parent.subtree_end, entry.subtree_end);
+            }
+        }
+
+        // group the named entries by the bucket of their name hash
+        std::vector<std::pair<uint32_t, uint32_t>> named;
+        for (uint32_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].name != 0) {
+                named.emplace_back(llvm::djbHash(string(entries_[i].name)), i);
+            }
+        }
+        const auto num_buckets = std::max<uint32_t>(1, named.size() / 2);
+        std::vector<uint32_t> buckets(num_buckets + 1, 0);
+        for (const auto &[hash, i] : named) {
+            ++buckets[hash % num_buckets + 1];
+        }
+        for (uint32_t b = 0; b < num_buckets; ++b) {
+            buckets[b + 1] += buckets[b];
+        }
+        std::vector<uint32_t> hashes(named.size());
+        std::vector<uint32_t> names(named.size());
+        std::vector<uint32_t> cursors(buckets.begin(), buckets.end() - 1);
+        for (const auto &[hash, i] : named) {
+            auto k = cursors[hash % num_buckets]++;
+            hashes[k] = hash;
+            names[k] = i;
+        }
+
+        DieIndexHeader header{};
+        std::memcpy(header.magic, kDieIndexMagic, sizeof(header.magic));
+        header.version = kDieIndexVersion;
+        header.num_buckets = num_buckets;
+        header.binary_size = binary_status.getSize();
+        header.binary_mtime = ModificationTime(binary_status);
+        header.num_entries = entries_.size();
+        header.num_names = named.size();
+        header.num_files = files_.size();
+        header.strings_size = strings_.size();
+        header.entries_offset = AlignTo8(sizeof(DieIndexHeader));
+        header.buckets_offset
+            = AlignTo8(header.entries_offset + entries_.size() * sizeof(DieIndexEntry));
+        header.hashes_offset = AlignTo8(header.buckets_offset + buckets.size() * sizeof(uint32_t));
+        header.names_offset = AlignTo8(header.hashes_offset + hashes.size() * sizeof(uint32_t));
+        header.files_offset = AlignTo8(header.names_offset + names.size() * sizeof(uint32_t));
+        header.strings_offset = AlignTo8(header.files_offset + files_.size() * sizeof(uint32_t));
+
+        // write to a temporary file first so that readers never map a partially written index
+        const auto tmp_path = path + ".tmp";
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream os(tmp_path, ec, llvm::sys::fs::OF_None);
+            if (ec) {
+                throw std::runtime_error(tmp_path + ": " + ec.message());
+            }
+
+            auto write_at = [&os](uint64_t offset, const void *data, size_t size) {
+                os.write_zeros(offset - os.tell());
+                os.write(static_cast<const char *>(data), size);
+            };
+            write_at(0, &header, sizeof(header));
+            write_at(header.entries_offset,
+                     entries_.data(),
+                     entries_.size() * sizeof(DieIndexEntry));
+            write_at(header.buckets_offset, buckets.data(), buckets.size() * sizeof(uint32_t));
+            write_at(header.hashes_offset, hashes.data(), hashes.size() * sizeof(uint32_t));
+            write_at(header.names_offset, names.data(), names.size() * sizeof(uint32_t));
+            write_at(header.files_offset, files_.data(), files_.size() * sizeof(uint32_t));
+            write_at(header.strings_offset, strings_.data(), strings_.size());
+
+            os.close();
+            if (os.has_error()) {
+                auto message = os.error().message();
+                os.clear_error();
+                llvm::sys::fs::remove(tmp_path);
+                throw std::runtime_error(tmp_path + ": " + message);
+            }
+        }
+
+        if (auto ec = llvm::sys::fs::rename(tmp_path, path)) {
+            llvm::sys::fs::remove(tmp_path);
+            throw std::runtime_error(path + ": " + ec.message());
+        }
+    }
+
+private:
+    uint32_t intern(llvm::StringRef str) {
+        if (str.empty()) {
+            return 0;
+        }
+
+        auto [it, inserted] = string_offsets_.try_emplace(str, strings_.size());
+        if (inserted) {
+            if (strings_.size() + str.size() + 1 > UINT32_MAX) {
+                throw std::runtime_error("Too many strings for a DIE index");
+            }
+            strings_.append(str.data(), str.size());
+            strings_.push_back('\0');
+        }
+        return it->second;
+    }
+
+    llvm::StringRef string(uint32_t offset) const { return strings_.c_str() + offset; }
+
+    uint32_t declFile(const llvm::DWARFDie &die) {
+        auto form = findRecursively(die, llvm::dwarf::DW_AT_decl_file);
+        if (!form) {
+            return kDieIndexNone;
+        }
+
+        auto file_index = form->getAsUnsignedConstant();
+        if (!file_index) {
+            return kDieIndexNone;
+        }
+
+        // file indices are local to the line table of the unit that holds the attribute, values
+        // of DW_FORM_implicit_const have no unit, so assume they come from the same unit
+        const auto *unit = form->getUnit() ? form->getUnit() : die.getDwarfUnit();
+        auto key = std::make_pair(unit, *file_index);
+        if (auto it = unit_files_.find(key); it != unit_files_.end()) {
+            return it->second;
+        }
+
+        auto result = kDieIndexNone;
+        auto *mutable_unit = const_cast<llvm::DWARFUnit *>(unit);
+        std::string file;
+        if (const auto *line_table = LineTableForUnit(*mutable_unit);
+            line_table
+            && line_table->getFileNameByIndex(
+                *file_index,
+                mutable_unit->getCompilationDir(),
+                llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+                file)) {
+            auto offset = intern(file);
+            auto [it, inserted]
+                = files_by_string_.try_emplace(offset, static_cast<uint32_t>(files_.size()));
+            if (inserted) {
+                files_.push_back(offset);
+            }
+            result = it->second;
+        }
+        unit_files_[key] = result;
+        return result;
+    }
+
+    std::vector<DieIndexEntry> entries_;
+    std::string strings_ = std::string(1, '\0');
+    llvm::StringMap<uint32_t> string_offsets_;
+    std::vector<uint32_t> files_;
+    llvm::DenseMap<uint32_t, uint32_t> files_by_string_;
+    llvm::DenseMap<std::pair<const llvm::DWARFUnit *, uint64_t>, uint32_t> unit_files_;
+};
+
+template <typename T>
+llvm::ArrayRef<T> Section(const std::string &path,
+                          const llvm::MemoryBuffer &buffer,
+                          uint64_t offset,
+                          uint64_t count) {
+    if (offset % alignof(T) != 0 || offset > buffer.getBufferSize()
+        || count > (buffer.getBufferSize() - offset) / sizeof(T)) {
+        throw std::runtime_error(path + " is truncated or corrupted");
+    }
+    return {reinterpret_cast<const T *>(buffer.getBufferStart() + offset),
+            static_cast<size_t>(count)};
+}
+} // namespace
+
+void DieIndex::write(llvm::DWARFContext &context,
+                     const std::string &binary_path,
+                     const std::string &path) {
+    auto binary_status = BinaryStatus(binary_path);
+
+    IndexBuilder builder;
+    for (const auto &unit : context.info_section_units()) {
+        builder.addUnit(*unit, false);
+    }
+    for (const auto &unit : context.types_section_units()) {
+        builder.addUnit(*unit, true);
+    }
+    builder.write(path, binary_status);
+}
+
+std::unique_ptr<DieIndex> DieIndex::open(const std::string &path) {
+    // large files are memory-mapped rather than read
+    auto buffer = llvm::MemoryBuffer::getFile(path,
+                                              /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        throw std::runtime_error(path + ": " + buffer.getError().message());
+    }
+    return std::unique_ptr<DieIndex>(new DieIndex(path, std::move(*buffer)));
+}
+
+DieIndex::DieIndex(const std::string &path, std::unique_ptr<llvm::MemoryBuffer> buffer)
+    : buffer_(std::move(buffer)) {
+    header_ = Section<DieIndexHeader>(path, *buffer_, 0, 1).data();
+    if (std::memcmp(header_->magic, kDieIndexMagic, sizeof(kDieIndexMagic)) != 0) {
+        throw std::runtime_error(path + " is not a DIE index");
+    }
+    if (header_->version != kDieIndexVersion) {
+        throw std::runtime_error("Unsupported DIE index version "
+                                 + std::to_string(header_->version) + " in " + path
+                                 + ", expected " + std::to_string(kDieIndexVersion));
+    }
+
+    entries_ = Section<DieIndexEntry>(
+        path, *buffer_, header_->entries_offset, header_->num_entries);
+    buckets_ = Section<uint32_t>(
+        path, *buffer_, header_->buckets_offset, uint64_t{header_->num_buckets} + 1);
+    hashes_ = Section<uint32_t>(path, *buffer_, header_->hashes_offset, header_->num_names);
+    names_ = Section<uint32_t>(path, *buffer_, header_->names_offset, header_->num_names);
+    files_ = Section<uint32_t>(path, *buffer_, header_->files_offset, header_->num_files);
+    auto strings
+        = Section<char>(path, *buffer_, header_->strings_offset, header_->strings_size);
+    strings_ = llvm::StringRef(strings.data(), strings.size());
+
+    if (header_->num_buckets == 0 || buckets_.back() != header_->num_names || strings_.empty()
+        || strings_.back() != '\0') {
+        throw std::runtime_error(path + " is truncated or corrupted");
+    }
+}
+
+bool DieIndex::matches(const std::string &binary_path) const {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(binary_path, status)) {
+        return false;
+    }
+    return status.getSize() == header_->binary_size
+           && ModificationTime(status) == header_->binary_mtime;
+}
+
+llvm::StringRef DieIndex::string(uint32_t offset) const {
+    if (offset >= strings_.size()) {
+        return {};
+    }
+    // strings are NUL-terminated and the table always ends with a NUL
+    return strings_.data() + offset;
+}
+
+llvm::StringRef DieIndex::name(uint32_t i) const { return string(entries_[i].name); }
+
+std::optional<llvm::StringRef> DieIndex::declFile(uint32_t i) const {
+    auto file = entries_[i].decl_file;
+    if (file >= files_.size()) {
+        return std::nullopt;
+    }
+    return string(files_[file]);
+}
+
+std::vector<uint32_t> DieIndex::lookup(llvm::StringRef name) const {
+    std::vector<uint32_t> result;
+    auto hash = llvm::djbHash(name);
+    auto bucket = hash % header_->num_buckets;
+    for (auto k = buckets_[bucket]; k < buckets_[bucket + 1] && k < names_.size(); ++k) {
+        if (hashes_[k] == hash && names_[k] < size() && this->name(names_[k]) == name) {
+            result.push_back(names_[k]);
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> DieIndex::roots() const {
+    std::vector<uint32_t> result;
+    for (uint32_t i = 0; i < size(); i = std::max(entries_[i].subtree_end, i + 1)) {
+        result.push_back(i);
+    }
+    return result;
+}
+
+std::vector<uint32_t> DieIndex::children(uint32_t i) const {
+    std::vector<uint32_t> result;
+    auto end = std::min(entries_[i].subtree_end, size());
+    for (auto j = i + 1; j < end; j = std::max(entries_[j].subtree_end, j + 1)) {
+        result.push_back(j);
+    }
+    return result;
+}
+
+} // namespace dwarf2cpp
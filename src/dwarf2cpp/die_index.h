@@ -0,0 +1,121 @@
+#ifndef DWARF2CPP_DIE_INDEX_H
+#define DWARF2CPP_DIE_INDEX_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dwarf2cpp {
+
+// A sidecar file describing every DIE of a binary in flat, fixed-size records, so that it can be
+// memory-mapped and queried without extracting the DIEs again. The layout is:
+//
+//   DieIndexHeader
+//   DieIndexEntry[num_entries]   DIEs in depth-first order, unit by unit
+//   uint32_t[num_buckets + 1]    start of each name hash bucket in the two arrays below
+//   uint32_t[num_names]          hash of the name of each entry, grouped by bucket
+//   uint32_t[num_names]          entry index, grouped by bucket
+//   uint32_t[num_files]          string offset of each declaration file
+//   char[strings_size]           NUL-terminated strings, starting with the empty string
+//
+// All sections are aligned to 8 bytes and stored in the byte order of the host.
+
+inline constexpr char kDieIndexMagic[8] = {'D', '2', 'C', 'D', 'I', 'E', 'X', '\0'};
+inline constexpr uint32_t kDieIndexVersion = 1;
+inline constexpr uint32_t kDieIndexNone = UINT32_MAX;
+
+struct DieIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_buckets;
+    // identity of the binary the index was built from
+    uint64_t binary_size;
+    uint64_t binary_mtime;
+    uint64_t num_entries;
+    uint64_t num_names;
+    uint64_t num_files;
+    uint64_t strings_size;
+    uint64_t entries_offset;
+    uint64_t buckets_offset;
+    uint64_t hashes_offset;
+    uint64_t names_offset;
+    uint64_t files_offset;
+    uint64_t strings_offset;
+};
+
+struct DieIndexEntry {
+    // offset of the DIE in its section
+    uint64_t offset;
+    // entry index of the parent, kDieIndexNone for unit DIEs
+    uint32_t parent;
+    // entry index one past the last descendant
+    uint32_t subtree_end;
+    // string offset of DW_AT_name, 0 if the DIE has no name
+    uint32_t name;
+    // index into the file table, kDieIndexNone if the DIE has no DW_AT_decl_file
+    uint32_t decl_file;
+    uint32_t decl_line;
+    uint16_t tag;
+    // whether the DIE is in the .debug_types section rather than .debug_info
+    uint8_t types_section;
+    uint8_t padding;
+};
+
+static_assert(sizeof(DieIndexHeader) == 112);
+static_assert(sizeof(DieIndexEntry) == 32);
+
+class DieIndex {
+public:
+    // Build the index of every unit in the context and write it to path.
+    static void write(llvm::DWARFContext &context,
+                      const std::string &binary_path,
+                      const std::string &path);
+
+    // Memory-map an index file written by write.
+    static std::unique_ptr<DieIndex> open(const std::string &path);
+
+    // Whether the index was built from the binary at the given path, as it is now.
+    [[nodiscard]] bool matches(const std::string &binary_path) const;
+
+    [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(entries_.size()); }
+
+    [[nodiscard]] const DieIndexEntry &operator[](uint32_t i) const { return entries_[i]; }
+
+    [[nodiscard]] llvm::StringRef name(uint32_t i) const;
+
+    [[nodiscard]] std::optional<llvm::StringRef> declFile(uint32_t i) const;
+
+    // Entry indices of the DIEs named exactly name.
+    [[nodiscard]] std::vector<uint32_t> lookup(llvm::StringRef name) const;
+
+    // Entry indices of the unit DIEs.
+    [[nodiscard]] std::vector<uint32_t> roots() const;
+
+    // Entry indices of the direct children of an entry.
+    [[nodiscard]] std::vector<uint32_t> children(uint32_t i) const;
+
+private:
+    DieIndex(const std::string &path, std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+    [[nodiscard]] llvm::StringRef string(uint32_t offset) const;
+
+    std::unique_ptr<llvm::MemoryBuffer> buffer_;
+    const DieIndexHeader *header_;
+    llvm::ArrayRef<DieIndexEntry> entries_;
+    llvm::ArrayRef<uint32_t> buckets_;
+    llvm::ArrayRef<uint32_t> hashes_;
+    llvm::ArrayRef<uint32_t> names_;
+    llvm::ArrayRef<uint32_t> files_;
+    llvm::StringRef strings_;
+};
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_DIE_INDEX_H
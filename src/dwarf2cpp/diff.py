@@ -0,0 +1,207 @@
+import hashlib
+import json
+import logging
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any
+
+from ._dwarf import DWARFContext
+from .models import Attribute, Enum, Function, Object, Struct, TypeDef, function_signature, type_name
+from .visitor import Visitor
+from .vtables import VTableResolver, VTableSlot
+
+logger = logging.getLogger("dwarf2cpp")
+
+
+@dataclass
+class Entity:
+    """Structural summary of an extracted struct, function or enum."""
+
+    kind: str
+    name: str
+    fields: dict[str, Any]
+    hash: str = field(init=False)
+
+    def __post_init__(self):
+        data = json.dumps(self.fields, sort_keys=True, separators=(",", ":"))
+        self.hash = hashlib.blake2b(data.encode(), digest_size=16).hexdigest()
+
+
+@dataclass
+class Change:
+    key: str
+    status: str  # "added", "removed" or "changed"
+    fields: dict[str, tuple[Any, Any]] = field(default_factory=dict)
+
+
+def _summarize_function(function: Function) -> Entity:
+    return Entity(
+        kind=function.kind,
+        name=function.qualified_name + function_signature(function),
+        fields={
+            "returns": function.returns,
+            "is_static": function.is_static,
+            "virtuality": function.virtuality.name if function.virtuality else None,
+            "access": function.access.name if function.access else None,
+        },
+    )
+
+
+def _format_slot(slot: VTableSlot) -> str:
+    # the offset of the vtable pointer is only shown for the vtables of secondary bases
+    index = f"{slot.offset}:{slot.index}" if slot.offset else str(slot.index)
+    return f"[{index}] {slot.function}"
+
+
+def _summarize_struct(struct: Struct) -> Entity:
+    members = []
+    static_members = []
+    # replaced by the slots of the vtables, including the inherited ones, once every class has been collected
+    virtual_functions = []
+    for _, objects in sorted(struct.members.items()):
+        for member in objects:
+            if isinstance(member, Attribute):
+                data = {
+                    "name": member.name,
+                    "type": type_name(member.type),
+                    "offset": member.offset,
+                    "bit_size": member.bit_size,
+                }
+                (static_members if member.is_static else members).append(data)
+            elif isinstance(member, Function) and member.virtuality:
+                virtual_functions.append(member.name + function_signature(member))
+
+    return Entity(
+        kind=struct.kind,
+        name=struct.qualified_name,
+        fields={
+            "byte_size": struct.byte_size,
+            "alignment": struct.alignment,
+            "bases": [base for base, _ in struct.bases],
+            "members": members,
+            "static_members": static_members,
+            "virtual_functions": virtual_functions,
+        },
+    )
+
+
+def _summarize_enum(enum: Enum) -> Entity:
+    return Entity(
+        kind=enum.kind,
+        name=enum.qualified_name,
+        fields={"base": enum.base, "is_class": enum.is_class, "values": [list(v) for v in enum.values]},
+    )
+
+
+def _collect(obj: Object, entities: dict[str, Entity]) -> None:
+    if isinstance(obj, TypeDef) and isinstance(obj.value, Object):
+        obj = obj.value
+
+    if obj.is_declaration:
+        return
+
+    if isinstance(obj, Struct):
+        entity = _summarize_struct(obj)
+        for objects in obj.members.values():
+            for member in objects:
+                _collect(member, entities)
+    elif isinstance(obj, Function):
+        entity = _summarize_function(obj)
+    elif isinstance(obj, Enum):
+        entity = _summarize_enum(obj)
+    else:
+        return
+
+    # the first definition wins, the same entity is usually extracted from many compile units
+    entities.setdefault(f"{entity.kind} {entity.name}", entity)
+
+
+def summarize(path: Path, base_dir: str) -> dict[str, Entity]:
+    """
+    Extract a binary and summarize every struct, function and enum by its qualified name.
+
+    The virtual functions of a struct are listed in the order of the slots of its vtables, including the slots it
+    inherits, when the slots are known.
+    """
+    logger.info(f'Creating DWARF context for "{path.absolute()}"')
+    visitor = Visitor(DWARFContext(str(path)), base_dir)
+
+    entities: dict[str, Entity] = {}
+    resolver = VTableResolver()
+    for _, file in visitor.files:
+        resolver.add_file(file)
+        for objects in file.values():
+            for obj in objects:
+                _collect(obj, entities)
+
+    for key, entity in entities.items():
+        if "virtual_functions" in entity.fields and (slots := resolver.slots(entity.name)):
+            fields = {**entity.fields, "virtual_functions": [_format_slot(slot) for slot in slots]}
+            entities[key] = Entity(entity.kind, entity.name, fields)
+
+    return entities
+
+
+def _diff_fields(old: dict[str, Any], new: dict[str, Any]) -> dict[str, tuple[Any, Any]]:
+    result = {}
+    for key in old.keys() | new.keys():
+        if old.get(key) != new.get(key):
+            result[key] = (old.get(key), new.get(key))
+
+    return result
+
+
+def compare(old: dict[str, Entity], new: dict[str, Entity]) -> list[Change]:
+    """Join two summaries by key and report the entities that were added, removed or changed."""
+    changes = []
+    for key in sorted(old.keys() | new.keys()):
+        a, b = old.get(key), new.get(key)
+        if a is None:
+            changes.append(Change(key, "added"))
+        elif b is None:
+            changes.append(Change(key, "removed"))
+        elif a.hash != b.hash:
+            changes.append(Change(key, "changed", _diff_fields(a.fields, b.fields)))
+
+    return changes
+
+
+def diff(old_path: Path, new_path: Path, base_dir: str) -> list[Change]:
+    """Extract both binaries in parallel and compare them."""
+    with ProcessPoolExecutor(max_workers=2) as executor:
+        old = executor.submit(summarize, old_path, base_dir)
+        new = executor.submit(summarize, new_path, base_dir)
+        return compare(old.result(), new.result())
+
+
+def _format_members(old: list[dict], new: list[dict]) -> list[str]:
+    old_by_name = {m["name"]: m for m in old}
+    new_by_name = {m["name"]: m for m in new}
+    lines = []
+    for name in old_by_name.keys() - new_by_name.keys():
+        lines.append(f"    - {name}")
+    for name in new_by_name.keys() - old_by_name.keys():
+        m = new_by_name[name]
+        lines.append(f"    + {name}: {m['type']} @ {m['offset']}")
+    for name in old_by_name.keys() & new_by_name.keys():
+        a, b = old_by_name[name], new_by_name[name]
+        for k in ("type", "offset", "bit_size"):
+            if a[k] != b[k]:
+                lines.append(f"    ~ {name}.{k}: {a[k]} -> {b[k]}")
+
+    return sorted(lines, key=lambda line: line[6:])
+
+
+def format_changes(changes: list[Change]) -> str:
+    symbols = {"added": "+", "removed": "-", "changed": "~"}
+    lines = []
+    for change in changes:
+        lines.append(f"{symbols[change.status]} {change.key}")
+        for name, (old, new) in sorted(change.fields.items()):
+            if name in {"members", "static_members"}:
+                lines.extend(_format_members(old or [], new or []))
+            else:
+                lines.append(f"    ~ {name}: {old} -> {new}")
+
+    return "\n".join(lines)
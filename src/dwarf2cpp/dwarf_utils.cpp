@@ -0,0 +1,537 @@
+#include "dwarf_utils.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/DebugInfo/DWARF/DWARFDebugAbbrev.h>
+#include <llvm/DebugInfo/DWARF/DWARFTypeUnit.h>
+#include <llvm/Support/MD5.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace dwarf2cpp {
+std::string ToString(llvm::dwarf::Attribute attr) {
+    static const std::unordered_map<llvm::dwarf::Attribute, std::string> map = {
+#define HANDLE_DW_AT(ID, NAME, VERSION, VENDOR) {llvm::dwarf::DW_AT_##NAME, "DW_AT_" #NAME},
+#include "llvm/BinaryFormat/Dwarf.def"
+
+#undef HANDLE_DW_AT
+    };
+    return map.at(attr);
+}
+
+llvm::dwarf::Attribute ToAttribute(const std::string &key) {
+    static const std::unordered_map<std::string, llvm::dwarf::Attribute> map = {
+#define HANDLE_DW_AT(ID, NAME, VERSION, VENDOR) {"DW_AT_" #NAME, llvm::dwarf::DW_AT_##NAME},
+#include "llvm/BinaryFormat/Dwarf.def"
+
+#undef HANDLE_DW_AT
+    };
+    return map.at(key);
+}
+
+// POLYFILL BEGINS TODO: remove after updating to LLVM 20
+llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
+                                                const llvm::DWARFFormValue &V) {
+    llvm::DWARFDie Result;
+    if (std::optional<uint64_t> Offset = V.getAsRelativeReference()) {
+        Result = const_cast<llvm::DWARFUnit *>(V.getUnit())
+                     ->getDIEForOffset(V.getUnit()->getOffset() + *Offset);
+    } else if (Offset = V.getAsDebugInfoReference(); Offset) {
+        if (llvm::DWARFUnit *SpecUnit
+            = die.getDwarfUnit()->getUnitVector().getUnitForOffset(*Offset))
+            Result = SpecUnit->getDIEForOffset(*Offset);
+    } else if (std::optional<uint64_t> Sig = V.getAsSignatureReference()) {
+        if (llvm::DWARFTypeUnit *TU = die.getDwarfUnit()->getContext().getTypeUnitForHash(
+                die.getDwarfUnit()->getVersion(), *Sig, die.getDwarfUnit()->isDWOUnit()))
+            Result = TU->getDIEForOffset(TU->getTypeOffset() + TU->getOffset());
+    }
+    return Result;
+}
+
+llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
+                                                llvm::dwarf::Attribute Attr) {
+    if (std::optional<llvm::DWARFFormValue> F = die.find(Attr))
+        return getAttributeValueAsReferencedDie(die, *F);
+    return {};
+}
+
+std::optional<llvm::DWARFFormValue> findRecursively(const llvm::DWARFDie &die,
+                                                    llvm::ArrayRef<llvm::dwarf::Attribute> Attrs) {
+    // polyfill from LLVM 20
+    llvm::SmallVector<llvm::DWARFDie, 3> Worklist;
+    Worklist.push_back(die);
+    llvm::SmallSet<llvm::DWARFDie, 3> Seen;
+    Seen.insert(die);
+
+    while (!Worklist.empty()) {
+        llvm::DWARFDie Die = Worklist.pop_back_val();
+        if (!Die.isValid()) {
+            continue;
+        }
+        if (auto Value = Die.find(Attrs)) {
+            return Value;
+        }
+        for (llvm::dwarf::Attribute Attr : {llvm::dwarf::DW_AT_abstract_origin,
+                                            llvm::dwarf::DW_AT_specification,
+                                            llvm::dwarf::DW_AT_signature}) {
+            if (auto D = getAttributeValueAsReferencedDie(Die, Attr)) {
+                if (Seen.insert(D).second) {
+                    Worklist.push_back(D);
+                }
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+// POLYFILL ENDS TODO: remove after updating to LLVM 20
+
+namespace {
+    // The line tables returned by LineTableForUnit, by context.
+    struct ParsedLineTables {
+        std::mutex mutex;
+        llvm::DenseMap<const llvm::DWARFContext *,
+                       llvm::SmallPtrSet<const llvm::DWARFDebugLine::LineTable *, 16>>
+            tables;
+    };
+
+    ParsedLineTables &parsedLineTables() {
+        static ParsedLineTables parsed;
+        return parsed;
+    }
+
+    // Attributes that depend on the layout of the sections rather than on the declarations. Cached
+    // units must not keep anything read from them, e.g., the visitor reads addresses again.
+    bool isLayoutAttribute(llvm::dwarf::Attribute attr) {
+        switch (attr) {
+            case llvm::dwarf::DW_AT_low_pc:
+            case llvm::dwarf::DW_AT_high_pc:
+            case llvm::dwarf::DW_AT_entry_pc:
+            case llvm::dwarf::DW_AT_ranges:
+            case llvm::dwarf::DW_AT_stmt_list:
+            case llvm::dwarf::DW_AT_location:
+            case llvm::dwarf::DW_AT_frame_base:
+            case llvm::dwarf::DW_AT_call_return_pc:
+            case llvm::dwarf::DW_AT_call_pc:
+            case llvm::dwarf::DW_AT_call_value:
+            case llvm::dwarf::DW_AT_call_target:
+            case llvm::dwarf::DW_AT_GNU_call_site_value:
+            case llvm::dwarf::DW_AT_GNU_call_site_target:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Hashes the DIEs of a unit, along with the contents of the DIEs of other units they
+    // reference, whose offsets are not stable.
+    class Fingerprinter {
+    public:
+        explicit Fingerprinter(llvm::DWARFUnit &unit) : unit_(unit) {}
+
+        std::string fingerprint() {
+            update(unit_.getVersion());
+            update(unit_.getUnitType());
+            for (const auto &entry : unit_.dies()) {
+                llvm::DWARFDie die(&unit_, &entry);
+                update(die.getTag());
+                if (!die.isNULL()) {
+                    updateAttributes(die);
+                }
+            }
+
+            // DW_AT_decl_file values are indices into the file names of the line table
+            if (const auto *line_table = LineTableForUnit(unit_)) {
+                if (auto last = line_table->getLastValidFileIndex()) {
+                    for (uint64_t i = 0; i <= *last; ++i) {
+                        std::string file;
+                        line_table->getFileNameByIndex(
+                            i,
+                            unit_.getCompilationDir(),
+                            llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+                            file);
+                        updateString(file);
+                    }
+                }
+            }
+
+            // the DIEs of other units in the order they were first referenced, which can reference
+            // more of them
+            for (size_t i = 0; i < external_.size(); ++i) {
+                auto die = external_[i];
+                update(die.getTag());
+                updateAttributes(die);
+
+                // the children are part of the contents, e.g. the members of a struct, and the
+                // scopes of the names of the parents
+                uint64_t children = 0;
+                for (const auto &child : die.children()) {
+                    update(externalIndex(child));
+                    ++children;
+                }
+                update(children);
+                for (auto parent = die.getParent(); parent.isValid();
+                     parent = parent.getParent()) {
+                    update(parent.getTag());
+                    auto name = parent.find(llvm::dwarf::DW_AT_name);
+                    updateString(llvm::dwarf::toStringRef(name));
+                }
+            }
+
+            llvm::MD5::MD5Result result;
+            hash_.final(result);
+            return result.digest().str().str();
+        }
+
+    private:
+        void update(uint64_t value) {
+            hash_.update(
+                llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(&value), sizeof(value)));
+        }
+
+        void updateString(llvm::StringRef value) {
+            hash_.update(value);
+            update(value.size());
+        }
+
+        void updateAttributes(const llvm::DWARFDie &die) {
+            bool external = die.getDwarfUnit() != &unit_;
+            for (const auto &attr : die.attributes()) {
+                if (isLayoutAttribute(attr.Attr)) {
+                    continue;
+                }
+
+                update(attr.Attr);
+                const auto &value = attr.Value;
+                if (value.isFormClass(llvm::DWARFFormValue::FC_String)) {
+                    if (auto str = value.getAsCString()) {
+                        updateString(*str);
+                    } else {
+                        llvm::consumeError(str.takeError());
+                    }
+                } else if (value.isFormClass(llvm::DWARFFormValue::FC_Reference)) {
+                    updateReference(die, value);
+                } else if (external
+                           && (attr.Attr == llvm::dwarf::DW_AT_decl_file
+                               || attr.Attr == llvm::dwarf::DW_AT_call_file)) {
+                    // an index into the line table of the other unit
+                    auto file = value.getAsFile(
+                        llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath);
+                    updateString(file.value_or(""));
+                } else if (auto constant = value.getAsUnsignedConstant()) {
+                    update(*constant);
+                } else if (auto signed_constant = value.getAsSignedConstant()) {
+                    update(*signed_constant);
+                } else if (auto block = value.getAsBlock()) {
+                    hash_.update(*block);
+                }
+            }
+        }
+
+        void updateReference(const llvm::DWARFDie &die, const llvm::DWARFFormValue &value) {
+            if (auto sig = value.getAsSignatureReference()) {
+                // type signatures are derived from the contents of the type
+                update(*sig);
+                return;
+            }
+            if (die.getDwarfUnit() == &unit_) {
+                if (auto offset = value.getAsRelativeReference()) {
+                    update(*offset);
+                    return;
+                }
+            }
+            if (auto target = getAttributeValueAsReferencedDie(die, value)) {
+                if (target.getDwarfUnit() == &unit_) {
+                    update(target.getOffset() - unit_.getOffset());
+                } else {
+                    update(externalIndex(target));
+                }
+            }
+        }
+
+        // The index of a DIE of another unit, which is hashed once after the DIEs of the unit.
+        uint64_t externalIndex(const llvm::DWARFDie &die) {
+            auto [it, inserted] =
+                external_indices_.try_emplace(die.getDebugInfoEntry(), external_.size());
+            if (inserted) {
+                external_.push_back(die);
+            }
+            return it->second;
+        }
+
+        llvm::DWARFUnit &unit_;
+        llvm::MD5 hash_;
+        std::vector<llvm::DWARFDie> external_;
+        llvm::DenseMap<const llvm::DWARFDebugInfoEntry *, uint64_t> external_indices_;
+    };
+} // namespace
+
+std::string UnitFingerprint(llvm::DWARFUnit &unit) {
+    return Fingerprinter(unit).fingerprint();
+}
+
+llvm::DWARFDie DieForOffset(llvm::DWARFContext &context, uint64_t offset, bool types_section) {
+    if (!types_section) {
+        return context.getDIEForOffset(offset);
+    }
+
+    for (const auto &unit : context.types_section_units()) {
+        if (offset >= unit->getOffset() && offset < unit->getNextUnitOffset()) {
+            return unit->getDIEForOffset(offset);
+        }
+    }
+    return {};
+}
+
+llvm::DWARFDie ReferencedDie(const llvm::DWARFFormValue &value) {
+    auto *unit = const_cast<llvm::DWARFUnit *>(value.getUnit());
+    if (!unit) {
+        return {};
+    }
+    // any DIE of the unit of the value resolves references the same way
+    return getAttributeValueAsReferencedDie(unit->getUnitDIE(), value);
+}
+
+const char *ShortName(const llvm::DWARFDie &die) {
+    return llvm::dwarf::toString(findRecursively(die, llvm::dwarf::DW_AT_name), nullptr);
+}
+
+const char *LinkageName(const llvm::DWARFDie &die) {
+    return llvm::dwarf::toString(
+        findRecursively(die,
+                        {llvm::dwarf::DW_AT_MIPS_linkage_name, llvm::dwarf::DW_AT_linkage_name}),
+        nullptr);
+}
+
+uint64_t DeclLine(const llvm::DWARFDie &die) {
+    return llvm::dwarf::toUnsigned(findRecursively(die, llvm::dwarf::DW_AT_decl_line), 0);
+}
+
+std::optional<std::string> DeclFileName(const llvm::DWARFDie &die) {
+    if (auto form = findRecursively(die, llvm::dwarf::DW_AT_decl_file)) {
+        return form->getAsFile(llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath);
+    }
+    return std::nullopt;
+}
+
+std::vector<llvm::DWARFAttribute> Attributes(const llvm::DWARFDie &die) {
+    std::vector<llvm::DWARFAttribute> attrs;
+    for (const auto &attr : die.attributes()) {
+        attrs.emplace_back(attr);
+    }
+    return attrs;
+}
+
+std::vector<llvm::DWARFDie> Children(const llvm::DWARFDie &die) {
+    std::vector<llvm::DWARFDie> children;
+    for (const auto &child : die.children()) {
+        if (child.isValid()) {
+            children.emplace_back(child);
+        }
+    }
+    return children;
+}
+
+const llvm::DWARFDebugLine::LineTable *LineTableForUnit(llvm::DWARFUnit &unit) {
+    const auto *line_table = unit.getContext().getLineTableForUnit(&unit);
+    if (line_table) {
+        auto &parsed = parsedLineTables();
+        std::lock_guard lock(parsed.mutex);
+        parsed.tables[&unit.getContext()].insert(line_table);
+    }
+    return line_table;
+}
+
+void ForgetLineTables(const llvm::DWARFContext &context) {
+    auto &parsed = parsedLineTables();
+    std::lock_guard lock(parsed.mutex);
+    parsed.tables.erase(&context);
+}
+
+std::vector<std::string> LineTableFiles(llvm::DWARFUnit &unit) {
+    std::vector<std::string> files;
+    const auto *line_table = LineTableForUnit(unit);
+    if (!line_table) {
+        return files;
+    }
+    if (auto last = line_table->getLastValidFileIndex()) {
+        for (uint64_t i = 0; i <= *last; ++i) {
+            std::string file;
+            if (line_table->hasFileAtIndex(i)
+                && line_table->getFileNameByIndex(
+                    i,
+                    unit.getCompilationDir(),
+                    llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+                    file)) {
+                files.emplace_back(std::move(file));
+            }
+        }
+    }
+    return files;
+}
+
+bool HasCrossUnitReferences(llvm::DWARFUnit &unit) {
+    const auto *abbreviations = unit.getAbbreviations();
+    if (!abbreviations) {
+        return false;
+    }
+
+    for (const auto &declaration : *abbreviations) {
+        for (const auto &spec : declaration.attributes()) {
+            if (spec.Form == llvm::dwarf::DW_FORM_ref_addr) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool DIEsExtracted(llvm::DWARFUnit &unit) {
+    // this extracts the unit DIE if it was not yet, which visitors do for every unit anyway
+    auto unit_die = unit.getUnitDIE(/*ExtractUnitDIEOnly=*/true);
+    return unit_die.hasChildren() && unit_die.getFirstChild().isValid();
+}
+
+MemoryStats ContextMemoryStats(llvm::DWARFContext &context) {
+    using Line = llvm::DWARFDebugLine;
+
+    MemoryStats stats;
+    auto add = [&](llvm::DWARFUnit &unit) {
+        ++stats.units;
+        if (!DIEsExtracted(unit)) {
+            return;
+        }
+
+        ++stats.extracted_units;
+        uint64_t dies = unit.getNumDIEs();
+        stats.dies += dies;
+        stats.die_bytes += dies * sizeof(llvm::DWARFDebugInfoEntry);
+    };
+
+    for (const auto &unit : context.info_section_units()) {
+        add(*unit);
+    }
+    for (const auto &unit : context.types_section_units()) {
+        add(*unit);
+    }
+
+    // only the tables already parsed, so that taking the stats does not parse the others
+    auto &parsed = parsedLineTables();
+    std::lock_guard lock(parsed.mutex);
+    auto it = parsed.tables.find(&context);
+    if (it == parsed.tables.end()) {
+        return stats;
+    }
+    for (const auto *table : it->second) {
+        ++stats.line_tables;
+        stats.line_table_rows += table->Rows.size();
+        stats.line_table_sequences += table->Sequences.size();
+        stats.line_table_files += table->Prologue.FileNames.size();
+        stats.line_table_bytes += table->Rows.capacity() * sizeof(Line::Row);
+        stats.line_table_bytes += table->Sequences.capacity() * sizeof(Line::Sequence);
+        stats.line_table_bytes
+            += table->Prologue.FileNames.capacity() * sizeof(Line::FileNameEntry);
+        stats.line_table_bytes
+            += table->Prologue.IncludeDirectories.capacity() * sizeof(llvm::DWARFFormValue);
+    }
+    return stats;
+}
+
+std::optional<std::string> DeclFile(const llvm::DWARFDie &die) {
+    auto form = findRecursively(die, llvm::dwarf::DW_AT_decl_file);
+    if (!form) {
+        return std::nullopt;
+    }
+    if (form->getUnit()) {
+        return form->getAsFile(llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath);
+    }
+
+    // values of DW_FORM_implicit_const have no unit, so assume they come from the same unit
+    auto file_index = form->getAsUnsignedConstant();
+    auto *unit = die.getDwarfUnit();
+    const auto *line_table = LineTableForUnit(*unit);
+    std::string file;
+    if (!file_index || !line_table
+        || !line_table->getFileNameByIndex(
+            *file_index,
+            unit->getCompilationDir(),
+            llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+            file)) {
+        return std::nullopt;
+    }
+    return file;
+}
+
+static std::optional<uint64_t> TypeAlignment(const llvm::DWARFDie &die, int depth) {
+    // guard against malformed, cyclic type chains
+    if (!die.isValid() || depth > 64) {
+        return std::nullopt;
+    }
+
+    if (auto alignment = llvm::dwarf::toUnsigned(die.find(llvm::dwarf::DW_AT_alignment))) {
+        return *alignment;
+    }
+
+    auto referenced = [&](const llvm::DWARFDie &d) {
+        return getAttributeValueAsReferencedDie(d, llvm::dwarf::DW_AT_type)
+            .resolveTypeUnitReference();
+    };
+
+    switch (die.getTag()) {
+    case llvm::dwarf::DW_TAG_base_type:
+        return llvm::dwarf::toUnsigned(die.find(llvm::dwarf::DW_AT_byte_size));
+    case llvm::dwarf::DW_TAG_pointer_type:
+    case llvm::dwarf::DW_TAG_reference_type:
+    case llvm::dwarf::DW_TAG_rvalue_reference_type:
+    case llvm::dwarf::DW_TAG_ptr_to_member_type:
+        return die.getDwarfUnit()->getAddressByteSize();
+    case llvm::dwarf::DW_TAG_enumeration_type:
+        if (auto underlying = referenced(die); underlying.isValid()) {
+            return TypeAlignment(underlying, depth + 1);
+        }
+        return llvm::dwarf::toUnsigned(die.find(llvm::dwarf::DW_AT_byte_size));
+    case llvm::dwarf::DW_TAG_typedef:
+    case llvm::dwarf::DW_TAG_const_type:
+    case llvm::dwarf::DW_TAG_volatile_type:
+    case llvm::dwarf::DW_TAG_restrict_type:
+    case llvm::dwarf::DW_TAG_atomic_type:
+    case llvm::dwarf::DW_TAG_array_type:
+        return TypeAlignment(referenced(die), depth + 1);
+    case llvm::dwarf::DW_TAG_class_type:
+    case llvm::dwarf::DW_TAG_structure_type:
+    case llvm::dwarf::DW_TAG_union_type: {
+        if (die.find(llvm::dwarf::DW_AT_signature)) {
+            return TypeAlignment(die.resolveTypeUnitReference(), depth + 1);
+        }
+        if (die.find(llvm::dwarf::DW_AT_declaration)) {
+            return std::nullopt;
+        }
+
+        uint64_t alignment = 1;
+        for (const auto &child : die.children()) {
+            auto tag = child.getTag();
+            if (tag == llvm::dwarf::DW_TAG_member && child.find(llvm::dwarf::DW_AT_artificial)) {
+                // the vtable pointer
+                alignment = std::max<uint64_t>(alignment,
+                                               die.getDwarfUnit()->getAddressByteSize());
+            } else if ((tag == llvm::dwarf::DW_TAG_member
+                        && !child.find(llvm::dwarf::DW_AT_external))
+                       || tag == llvm::dwarf::DW_TAG_inheritance) {
+                if (auto member = TypeAlignment(referenced(child), depth + 1)) {
+                    alignment = std::max(alignment, *member);
+                }
+            }
+        }
+        return alignment;
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+std::optional<uint64_t> TypeAlignment(const llvm::DWARFDie &die) { return TypeAlignment(die, 0); }
+} // namespace dwarf2cpp
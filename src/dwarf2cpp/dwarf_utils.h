@@ -0,0 +1,108 @@
+#ifndef DWARF2CPP_DWARF_UTILS_H
+#define DWARF2CPP_DWARF_UTILS_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/DebugInfo/DWARF/DWARFDie.h>
+#include <llvm/DebugInfo/DWARF/DWARFFormValue.h>
+#include <llvm/DebugInfo/DWARF/DWARFUnit.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dwarf2cpp {
+std::string ToString(llvm::dwarf::Attribute attr);
+
+llvm::dwarf::Attribute ToAttribute(const std::string &key);
+
+// POLYFILL BEGINS TODO: remove after updating to LLVM 20
+llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
+                                                const llvm::DWARFFormValue &V);
+
+llvm::DWARFDie getAttributeValueAsReferencedDie(const llvm::DWARFDie &die,
+                                                llvm::dwarf::Attribute Attr);
+
+std::optional<llvm::DWARFFormValue> findRecursively(const llvm::DWARFDie &die,
+                                                    llvm::ArrayRef<llvm::dwarf::Attribute> Attrs);
+// POLYFILL ENDS TODO: remove after updating to LLVM 20
+
+// Fingerprint the decoded contents of a unit rather than its raw bytes, so that a unit is not
+// invalidated by layout changes in the string, line, address or range sections caused by other
+// units of the same binary.
+// DIEs of other units referenced by the unit are fingerprinted by their contents, so that a change
+// to a referenced type invalidates the unit.
+std::string UnitFingerprint(llvm::DWARFUnit &unit);
+
+// The DIE a reference value points to, in the unit of the value, in another unit of the same
+// section or in the type unit of a signature. The DIE is invalid if the value is not a reference.
+llvm::DWARFDie ReferencedDie(const llvm::DWARFFormValue &value);
+
+// The name, linkage name and declaration line of a DIE, following DW_AT_specification,
+// DW_AT_abstract_origin and DW_AT_signature. The names are nullptr if they are missing.
+const char *ShortName(const llvm::DWARFDie &die);
+
+const char *LinkageName(const llvm::DWARFDie &die);
+
+uint64_t DeclLine(const llvm::DWARFDie &die);
+
+// The absolute path of the file a DIE is declared in, as resolved by DWARFFormValue::getAsFile.
+// Unlike DeclFile, values of DW_FORM_implicit_const are not resolved.
+std::optional<std::string> DeclFileName(const llvm::DWARFDie &die);
+
+// The attributes of a DIE, and its valid children, as returned by DWARFDie.attributes and
+// DWARFDie.children.
+std::vector<llvm::DWARFAttribute> Attributes(const llvm::DWARFDie &die);
+
+std::vector<llvm::DWARFDie> Children(const llvm::DWARFDie &die);
+
+// The line table of a unit, parsed on first use like DWARFContext::getLineTableForUnit, and
+// recorded so that ContextMemoryStats counts it. LLVM cannot tell whether it parsed the line table
+// of a unit without parsing it, so the tables parsed by LLVM on its own (e.g. for
+// DWARFFormValue::getAsFile) are only counted once they are requested here.
+const llvm::DWARFDebugLine::LineTable *LineTableForUnit(llvm::DWARFUnit &unit);
+
+// Drop the line tables recorded for a context, before it is destroyed.
+void ForgetLineTables(const llvm::DWARFContext &context);
+
+// The absolute paths of the files of the line table of a unit.
+std::vector<std::string> LineTableFiles(llvm::DWARFUnit &unit);
+
+// Find the DIE at the given offset of the .debug_info section, or of the .debug_types section.
+llvm::DWARFDie DieForOffset(llvm::DWARFContext &context, uint64_t offset, bool types_section);
+
+// The absolute path of the file a DIE is declared in, following DW_AT_specification and
+// DW_AT_abstract_origin.
+std::optional<std::string> DeclFile(const llvm::DWARFDie &die);
+
+// Whether the abbreviations of a unit allow references to DIEs of other units (DW_FORM_ref_addr),
+// e.g. to the abstract origins of functions inlined across units by LTO.
+bool HasCrossUnitReferences(llvm::DWARFUnit &unit);
+
+// Whether all the DIEs of a unit were extracted, rather than only its unit DIE or none.
+bool DIEsExtracted(llvm::DWARFUnit &unit);
+
+// Memory held by the units and line tables a context parsed lazily. Sizes are estimated from the
+// number of entries of each array.
+struct MemoryStats {
+    uint64_t units = 0;
+    // units whose DIEs were extracted beyond the unit DIE
+    uint64_t extracted_units = 0;
+    uint64_t dies = 0;
+    uint64_t die_bytes = 0;
+    // line tables parsed through LineTableForUnit
+    uint64_t line_tables = 0;
+    uint64_t line_table_rows = 0;
+    uint64_t line_table_sequences = 0;
+    uint64_t line_table_files = 0;
+    uint64_t line_table_bytes = 0;
+};
+
+MemoryStats ContextMemoryStats(llvm::DWARFContext &context);
+
+// The alignment of a type in bytes, from DW_AT_alignment when present and otherwise derived from
+// the type the way the Itanium ABI lays it out.
+std::optional<uint64_t> TypeAlignment(const llvm::DWARFDie &die);
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_DWARF_UTILS_H
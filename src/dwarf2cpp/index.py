@@ -0,0 +1,144 @@
+import os
+import sqlite3
+from pathlib import Path
+
+from .models import Attribute, Enum, Function, ImportedDeclaration, ImportedModule, Object, Struct, Template, TypeDef
+from .render import create_environment, render_object
+
+_SCHEMA = """
+CREATE TABLE declarations (
+    id INTEGER PRIMARY KEY,
+    name TEXT NOT NULL,
+    qualified_name TEXT NOT NULL,
+    kind TEXT NOT NULL,
+    header TEXT NOT NULL,
+    line INTEGER NOT NULL,
+    linkage_name TEXT,
+    signature TEXT,
+    parent INTEGER REFERENCES declarations(id),
+    die_offset INTEGER
+)
+"""
+
+_INDICES = [
+    "CREATE INDEX declarations_name ON declarations(name)",
+    "CREATE INDEX declarations_qualified_name ON declarations(qualified_name)",
+    "CREATE INDEX declarations_linkage_name ON declarations(linkage_name)",
+]
+
+
+class DeclarationIndex:
+    """
+    Writer of every generated declaration to an SQLite database, so that tools can look them up by name, qualified
+    name or linkage name and jump to the generated header.
+
+    Rows are inserted in batches inside a single transaction each, and the lookup indices are only created on close
+    since that is much cheaper than maintaining them while inserting.
+
+    The database is built next to the path and only renamed over it once closed, so that a failed extraction leaves
+    the previous index in place rather than one missing declarations.
+    """
+
+    def __init__(self, path: Path, batch_size: int = 100_000):
+        self._path = path
+        self._tmp_path = path.with_name(f"{path.name}.tmp")
+        self._tmp_path.unlink(missing_ok=True)
+        self._connection = sqlite3.connect(self._tmp_path)
+        self._connection.execute(_SCHEMA)
+        self._env = create_environment()
+        self._batch_size = batch_size
+        self._rows: list[tuple] = []
+        self._next_id = 1
+
+    def __enter__(self) -> "DeclarationIndex":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        if exc_type is None:
+            self.close()
+        else:
+            self.discard()
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        for line, objects in sorted(file.items()):
+            for obj in objects:
+                self._add(obj, rel_path, line, None)
+
+    def close(self) -> None:
+        self._flush()
+        with self._connection:
+            for statement in _INDICES:
+                self._connection.execute(statement)
+
+        self._connection.close()
+        os.replace(self._tmp_path, self._path)
+
+    def discard(self) -> None:
+        """Roll back and delete the partially built database, leaving the previous one in place."""
+        self._connection.rollback()
+        self._connection.close()
+        self._tmp_path.unlink(missing_ok=True)
+
+    def _add(self, obj: Object, header: str, line: int, parent: int | None) -> None:
+        if obj.is_implicit or isinstance(obj, (Template, ImportedModule, ImportedDeclaration)):
+            return
+
+        row_id = self._next_id
+        self._next_id += 1
+        self._rows.append(
+            (
+                row_id,
+                obj.name or "",
+                obj.qualified_name,
+                obj.kind,
+                header,
+                line,
+                getattr(obj, "linkage_name", None),
+                self._signature(obj),
+                parent,
+                obj.die_offset,
+            )
+        )
+        if len(self._rows) >= self._batch_size:
+            self._flush()
+
+        if isinstance(obj, Struct):
+            for member_line, members in sorted(obj.members.items()):
+                for member in members:
+                    self._add(member, header, member_line, row_id)
+
+    def _signature(self, obj: Object) -> str | None:
+        if isinstance(obj, Function):
+            return render_object(self._env, obj)
+
+        if isinstance(obj, Attribute):
+            if isinstance(obj.type, Object):
+                return f"{obj.type.kind} {obj.type.name or '(anonymous)'} {obj.name}"
+            return render_object(self._env, obj)
+
+        if isinstance(obj, Struct):
+            bases = ", ".join(base for base, _ in obj.bases)
+            return f"{obj.kind} {obj.name}" + (f" : {bases}" if bases else "")
+
+        if isinstance(obj, Enum):
+            return f"enum {'class ' if obj.is_class else ''}{obj.name}" + (f" : {obj.base}" if obj.base else "")
+
+        if isinstance(obj, TypeDef):
+            if isinstance(obj.value, Object):
+                # typedef struct { ... } name;
+                return f"typedef {obj.value.kind} {obj.value.name + ' ' if obj.value.name else ''}{obj.name}"
+            return render_object(self._env, obj)
+
+        return None
+
+    def _flush(self) -> None:
+        if not self._rows:
+            return
+
+        with self._connection:
+            self._connection.executemany(
+                "INSERT INTO declarations VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                self._rows,
+            )
+
+        self._rows.clear()
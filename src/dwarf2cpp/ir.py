@@ -0,0 +1,84 @@
+import os
+import struct
+from pathlib import Path
+from typing import BinaryIO, Generator
+
+from . import serialization
+from .models import Object
+
+MAGIC = b"D2CIR\0"
+
+# Bump this whenever the layout of the file changes, the records are versioned by serialization.SCHEMA_VERSION.
+IR_VERSION = 6
+
+_HEADER = struct.Struct("<6sI")
+_RECORD = struct.Struct("<Q")
+
+
+class IRWriter:
+    """
+    Writer of the merged per-file models to an intermediate representation (IR) file.
+
+    The file starts with a magic string and a version, followed by one record per file so that it can be streamed
+    when rendering. Each record is the path and the models of the file, serialized by the serialization module, so
+    that rendering an IR file from another user cannot run code.
+
+    The file is written next to the path and only renamed into place once closed, so that a failed extraction never
+    leaves a truncated file that reads like a complete one.
+    """
+
+    def __init__(self, path: Path):
+        self._path = path
+        self._tmp_path = path.with_name(f"{path.name}.tmp")
+        self._file: BinaryIO = self._tmp_path.open("wb")
+        self._file.write(_HEADER.pack(MAGIC, IR_VERSION))
+
+    def __enter__(self) -> "IRWriter":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        if exc_type is None:
+            self.close()
+        else:
+            self.discard()
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        data = serialization.dumps((rel_path, file))
+        self._file.write(_RECORD.pack(len(data)))
+        self._file.write(data)
+
+    def close(self) -> None:
+        self._file.close()
+        os.replace(self._tmp_path, self._path)
+
+    def discard(self) -> None:
+        """Close and delete the partially written file, leaving the previous one in place."""
+        self._file.close()
+        self._tmp_path.unlink(missing_ok=True)
+
+
+def read_ir(path: Path) -> Generator[tuple[str, dict[int, list[Object]]], None, None]:
+    """Read the files stored in an intermediate representation (IR) file."""
+    with path.open("rb") as f:
+        header = f.read(_HEADER.size)
+        if len(header) != _HEADER.size:
+            raise ValueError(f"{path} is not an IR file")
+
+        magic, version = _HEADER.unpack(header)
+        if magic != MAGIC:
+            raise ValueError(f"{path} is not an IR file")
+
+        if version != IR_VERSION:
+            raise ValueError(f"Unsupported IR version {version} in {path}, expected {IR_VERSION}")
+
+        while record := f.read(_RECORD.size):
+            if len(record) != _RECORD.size:
+                raise ValueError(f"Truncated IR file {path}")
+
+            (size,) = _RECORD.unpack(record)
+            data = f.read(size)
+            if len(data) != size:
+                raise ValueError(f"Truncated IR file {path}")
+
+            rel_path, file = serialization.loads(data)
+            yield rel_path, file
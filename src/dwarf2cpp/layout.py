@@ -0,0 +1,192 @@
+import json
+import os
+from pathlib import Path
+from typing import Any, Generator, TextIO
+
+from .models import Object, Struct, StructLayout, TypeDef, Union
+
+CACHE_LINE_SIZE = 64
+
+
+def analyze_layout(layout: StructLayout, is_union: bool = False, cache_line_size: int = CACHE_LINE_SIZE) -> dict:
+    """
+    Find the holes, the tail padding and the members straddling cache lines of a struct layout.
+
+    Offsets and sizes are tracked in bits so that holes between bit fields are found as well.
+    """
+    members = []
+    holes = []
+    end = 0
+    line_bits = cache_line_size * 8
+    for member in sorted(layout.members, key=_bit_range):
+        start, stop = _bit_range(member)
+        if not is_union and start > end:
+            # index of the member the hole follows, -1 for a hole at the start
+            holes.append({"after": len(members) - 1, "bit_offset": end, "bit_size": start - end})
+
+        end = max(end, stop)
+        members.append(
+            {
+                "name": member.name,
+                "type": member.type,
+                "is_base": member.is_base,
+                "offset": start // 8,
+                "byte_size": member.byte_size,
+                "bit_offset": start if member.bit_size is not None else None,
+                "bit_size": member.bit_size,
+                "straddles_cache_line": stop > start and start // line_bits != (stop - 1) // line_bits,
+            }
+        )
+
+    size = layout.byte_size
+    return {
+        "byte_size": size,
+        "alignment": layout.alignment,
+        "cache_lines": -(-size // cache_line_size),
+        "members": members,
+        "holes": holes,
+        "sum_holes_bits": sum(hole["bit_size"] for hole in holes),
+        "padding_bits": max(size * 8 - end, 0) if members else 0,
+    }
+
+
+def iter_struct_layouts(file: dict[int, list[Object]]) -> Generator[tuple[str, Struct, int], None, None]:
+    """Yield the name, model and line of every struct of a file whose layout is known, including nested ones."""
+    for line, objects in sorted(file.items()):
+        for obj in objects:
+            yield from _struct_layouts(obj, line)
+
+
+def _struct_layouts(obj: Object, line: int, name: str | None = None) -> Generator[tuple[str, Struct, int], None, None]:
+    if isinstance(obj, TypeDef) and isinstance(obj.value, Struct) and not obj.value.name:
+        # typedef struct { ... } name;
+        yield from _struct_layouts(obj.value, line, obj.qualified_name)
+        return
+
+    if not isinstance(obj, Struct) or obj.is_implicit or obj.is_declaration:
+        return
+
+    if obj.layout is not None:
+        yield name or obj.qualified_name, obj, line
+
+    for member_line, members in sorted(obj.members.items()):
+        for member in members:
+            yield from _struct_layouts(member, member_line)
+
+
+def _bit_range(member) -> tuple[int, int]:
+    if member.bit_size is not None:
+        return member.offset, member.offset + member.bit_size
+
+    return member.offset * 8, (member.offset + (member.byte_size or 0)) * 8
+
+
+def _format_bits(bits: int) -> str:
+    parts = []
+    if bits // 8:
+        parts.append(f"{bits // 8} byte{'s' if bits // 8 != 1 else ''}")
+    if bits % 8:
+        parts.append(f"{bits % 8} bit{'s' if bits % 8 != 1 else ''}")
+    return " ".join(parts)
+
+
+class LayoutReport:
+    """
+    Writer of the memory layout of every extracted struct, class and union, in the style of pahole.
+
+    Holes between members, tail padding and members straddling cache lines are annotated. The report is written as
+    JSON when the path ends with .json, and as annotated C++ declarations otherwise.
+
+    The report is written next to the path and only renamed into place once closed, so that a failed extraction
+    never leaves a report missing structs.
+    """
+
+    def __init__(self, path: Path, cache_line_size: int = CACHE_LINE_SIZE):
+        self._path = path
+        self._tmp_path = path.with_name(f"{path.name}.tmp")
+        self._file: TextIO = self._tmp_path.open("w")
+        self._json = path.suffix == ".json"
+        self._cache_line_size = cache_line_size
+        self._entries: list[dict[str, Any]] = []
+
+    def __enter__(self) -> "LayoutReport":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        if exc_type is None:
+            self.close()
+        else:
+            self.discard()
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        for name, struct, line in iter_struct_layouts(file):
+            entry = {
+                "name": name,
+                "kind": struct.kind,
+                "header": rel_path,
+                "line": line,
+                **analyze_layout(struct.layout, isinstance(struct, Union), self._cache_line_size),
+            }
+            if self._json:
+                self._entries.append(entry)
+            else:
+                self._write(entry)
+
+    def close(self) -> None:
+        if self._json:
+            json.dump(self._entries, self._file, indent=2)
+
+        self._file.close()
+        os.replace(self._tmp_path, self._path)
+
+    def discard(self) -> None:
+        """Close and delete the partially written report, leaving the previous one in place."""
+        self._file.close()
+        self._tmp_path.unlink(missing_ok=True)
+
+    def _write(self, entry: dict[str, Any]) -> None:
+        holes = {hole["after"]: hole for hole in entry["holes"]}
+        lines = [f"{entry['kind']} {entry['name']} {{"]
+        if -1 in holes:
+            lines.append(f"\t/* XXX {_format_bits(holes[-1]['bit_size'])} hole, try to pack */")
+
+        cache_line = 0
+        for i, member in enumerate(entry["members"]):
+            while member["offset"] >= (cache_line + 1) * self._cache_line_size:
+                cache_line += 1
+                lines.append(
+                    f"\t/* --- cacheline {cache_line} boundary ({cache_line * self._cache_line_size} bytes) --- */"
+                )
+
+            if member["is_base"]:
+                declaration = f"{member['type']} /* base */"
+            elif member["bit_size"] is not None:
+                declaration = f"{member['type']} {member['name']}:{member['bit_size']};"
+            else:
+                declaration = f"{member['type']} {member['name']};"
+
+            size = member["byte_size"] if member["byte_size"] is not None else "?"
+            location = f"/* {member['offset']:5} {size:5} */"
+            if member["bit_size"] is not None:
+                location = f"/* {member['offset']:5}:{member['bit_offset'] % 8:2} {size:5} */"
+
+            lines.append(f"\t{declaration:<48} {location}")
+            if member["straddles_cache_line"]:
+                lines.append("\t/* XXX straddles a cacheline boundary */")
+
+            if hole := holes.get(i):
+                lines.append(f"\t/* XXX {_format_bits(hole['bit_size'])} hole, try to pack */")
+
+        lines.append("")
+        lines.append(
+            f"\t/* size: {entry['byte_size']}, cachelines: {entry['cache_lines']}, members: {len(entry['members'])} */"
+        )
+        if entry["holes"]:
+            lines.append(f"\t/* holes: {len(entry['holes'])}, sum holes: {_format_bits(entry['sum_holes_bits'])} */")
+        if entry["padding_bits"]:
+            lines.append(f"\t/* padding: {_format_bits(entry['padding_bits'])} */")
+        if entry["alignment"] is not None:
+            lines.append(f"\t/* alignment: {entry['alignment']} */")
+
+        lines.append(f"}};  /* {entry['header']}:{entry['line']} */")
+        self._file.write("\n".join(lines) + "\n\n")
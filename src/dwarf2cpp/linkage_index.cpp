@@ -0,0 +1,56 @@
+#include "linkage_index.h"
+
+#include <llvm/Support/xxhash.h>
+
+#include <algorithm>
+
+namespace dwarf2cpp {
+namespace {
+    llvm::StringRef linkageName(const llvm::DWARFDie &die) {
+        // only the DIEs holding the attribute, not the definitions referring to them
+        return llvm::dwarf::toStringRef(
+            die.find({llvm::dwarf::DW_AT_linkage_name, llvm::dwarf::DW_AT_MIPS_linkage_name}));
+    }
+} // namespace
+
+LinkageNameIndex::LinkageNameIndex(llvm::DWARFContext &context) {
+    for (const auto &unit : context.info_section_units()) {
+        addUnit(*unit);
+    }
+    for (const auto &unit : context.types_section_units()) {
+        addUnit(*unit);
+    }
+    std::stable_sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) {
+        return a.hash < b.hash;
+    });
+    entries_.shrink_to_fit();
+}
+
+void LinkageNameIndex::addUnit(llvm::DWARFUnit &unit) {
+    for (const auto &debug_info_entry : unit.dies()) {
+        llvm::DWARFDie die(&unit, &debug_info_entry);
+        if (auto name = linkageName(die); !name.empty()) {
+            entries_.push_back({llvm::xxh3_64bits(name), &unit, unit.getDIEIndex(die)});
+        }
+    }
+}
+
+std::vector<llvm::DWARFDie> LinkageNameIndex::find(llvm::StringRef linkage_name) const {
+    auto hash = llvm::xxh3_64bits(linkage_name);
+    auto [begin, end] = std::equal_range(
+        entries_.begin(),
+        entries_.end(),
+        Entry{hash, nullptr, 0},
+        [](const Entry &a, const Entry &b) { return a.hash < b.hash; });
+
+    std::vector<llvm::DWARFDie> result;
+    for (auto it = begin; it != end; ++it) {
+        auto die = it->unit->getDIEAtIndex(it->die_index);
+        if (linkageName(die) == linkage_name) {
+            result.push_back(die);
+        }
+    }
+    return result;
+}
+
+} // namespace dwarf2cpp
@@ -0,0 +1,39 @@
+#ifndef DWARF2CPP_LINKAGE_INDEX_H
+#define DWARF2CPP_LINKAGE_INDEX_H
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/DebugInfo/DWARF/DWARFDie.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dwarf2cpp {
+
+// Maps linkage names to the DIEs holding them, in .debug_info and .debug_types. Only a 64-bit hash
+// of each name is kept, sorted along with the location of its DIE, and the candidates of a lookup
+// are checked against their own linkage name to rule out collisions. Building the index parses
+// every unit, so the context must be created thread-safe when other threads can use it.
+class LinkageNameIndex {
+public:
+    explicit LinkageNameIndex(llvm::DWARFContext &context);
+
+    [[nodiscard]] std::vector<llvm::DWARFDie> find(llvm::StringRef linkage_name) const;
+
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        llvm::DWARFUnit *unit;
+        uint32_t die_index;
+    };
+
+    void addUnit(llvm::DWARFUnit &unit);
+
+    std::vector<Entry> entries_;
+};
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_LINKAGE_INDEX_H
@@ -0,0 +1,111 @@
+// Native driver, the equivalent of `python -m dwarf2cpp extract` without the Python interpreter.
+
+#include "render.h"
+#include "visitor.h"
+
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+llvm::cl::opt<std::string> Path(llvm::cl::Positional,
+                                llvm::cl::desc("<path>"),
+                                llvm::cl::Required);
+
+llvm::cl::opt<std::string> BaseDir("base-dir",
+                                   llvm::cl::desc("Base directory used during compilation."),
+                                   llvm::cl::Required);
+
+llvm::cl::opt<std::string> OutputPath(
+    "output-path",
+    llvm::cl::desc("Output directory for generated files. Defaults to 'out' inside the input "
+                   "file's directory."));
+
+llvm::cl::alias OutputPathAlias("o",
+                                llvm::cl::desc("Alias for --output-path"),
+                                llvm::cl::aliasopt(OutputPath));
+
+std::string Absolute(const std::string &path) {
+    llvm::SmallString<256> result(path);
+    llvm::sys::fs::make_absolute(result);
+    return result.str().str();
+}
+
+void WriteFile(const std::string &output_path,
+               const std::string &rel_path,
+               const std::string &content) {
+    llvm::SmallString<256> output_file(output_path);
+    llvm::sys::path::append(output_file, llvm::sys::path::Style::posix, rel_path);
+    if (auto ec = llvm::sys::fs::create_directories(llvm::sys::path::parent_path(output_file))) {
+        throw std::runtime_error("Cannot create the directory of " + output_file.str().str() + ": "
+                                 + ec.message());
+    }
+
+    std::error_code ec;
+    llvm::raw_fd_ostream os(output_file, ec, llvm::sys::fs::OF_TextWithCRLF);
+    if (ec) {
+        throw std::runtime_error("Cannot open " + output_file.str().str() + ": " + ec.message());
+    }
+    os << content;
+}
+
+void Extract() {
+    std::string output_path = OutputPath;
+    if (output_path.empty()) {
+        llvm::SmallString<256> parent(llvm::sys::path::parent_path(Path));
+        if (parent.empty()) {
+            parent = ".";
+        }
+        llvm::sys::path::append(parent, "out");
+        output_path = parent.str().str();
+    }
+
+    llvm::errs() << "INFO:dwarf2cpp:Creating DWARF context for \"" << Absolute(Path) << "\"\n";
+    auto object = llvm::object::ObjectFile::createObjectFile(Path);
+    if (!object) {
+        throw std::runtime_error(toString(object.takeError()));
+    }
+    auto context = llvm::DWARFContext::create(*object->getBinary());
+
+    dwarf2cpp::Visitor visitor(*context, BaseDir);
+    visitor.visitFiles([&](const std::string &rel_path, dwarf2cpp::models::File &file) {
+        WriteFile(output_path, rel_path, dwarf2cpp::RenderFile(file));
+    });
+    if (visitor.dropped()) {
+        llvm::errs() << "WARNING:dwarf2cpp:Dropped " << visitor.dropped()
+                     << " declarations referenced after their file was written\n";
+    }
+
+    llvm::errs() << "INFO:dwarf2cpp:Done! Files generated in: " << Absolute(output_path) << "\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    // accept the command name of the Python CLI, so that both take the same arguments
+    std::vector<const char *> args(argv, argv + argc);
+    if (args.size() > 1 && std::strcmp(args[1], "extract") == 0) {
+        args.erase(args.begin() + 1);
+    }
+
+    llvm::cl::ParseCommandLineOptions(static_cast<int>(args.size()),
+                                      args.data(),
+                                      "Generate C++ headers from DWARF Debugging Information "
+                                      "Format.\n");
+
+    try {
+        Extract();
+    } catch (const std::exception &e) {
+        llvm::errs() << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
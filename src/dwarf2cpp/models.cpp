@@ -0,0 +1,415 @@
+#include "models.h"
+
+namespace dwarf2cpp::models {
+namespace {
+    template <typename T>
+    bool PointeesEqual(const std::shared_ptr<T> &a, const std::shared_ptr<T> &b) {
+        if (!a || !b) {
+            return a == b;
+        }
+        return a == b || *a == *b;
+    }
+
+    // The `or` of models.py, which takes the other value when this one is None or 0.
+    template <typename T>
+    std::optional<T> Or(const std::optional<T> &a, const std::optional<T> &b) {
+        return a && *a ? a : b;
+    }
+
+    // Names are falsy when they are None or empty, and so are the defaults of constant template
+    // parameters when they are 0, which are the only ones that are printed integers.
+    std::optional<std::string> Or(const std::optional<std::string> &a,
+                                  const std::optional<std::string> &b) {
+        return a && !a->empty() ? a : b;
+    }
+
+    std::optional<std::string> OrDefault(const std::optional<std::string> &a,
+                                         const std::optional<std::string> &b) {
+        return a && !a->empty() && *a != "0" ? a : b;
+    }
+
+    std::shared_ptr<Namespace> CloneNamespace(const std::shared_ptr<Namespace> &ns) {
+        if (!ns) {
+            return nullptr;
+        }
+        auto copy = std::make_shared<Namespace>(*ns);
+        copy->parent = CloneNamespace(ns->parent);
+        return copy;
+    }
+
+    ObjectPtr CloneObject(const ObjectPtr &object) { return object ? object->clone() : nullptr; }
+
+    std::vector<std::shared_ptr<TemplateParameter>>
+    CloneParameters(const std::vector<std::shared_ptr<TemplateParameter>> &parameters) {
+        std::vector<std::shared_ptr<TemplateParameter>> result;
+        result.reserve(parameters.size());
+        for (const auto &parameter : parameters) {
+            result.push_back(parameter->clone());
+        }
+        return result;
+    }
+} // namespace
+
+const char *KindName(Kind kind) {
+    switch (kind) {
+        case Kind::ImportedModule:
+            return "imported_module";
+        case Kind::ImportedDeclaration:
+            return "imported_declaration";
+        case Kind::Attribute:
+            return "attribute";
+        case Kind::Function:
+            return "function";
+        case Kind::Struct:
+            return "struct";
+        case Kind::Class:
+            return "class";
+        case Kind::Union:
+            return "union";
+        case Kind::Enum:
+            return "enum";
+        case Kind::TypeDef:
+            return "typedef";
+        case Kind::Template:
+            return "template";
+    }
+    return "";
+}
+
+std::string Namespace::qualifiedName() const {
+    if (!parent) {
+        return name.value_or("");
+    }
+    return parent->qualifiedName() + "::" + name.value_or("None");
+}
+
+bool Namespace::operator==(const Namespace &other) const {
+    return name == other.name && PointeesEqual(parent, other.parent)
+           && is_inline == other.is_inline;
+}
+
+bool Object::operator==(const Object &other) const {
+    return kind == other.kind && name == other.name && is_implicit == other.is_implicit
+           && is_declaration == other.is_declaration && access == other.access
+           && fieldsEqual(other);
+}
+
+void Object::cloneInto(Object &copy) const {
+    copy.parent = CloneNamespace(parent);
+    if (template_) {
+        copy.template_ = std::static_pointer_cast<Template>(template_->clone());
+    }
+}
+
+bool Equal(const ObjectPtr &a, const ObjectPtr &b) { return PointeesEqual(a, b); }
+
+bool Contains(const std::vector<ObjectPtr> &objects, const Object &object) {
+    for (const auto &item : objects) {
+        if (item.get() == &object || *item == object) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<ObjectPtr> MergeLine(const std::vector<ObjectPtr> &objects) {
+    std::vector<ObjectPtr> result;
+    for (const auto &item : objects) {
+        if (result.empty()) {
+            result.push_back(item);
+        } else if (!Contains(result, *item) && !result.back()->merge(*item)) {
+            result.push_back(item);
+        }
+    }
+    return result;
+}
+
+ObjectPtr ImportedModule::clone() const {
+    auto copy = std::make_shared<ImportedModule>(*this);
+    cloneInto(*copy);
+    copy->import_ = CloneNamespace(import_);
+    return copy;
+}
+
+bool ImportedModule::fieldsEqual(const Object &other) const {
+    return PointeesEqual(import_, static_cast<const ImportedModule &>(other).import_);
+}
+
+ObjectPtr ImportedDeclaration::clone() const {
+    auto copy = std::make_shared<ImportedDeclaration>(*this);
+    cloneInto(*copy);
+    copy->import_namespace = CloneNamespace(import_namespace);
+    return copy;
+}
+
+bool ImportedDeclaration::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const ImportedDeclaration &>(other);
+    return PointeesEqual(import_namespace, o.import_namespace) && import_type == o.import_type;
+}
+
+bool Attribute::merge(Object &other) {
+    if (other.kind != Kind::Attribute) {
+        return false;
+    }
+
+    auto &o = static_cast<Attribute &>(other);
+    if (name != o.name || type != o.type || !Equal(inline_type, o.inline_type)) {
+        return false;
+    }
+
+    if (!default_value) {
+        default_value = o.default_value;
+    }
+    alignment = Or(alignment, o.alignment);
+    bit_size = Or(bit_size, o.bit_size);
+    offset = offset ? offset : o.offset;
+    linkage_name = Or(linkage_name, o.linkage_name);
+    is_static = is_static || o.is_static;
+    return true;
+}
+
+ObjectPtr Attribute::clone() const {
+    auto copy = std::make_shared<Attribute>(*this);
+    cloneInto(*copy);
+    copy->inline_type = CloneObject(inline_type);
+    return copy;
+}
+
+bool Attribute::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const Attribute &>(other);
+    return type == o.type && Equal(inline_type, o.inline_type) && default_value == o.default_value
+           && alignment == o.alignment && bit_size == o.bit_size && offset == o.offset
+           && is_static == o.is_static;
+}
+
+bool Function::merge(Object &other) {
+    if (other.kind != Kind::Function) {
+        return false;
+    }
+
+    auto &o = static_cast<Function &>(other);
+    if (name != o.name || returns != o.returns || parameters.size() != o.parameters.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (!(parameters[i].type == o.parameters[i].type)
+            || parameters[i].kind != o.parameters[i].kind) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        parameters[i].name = Or(parameters[i].name, o.parameters[i].name);
+    }
+
+    noreturn = noreturn || o.noreturn;
+    is_explicit = is_explicit || o.is_explicit;
+    is_deleted = is_deleted || o.is_deleted;
+    is_inline = is_inline || o.is_inline;
+    is_static = is_static || o.is_static;
+    is_const = is_const || o.is_const;
+    virtuality = Or(virtuality, o.virtuality);
+    linkage_name = Or(linkage_name, o.linkage_name);
+    return true;
+}
+
+ObjectPtr Function::clone() const {
+    auto copy = std::make_shared<Function>(*this);
+    cloneInto(*copy);
+    return copy;
+}
+
+bool Function::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const Function &>(other);
+    return parameters == o.parameters && returns == o.returns && noreturn == o.noreturn
+           && is_explicit == o.is_explicit && is_deleted == o.is_deleted
+           && is_inline == o.is_inline && is_static == o.is_static && is_const == o.is_const
+           && virtuality == o.virtuality;
+}
+
+bool Struct::merge(Object &other) {
+    if (!other.isStruct()) {
+        return false;
+    }
+
+    auto &o = static_cast<Struct &>(other);
+    if (kind != o.kind || name != o.name || bases != o.bases) {
+        return false;
+    }
+
+    for (const auto &[line, objects] : o.members) {
+        auto &lines = members[line];
+        lines.insert(lines.end(), objects.begin(), objects.end());
+        lines = MergeLine(lines);
+    }
+
+    alignment = Or(alignment, o.alignment);
+    byte_size = Or(byte_size, o.byte_size);
+    return true;
+}
+
+ObjectPtr Struct::clone() const {
+    auto copy = std::make_shared<Struct>(*this);
+    cloneInto(*copy);
+    for (auto &[line, objects] : copy->members) {
+        for (auto &object : objects) {
+            object = object->clone();
+        }
+    }
+    return copy;
+}
+
+bool Struct::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const Struct &>(other);
+    if (bases != o.bases || alignment != o.alignment || byte_size != o.byte_size
+        || members.size() != o.members.size()) {
+        return false;
+    }
+
+    for (auto it = members.begin(), it2 = o.members.begin(); it != members.end(); ++it, ++it2) {
+        if (it->first != it2->first || it->second.size() != it2->second.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < it->second.size(); ++i) {
+            if (!Equal(it->second[i], it2->second[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ObjectPtr Enum::clone() const {
+    auto copy = std::make_shared<Enum>(*this);
+    cloneInto(*copy);
+    return copy;
+}
+
+bool Enum::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const Enum &>(other);
+    return base == o.base && values == o.values && is_class == o.is_class;
+}
+
+bool TypeDef::merge(Object &other) {
+    if (other.kind != Kind::TypeDef) {
+        return false;
+    }
+
+    auto &o = static_cast<TypeDef &>(other);
+    if (name != o.name || value.has_value() != o.value.has_value()
+        || bool(value_type) != bool(o.value_type)
+        || (value_type && value_type->kind != o.value_type->kind)) {
+        return false;
+    }
+
+    if (value) {
+        if (value != o.value) {
+            return false;
+        }
+    } else if (value_type && !value_type->merge(*o.value_type)) {
+        return false;
+    }
+
+    alignment = Or(alignment, o.alignment);
+    return true;
+}
+
+ObjectPtr TypeDef::clone() const {
+    auto copy = std::make_shared<TypeDef>(*this);
+    cloneInto(*copy);
+    copy->value_type = CloneObject(value_type);
+    return copy;
+}
+
+bool TypeDef::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const TypeDef &>(other);
+    return value == o.value && Equal(value_type, o.value_type) && alignment == o.alignment;
+}
+
+std::shared_ptr<TemplateParameter> TemplateParameter::toDeclaration() const {
+    auto result = std::make_shared<TemplateParameter>(kind);
+    result->name = name;
+    switch (kind) {
+        case TemplateParameterKind::Type:
+        case TemplateParameterKind::Template:
+            result->default_ = default_;
+            break;
+        case TemplateParameterKind::Constant:
+            result->type = type;
+            result->default_ = default_;
+            break;
+        case TemplateParameterKind::Pack:
+            result->type = type;
+            break;
+    }
+    return result;
+}
+
+std::shared_ptr<TemplateParameter> TemplateParameter::clone() const {
+    auto copy = std::make_shared<TemplateParameter>(*this);
+    copy->parameters = CloneParameters(parameters);
+    return copy;
+}
+
+bool TemplateParameter::operator==(const TemplateParameter &other) const {
+    if (kind != other.kind || name != other.name || default_ != other.default_
+        || type != other.type || value != other.value
+        || parameters.size() != other.parameters.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (!PointeesEqual(parameters[i], other.parameters[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Template::merge(Object &other) {
+    if (other.kind != Kind::Template) {
+        return false;
+    }
+
+    auto &o = static_cast<Template &>(other);
+    if (name != o.name || !Equal(declaration, o.declaration)
+        || parameters.size() != o.parameters.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        const auto &p1 = *parameters[i];
+        const auto &p2 = *o.parameters[i];
+        if (p1.kind != p2.kind || p1.name != p2.name || p1.type != p2.type) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        parameters[i]->default_ = OrDefault(parameters[i]->default_, o.parameters[i]->default_);
+    }
+    return true;
+}
+
+ObjectPtr Template::clone() const {
+    auto copy = std::make_shared<Template>(*this);
+    cloneInto(*copy);
+    copy->declaration = CloneObject(declaration);
+    copy->parameters = CloneParameters(parameters);
+    return copy;
+}
+
+bool Template::fieldsEqual(const Object &other) const {
+    const auto &o = static_cast<const Template &>(other);
+    if (!Equal(declaration, o.declaration) || parameters.size() != o.parameters.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (!PointeesEqual(parameters[i], o.parameters[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace dwarf2cpp::models
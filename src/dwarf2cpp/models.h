@@ -0,0 +1,264 @@
+#ifndef DWARF2CPP_MODELS_H
+#define DWARF2CPP_MODELS_H
+
+#include <llvm/BinaryFormat/Dwarf.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The models of the native driver, mirroring models.py. Objects are held by shared pointers, the
+// way Python holds references, so that merging an object updates every file and template sharing
+// it. Equality compares the same fields as the dataclasses of models.py.
+namespace dwarf2cpp::models {
+
+enum class Kind {
+    ImportedModule,
+    ImportedDeclaration,
+    Attribute,
+    Function,
+    Struct,
+    Class,
+    Union,
+    Enum,
+    TypeDef,
+    Template,
+};
+
+// The kind as spelled by models.py, e.g. "struct".
+const char *KindName(Kind kind);
+
+struct Namespace {
+    std::optional<std::string> name;
+    std::shared_ptr<Namespace> parent;
+    bool is_inline = false;
+
+    [[nodiscard]] std::string qualifiedName() const;
+
+    bool operator==(const Namespace &other) const;
+};
+
+// A type printed by DWARFTypePrinter, either whole or split around the name of a declarator, e.g.
+// ("void (*", ")(int)") for a pointer to a function.
+struct TypeName {
+    std::string before;
+    std::string after;
+    bool split = false;
+
+    bool operator==(const TypeName &other) const {
+        return before == other.before && after == other.after && split == other.split;
+    }
+
+    bool operator!=(const TypeName &other) const { return !(*this == other); }
+};
+
+struct Template;
+
+struct Object {
+    explicit Object(Kind kind) : kind(kind) {}
+    virtual ~Object() = default;
+
+    Kind kind;
+    std::optional<std::string> name;
+    std::shared_ptr<Namespace> parent;
+    bool is_implicit = false;
+    bool is_declaration = false;
+    std::optional<llvm::dwarf::AccessAttribute> access;
+    std::shared_ptr<Template> template_;
+
+    [[nodiscard]] bool isStruct() const {
+        return kind == Kind::Struct || kind == Kind::Class || kind == Kind::Union;
+    }
+
+    // Merge another object declared on the same line into this one, false if they differ.
+    virtual bool merge(Object &/*other*/) { return false; }
+
+    // A copy that shares nothing with this object, like copy.deepcopy.
+    [[nodiscard]] virtual std::shared_ptr<Object> clone() const = 0;
+
+    bool operator==(const Object &other) const;
+
+protected:
+    [[nodiscard]] virtual bool fieldsEqual(const Object &/*other*/) const { return true; }
+
+    void cloneInto(Object &copy) const;
+};
+
+using ObjectPtr = std::shared_ptr<Object>;
+
+// Objects by declaration line.
+using File = std::map<uint64_t, std::vector<ObjectPtr>>;
+
+bool Equal(const ObjectPtr &a, const ObjectPtr &b);
+
+// Whether an object is in a list, by equality.
+bool Contains(const std::vector<ObjectPtr> &objects, const Object &object);
+
+// Merge the objects of a line that are equal or that can be merged into the previous one.
+std::vector<ObjectPtr> MergeLine(const std::vector<ObjectPtr> &objects);
+
+struct ImportedModule : Object {
+    ImportedModule() : Object(Kind::ImportedModule) {}
+
+    std::shared_ptr<Namespace> import_;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+struct ImportedDeclaration : Object {
+    ImportedDeclaration() : Object(Kind::ImportedDeclaration) {}
+
+    // either a namespace or the name of a type
+    std::shared_ptr<Namespace> import_namespace;
+    std::optional<std::string> import_type;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+struct Attribute : Object {
+    Attribute() : Object(Kind::Attribute) {}
+
+    // either a type name, or an anonymous type declared in place
+    std::optional<TypeName> type;
+    ObjectPtr inline_type;
+    std::optional<std::string> default_value;
+    std::optional<uint64_t> alignment;
+    std::optional<uint64_t> bit_size;
+    std::optional<int64_t> offset;
+    bool is_static = false;
+    std::optional<std::string> linkage_name;
+
+    bool merge(Object &other) override;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+enum class ParameterKind { Positional, Variadic };
+
+struct Parameter {
+    std::optional<std::string> name;
+    TypeName type;
+    ParameterKind kind = ParameterKind::Positional;
+
+    bool operator==(const Parameter &other) const {
+        return name == other.name && type == other.type && kind == other.kind;
+    }
+};
+
+struct Function : Object {
+    Function() : Object(Kind::Function) {}
+
+    std::vector<Parameter> parameters;
+    std::optional<std::string> returns;
+    bool noreturn = false;
+    bool is_explicit = false;
+    bool is_deleted = false;
+    bool is_inline = false;
+    bool is_static = false;
+    bool is_const = false;
+    std::optional<llvm::dwarf::VirtualityAttribute> virtuality;
+    std::optional<std::string> linkage_name;
+
+    bool merge(Object &other) override;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+struct Struct : Object {
+    explicit Struct(Kind kind = Kind::Struct) : Object(kind) {}
+
+    std::vector<std::pair<std::string, std::optional<llvm::dwarf::AccessAttribute>>> bases;
+    File members;
+    std::optional<uint64_t> alignment;
+    std::optional<uint64_t> byte_size;
+
+    bool merge(Object &other) override;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+struct Enum : Object {
+    Enum() : Object(Kind::Enum) {}
+
+    std::optional<std::string> base;
+    std::vector<std::pair<std::optional<std::string>, std::string>> values;
+    bool is_class = false;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+struct TypeDef : Object {
+    TypeDef() : Object(Kind::TypeDef) {}
+
+    // either the name of a type, or an anonymous type declared in place, or void when neither
+    std::optional<std::string> value;
+    ObjectPtr value_type;
+    std::optional<uint64_t> alignment;
+
+    bool merge(Object &other) override;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+enum class TemplateParameterKind { Constant, Type, Template, Pack };
+
+struct TemplateParameter {
+    explicit TemplateParameter(TemplateParameterKind kind) : kind(kind) {}
+
+    TemplateParameterKind kind;
+    std::optional<std::string> name;
+    std::optional<std::string> default_;
+    std::optional<std::string> type;
+    // the value of a constant parameter, as printed
+    std::optional<std::string> value;
+    std::vector<std::shared_ptr<TemplateParameter>> parameters;
+
+    [[nodiscard]] std::shared_ptr<TemplateParameter> toDeclaration() const;
+
+    [[nodiscard]] std::shared_ptr<TemplateParameter> clone() const;
+
+    bool operator==(const TemplateParameter &other) const;
+};
+
+struct Template : Object {
+    Template() : Object(Kind::Template) {}
+
+    ObjectPtr declaration;
+    std::vector<std::shared_ptr<TemplateParameter>> parameters;
+
+    bool merge(Object &other) override;
+
+    [[nodiscard]] ObjectPtr clone() const override;
+
+protected:
+    [[nodiscard]] bool fieldsEqual(const Object &other) const override;
+};
+
+} // namespace dwarf2cpp::models
+
+#endif // DWARF2CPP_MODELS_H
@@ -16,6 +16,14 @@ class Object:
     is_declaration: bool = False
     access: AccessAttribute | None = None
     template: "Template | None" = field(default=None, compare=False)
+    die_offset: int | None = field(default=None, compare=False)
+
+    @property
+    def qualified_name(self) -> str:
+        if self.parent is None:
+            return self.name or ""
+
+        return f"{self.parent.qualified_name}::{self.name}"
 
     def merge(self, other: "Object") -> bool:
         return False
@@ -57,7 +65,9 @@ class Attribute(Object):
     default_value: int | str | None = None
     alignment: int | None = None
     bit_size: int | None = None
+    offset: int | None = None
     is_static: bool = False
+    linkage_name: str | None = field(default=None, compare=False)
 
     def merge(self, other: Object) -> bool:
         if not isinstance(other, Attribute):
@@ -71,6 +81,8 @@ class Attribute(Object):
 
         self.alignment = self.alignment or other.alignment
         self.bit_size = self.bit_size or other.bit_size
+        self.offset = self.offset if self.offset is not None else other.offset
+        self.linkage_name = self.linkage_name or other.linkage_name
         self.is_static = self.is_static or other.is_static
         return True
 
@@ -100,6 +112,12 @@ class Function(Object):
     is_static: bool = False
     is_const: bool = False
     virtuality: VirtualityAttribute | None = None
+    linkage_name: str | None = field(default=None, compare=False)
+    # entry point of the definition, relative to the image base
+    address: int | None = field(default=None, compare=False)
+    # index of a virtual function in the vtable of containing_type
+    vtable_slot: int | None = field(default=None, compare=False)
+    containing_type: str | None = field(default=None, compare=False)
 
     def merge(self, other: Object) -> bool:
         if not isinstance(other, Function):
@@ -122,9 +140,39 @@ class Function(Object):
         self.is_static = self.is_static or other.is_static
         self.is_const = self.is_const or other.is_const
         self.virtuality = self.virtuality or other.virtuality
+        self.linkage_name = self.linkage_name or other.linkage_name
+        self.address = self.address or other.address
+        self.vtable_slot = self.vtable_slot if self.vtable_slot is not None else other.vtable_slot
+        self.containing_type = self.containing_type or other.containing_type
         return True
 
 
+@dataclass
+class LayoutMember:
+    """
+    A data member or base class subobject, as laid out in memory.
+    """
+
+    name: str
+    type: str
+    # offset from the start of the struct, in bits for bit fields and in bytes otherwise
+    offset: int
+    byte_size: int | None = None
+    bit_size: int | None = None
+    is_base: bool = False
+
+
+@dataclass
+class StructLayout:
+    """
+    The memory layout of a struct, including the subobjects that are not rendered (e.g., the vtable pointer).
+    """
+
+    byte_size: int
+    alignment: int | None = None
+    members: list[LayoutMember] = field(default_factory=list)
+
+
 @dataclass
 class Struct(Object):
     kind: ClassVar[str] = "struct"
@@ -132,6 +180,8 @@ class Struct(Object):
     bases: list[tuple[str, AccessAttribute | None]] = field(default_factory=list)
     members: dict[int, list[Object]] = field(default_factory=lambda: defaultdict(list))
     alignment: int | None = None
+    byte_size: int | None = None
+    layout: StructLayout | None = field(default=None, compare=False)
 
     def merge(self, other: Object) -> bool:
         if not isinstance(other, Struct):
@@ -158,6 +208,8 @@ class Struct(Object):
             self.members[lineno] = result
 
         self.alignment = self.alignment or other.alignment
+        self.byte_size = self.byte_size or other.byte_size
+        self.layout = self.layout or other.layout
         return True
 
 
@@ -275,3 +327,24 @@ class Template(Object):
             p1.default = p1.default or p2.default
 
         return True
+
+
+def type_name(ty: str | tuple[str, str] | Object | None) -> str | None:
+    if isinstance(ty, tuple):
+        return "".join(ty)
+
+    if isinstance(ty, Object):
+        return f"{ty.kind} {ty.name or '(anonymous)'}"
+
+    return ty
+
+
+def function_signature(function: Function) -> str:
+    params = []
+    for param in function.parameters:
+        if param.kind == ParameterKind.VARIADIC:
+            params.append("...")
+        elif param.name != "this":
+            params.append(type_name(param.type))
+
+    return f"({', '.join(params)}){' const' if function.is_const else ''}"
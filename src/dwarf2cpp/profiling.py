@@ -0,0 +1,276 @@
+import contextlib
+import enum
+import gc
+import json
+import os
+import sys
+import threading
+import time
+import tracemalloc
+from collections import Counter
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, ContextManager, Generator
+
+from . import models
+from ._dwarf import start_trace, stop_trace, trace_clock
+
+try:
+    import resource
+except ImportError:  # Windows
+    resource = None
+
+# phases of an extraction, in the order they happen
+PHASES = (
+    "context",
+    "type_units",
+    "line_tables",
+    "compile_units",
+    "param_sync",
+    "merge",
+    "render",
+    "cleanup",
+    "write",
+)
+
+
+@dataclass
+class Phase:
+    count: int = 0
+    seconds: float = 0.0
+
+
+class Profiler:
+    """Accumulate the time spent in each phase of an extraction."""
+
+    def __init__(self):
+        self.phases: dict[str, Phase] = {name: Phase() for name in PHASES}
+        self._start = time.perf_counter()
+
+    @contextlib.contextmanager
+    def span(self, name: str) -> Generator[None, None, None]:
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            phase = self.phases.setdefault(name, Phase())
+            phase.count += 1
+            phase.seconds += time.perf_counter() - start
+
+    def to_dict(self) -> dict:
+        return {
+            "wall_seconds": time.perf_counter() - self._start,
+            "phases": {name: {"count": phase.count, "seconds": phase.seconds} for name, phase in self.phases.items()},
+        }
+
+    def write(self, path: Path) -> None:
+        with path.open("w", encoding="utf-8") as f:
+            json.dump(self.to_dict(), f, indent=2)
+            f.write("\n")
+
+
+class Trace:
+    """
+    Record spans in the Chrome trace event format, which Perfetto and chrome://tracing open.
+
+    The spans of the native bindings are recorded along with the Python ones, each on the thread it ran on, and are
+    collected when the trace is written.
+    """
+
+    def __init__(self, path: Path):
+        self.path = path
+        self.events: list[dict[str, Any]] = []
+        self._pid = os.getpid()
+        self._threads: dict[int, str] = {}
+        self._start_ns = time.perf_counter_ns()
+        # the native spans are timed with another clock
+        self._native_offset_ns = self._start_ns - trace_clock()
+        start_trace()
+
+    @contextlib.contextmanager
+    def span(self, name: str, args: dict[str, Any]) -> Generator[None, None, None]:
+        thread_id = threading.get_native_id()
+        self._threads.setdefault(thread_id, threading.current_thread().name)
+        start = time.perf_counter_ns()
+        try:
+            yield
+        finally:
+            self._add(name, "python", start, time.perf_counter_ns() - start, thread_id, args)
+
+    def _add(
+        self, name: str, category: str, start_ns: int, duration_ns: int, thread_id: int, args: dict[str, Any]
+    ) -> None:
+        event = {
+            "name": name,
+            "cat": category,
+            "ph": "X",
+            "ts": (start_ns - self._start_ns) / 1000,
+            "dur": duration_ns / 1000,
+            "pid": self._pid,
+            "tid": thread_id,
+        }
+        if args:
+            event["args"] = args
+        self.events.append(event)
+
+    def write(self) -> None:
+        """Stop recording the native spans and write every span, in the order they started."""
+        for name, start_ns, duration_ns, thread_id, unit_offset in stop_trace():
+            args = {"unit_offset": unit_offset} if unit_offset is not None else {}
+            self._add(name, "native", start_ns + self._native_offset_ns, duration_ns, thread_id, args)
+
+        metadata = [{"name": "process_name", "ph": "M", "pid": self._pid, "args": {"name": "dwarf2cpp"}}]
+        for thread_id, thread_name in self._threads.items():
+            metadata.append(
+                {"name": "thread_name", "ph": "M", "pid": self._pid, "tid": thread_id, "args": {"name": thread_name}}
+            )
+
+        events = metadata + sorted(self.events, key=lambda event: event["ts"])
+        with self.path.open("w", encoding="utf-8") as f:
+            json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+            f.write("\n")
+
+
+class MemoryReport:
+    """
+    Record the memory used at the boundaries between the phases of an extraction: the resident set size of the
+    process, the Python heap, the number of live models by type, and the DIEs and line tables held by LLVM.
+
+    The report is written again after each snapshot, so that it is available even if the process runs out of memory.
+    """
+
+    def __init__(self, path: Path):
+        self.path = path
+        # context whose memory_stats are recorded once it is created
+        self.context = None
+        self.snapshots: list[dict[str, Any]] = []
+        self._start = time.perf_counter()
+
+    def snapshot(self, phase: str) -> None:
+        self.snapshots.append(
+            {
+                "phase": phase,
+                "seconds": time.perf_counter() - self._start,
+                "rss_bytes": current_rss(),
+                "peak_rss_bytes": peak_rss(),
+                "python": python_heap(),
+                "models": count_models(),
+                "llvm": self.context.memory_stats() if self.context is not None else None,
+            }
+        )
+        with self.path.open("w", encoding="utf-8") as f:
+            json.dump({"snapshots": self.snapshots}, f, indent=2)
+            f.write("\n")
+
+
+def current_rss() -> int | None:
+    try:
+        with open("/proc/self/statm", encoding="ascii") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except OSError:
+        return None
+
+
+def peak_rss() -> int | None:
+    if resource is None:
+        return None
+
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # in bytes on macOS and in kilobytes elsewhere
+    return peak if sys.platform == "darwin" else peak * 1024
+
+
+def python_heap() -> dict[str, int]:
+    """The number of blocks allocated by the interpreter, and their size and peak once tracemalloc is tracing."""
+    heap = {"allocated_blocks": sys.getallocatedblocks()}
+    if tracemalloc.is_tracing():
+        heap["traced_bytes"], heap["traced_peak_bytes"] = tracemalloc.get_traced_memory()
+    return heap
+
+
+def count_models() -> dict[str, int]:
+    """Count the live instances of each class of models.py. This walks every object tracked by the collector."""
+    counts = Counter(
+        type(obj).__name__
+        for obj in gc.get_objects()
+        if type(obj).__module__ == models.__name__ and not isinstance(obj, enum.Enum)
+    )
+    return dict(sorted(counts.items()))
+
+
+_profiler: Profiler | None = None
+_memory_report: MemoryReport | None = None
+# whether tracemalloc was started for the memory report, rather than by PYTHONTRACEMALLOC
+_started_tracemalloc = False
+_trace: Trace | None = None
+
+
+def enable() -> Profiler:
+    """Start profiling the phases of the extraction and return the profiler recording them."""
+    global _profiler
+    _profiler = Profiler()
+    return _profiler
+
+
+def enable_memory_report(path: Path) -> MemoryReport:
+    """
+    Start recording the memory used at each phase boundary to a JSON file and return the report.
+
+    This also starts tracing the Python allocations with tracemalloc, so that the size of the Python heap is known.
+    """
+    global _memory_report, _started_tracemalloc
+    if not tracemalloc.is_tracing():
+        tracemalloc.start()
+        _started_tracemalloc = True
+    _memory_report = MemoryReport(path)
+    return _memory_report
+
+
+def enable_trace(path: Path) -> Trace:
+    """Start recording the spans of the Python code and of the native bindings, and return the trace."""
+    global _trace
+    _trace = Trace(path)
+    return _trace
+
+
+def disable() -> None:
+    global _profiler, _memory_report, _trace, _started_tracemalloc
+    if _trace is not None:
+        stop_trace()
+    if _started_tracemalloc:
+        tracemalloc.stop()
+        _started_tracemalloc = False
+    _profiler = None
+    _memory_report = None
+    _trace = None
+
+
+def span(name: str, **args: Any) -> ContextManager[None]:
+    """
+    Time a phase with the active profiler and record it in the active trace along with the arguments. This does nothing
+    when neither is enabled.
+    """
+    if _trace is None:
+        return _profiler.span(name) if _profiler is not None else contextlib.nullcontext()
+
+    if _profiler is None:
+        return _trace.span(name, args)
+
+    stack = contextlib.ExitStack()
+    stack.enter_context(_profiler.span(name))
+    stack.enter_context(_trace.span(name, args))
+    return stack
+
+
+def trace_span(name: str, **args: Any) -> ContextManager[None]:
+    """Record a span that is not a phase of the timings in the active trace, this does nothing when none is enabled."""
+    if _trace is None:
+        return contextlib.nullcontext()
+
+    return _trace.span(name, args)
+
+
+def boundary(phase: str) -> None:
+    """Record the memory used once a phase is done, this does nothing when no memory report is enabled."""
+    if _memory_report is not None:
+        _memory_report.snapshot(phase)
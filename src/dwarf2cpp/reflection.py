@@ -0,0 +1,165 @@
+import logging
+from dataclasses import dataclass
+from pathlib import Path
+
+from .layout import iter_struct_layouts
+from .models import Object
+from .render import create_environment
+
+logger = logging.getLogger("dwarf2cpp")
+
+FNV_OFFSET_BASIS = 0xCBF29CE484222325
+FNV_PRIME = 0x100000001B3
+_MASK = (1 << 64) - 1
+
+# Average number of keys per bucket. Larger buckets take fewer seeds, but leave fewer free slots for the last
+# buckets to be placed, which quickly makes building slower.
+_BUCKET_SIZE = 1
+
+
+def fnv1a(key: bytes) -> int:
+    """64-bit FNV-1a hash, the same as the generated header computes."""
+    h = FNV_OFFSET_BASIS
+    for c in key:
+        h = ((h ^ c) * FNV_PRIME) & _MASK
+    return h
+
+
+def mix(h: int, seed: int) -> int:
+    """Scramble a hash with a seed, the same as the generated header does."""
+    h = (h ^ (seed * 0x9E3779B97F4A7C15)) & _MASK
+    h ^= h >> 33
+    h = (h * 0xFF51AFD7ED558CCD) & _MASK
+    h ^= h >> 33
+    return h
+
+
+@dataclass
+class PerfectHash:
+    """
+    Minimal perfect hash of a set of keys, built with hash and displace.
+
+    A key is hashed once with FNV-1a. The hash picks a bucket, and the seed of the bucket picks the slot of the key:
+    a negative seed is the slot itself, otherwise the slot is mix(hash, seed) % len(slots).
+    """
+
+    seeds: list[int]
+    # index of the key in each slot
+    slots: list[int]
+
+    @classmethod
+    def build(cls, keys: list[bytes]) -> "PerfectHash":
+        n = len(keys)
+        hashes = [fnv1a(key) for key in keys]
+        buckets: list[list[int]] = [[] for _ in range(max(n // _BUCKET_SIZE, 1))]
+        for i, h in enumerate(hashes):
+            buckets[h % len(buckets)].append(i)
+
+        seeds = [0] * len(buckets)
+        slots = [-1] * n
+        order = sorted(range(len(buckets)), key=lambda b: len(buckets[b]), reverse=True)
+
+        # place the largest buckets first, while most slots are still free
+        for b in order:
+            bucket = buckets[b]
+            if len(bucket) < 2:
+                break
+
+            seed = 1
+            while True:
+                candidates = {mix(hashes[i], seed) % n for i in bucket}
+                if len(candidates) == len(bucket) and all(slots[slot] < 0 for slot in candidates):
+                    break
+                seed += 1
+                if seed >= 1 << 31:
+                    raise ValueError("Failed to build a perfect hash, are there duplicate keys?")
+
+            seeds[b] = seed
+            for i in bucket:
+                slots[mix(hashes[i], seed) % n] = i
+
+        # buckets with a single key go straight into the remaining slots
+        free = (slot for slot in range(n) if slots[slot] < 0)
+        for b in order:
+            if len(buckets[b]) == 1:
+                slot = next(free)
+                seeds[b] = -slot - 1
+                slots[slot] = buckets[b][0]
+
+        return cls(seeds=seeds, slots=slots)
+
+
+@dataclass
+class ReflectedMember:
+    name: str
+    offset: int
+    byte_size: int
+    type: str
+    bit_offset: int = 0
+    bit_size: int = 0
+
+
+class ReflectionHeader:
+    """
+    Writer of a C++ header with a constexpr table of the offset, size and type of every data member, keyed by its
+    qualified name (e.g. "Actor::mPos") and looked up through a minimal perfect hash.
+
+    The table can only be built once every key is known, so the members are collected until close.
+    """
+
+    def __init__(self, path: Path, namespace: str = "dwarf2cpp::reflection"):
+        self._path = path
+        self._namespace = namespace
+        self._members: dict[str, ReflectedMember] = {}
+
+    def __enter__(self) -> "ReflectionHeader":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        # a failed extraction would leave a table missing members, don't even build its hash
+        if exc_type is None:
+            self.close()
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        for name, struct, _ in iter_struct_layouts(file):
+            for member in struct.layout.members:
+                if member.is_base or not member.name:
+                    continue
+
+                key = f"{name}::{member.name}"
+                if key in self._members:
+                    continue
+
+                reflected = ReflectedMember(
+                    name=key, offset=member.offset, byte_size=member.byte_size or 0, type=member.type
+                )
+                if member.bit_size is not None:
+                    reflected.offset = member.offset // 8
+                    reflected.bit_offset = member.offset % 8
+                    reflected.bit_size = member.bit_size
+                self._members[key] = reflected
+
+    def close(self) -> None:
+        members = [self._members[key] for key in sorted(self._members)]
+        logger.info(f"Building a perfect hash of {len(members)} members")
+        table = PerfectHash.build([member.name.encode() for member in members])
+        type_names = sorted({member.type for member in members})
+        type_ids = {name: i for i, name in enumerate(type_names)}
+
+        env = create_environment()
+        env.filters["cpp_string"] = cpp_string
+        content = env.get_template("reflection.jinja").render(
+            namespace=self._namespace,
+            fnv_offset_basis=FNV_OFFSET_BASIS,
+            fnv_prime=FNV_PRIME,
+            seeds=table.seeds,
+            members=[members[i] for i in table.slots],
+            type_names=type_names,
+            type_ids=type_ids,
+        )
+        self._path.parent.mkdir(parents=True, exist_ok=True)
+        self._path.write_text(content)
+
+
+def cpp_string(value: str) -> str:
+    return '"' + value.replace("\\", "\\\\").replace('"', '\\"') + '"'
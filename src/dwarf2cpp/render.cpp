@@ -0,0 +1,549 @@
+#include "render.h"
+
+#include <regex>
+#include <vector>
+
+namespace dwarf2cpp {
+namespace {
+    using namespace models;
+
+    // How jinja prints an optional string, e.g. the name of an unnamed enumerator.
+    std::string Str(const std::optional<std::string> &value) { return value.value_or("None"); }
+
+    bool Truthy(const std::optional<std::string> &value) { return value && !value->empty(); }
+
+    // The repr of a namespace, which the templates print when a using declaration has no name.
+    std::string Repr(const std::shared_ptr<Namespace> &ns) {
+        if (!ns) {
+            return "None";
+        }
+        std::string name = "None";
+        if (ns->name) {
+            char quote = ns->name->find('\'') != std::string::npos
+                                 && ns->name->find('"') == std::string::npos
+                             ? '"'
+                             : '\'';
+            name = quote + *ns->name + quote;
+        }
+        return "Namespace(name=" + name + ", parent=" + Repr(ns->parent)
+               + ", is_inline=" + (ns->is_inline ? "True" : "False") + ")";
+    }
+
+    const char *AccessName(llvm::dwarf::AccessAttribute access) {
+        switch (access) {
+            case llvm::dwarf::DW_ACCESS_protected:
+                return "protected";
+            case llvm::dwarf::DW_ACCESS_private:
+                return "private";
+            default:
+                return "public";
+        }
+    }
+
+    // filters.insert_name
+    std::string InsertName(const TypeName &type, const std::optional<std::string> &name) {
+        if (!Truthy(name)) {
+            return type.before + type.after;
+        }
+        if (!type.split) {
+            return type.before + " " + *name;
+        }
+        // do not add a space if pointer to (member) function
+        if (!type.before.empty() && type.before.back() == '*' && !type.after.empty()
+            && type.after.front() == ')') {
+            return type.before + *name + type.after;
+        }
+        return type.before + " " + *name + type.after;
+    }
+
+    // The indent filter of jinja with first=True: every non-empty line is indented.
+    std::string Indent(const std::string &content) {
+        std::string result = "    ";
+        size_t begin = 0;
+        while (begin < content.size()) {
+            auto end = content.find('\n', begin);
+            if (end == std::string::npos) {
+                end = content.size();
+            }
+            if (begin != 0) {
+                result += '\n';
+                if (end > begin) {
+                    result += "    ";
+                }
+            }
+            result.append(content, begin, end - begin);
+            begin = end + 1;
+        }
+        if (!content.empty() && content.back() == '\n') {
+            result += '\n';
+        }
+        return result;
+    }
+
+    void RenderObject(std::string &out, const Object &obj);
+
+    void RenderTemplate(std::string &out, const Template &obj) {
+        out += "template<";
+        for (size_t i = 0; i < obj.parameters.size(); ++i) {
+            const auto &parameter = *obj.parameters[i];
+            auto name = Truthy(parameter.name) ? " " + *parameter.name : "";
+            auto default_ = parameter.default_ ? " = " + *parameter.default_ : "";
+            switch (parameter.kind) {
+                case TemplateParameterKind::Type:
+                    out += "typename" + name + default_;
+                    break;
+                case TemplateParameterKind::Constant:
+                    out += Str(parameter.type) + name + default_;
+                    break;
+                case TemplateParameterKind::Pack:
+                    out += (Truthy(parameter.type) ? *parameter.type : "typename") + "..." + name;
+                    break;
+                case TemplateParameterKind::Template:
+                    out += "template<typename> class" + name + default_;
+                    break;
+            }
+            if (i + 1 != obj.parameters.size()) {
+                out += ", ";
+            }
+        }
+        out += ">";
+
+        if (obj.declaration) {
+            out += "\n";
+            RenderObject(out, *obj.declaration);
+        }
+    }
+
+    void RenderAttribute(std::string &out, const Attribute &obj) {
+        if (obj.template_) {
+            out += "template<>\n";
+        }
+        if (obj.is_static) {
+            out += "static ";
+        }
+        if (obj.alignment && *obj.alignment) {
+            out += "alignas(" + std::to_string(*obj.alignment) + ") ";
+        }
+        if (obj.type) {
+            out += InsertName(*obj.type, obj.name);
+        } else if (obj.inline_type) {
+            RenderObject(out, *obj.inline_type);
+            out += " " + Str(obj.name);
+        }
+        if (obj.bit_size) {
+            out += " : " + std::to_string(*obj.bit_size);
+        }
+        if (obj.default_value) {
+            out += " = " + *obj.default_value;
+        }
+    }
+
+    void RenderFunction(std::string &out, const Function &obj) {
+        if (obj.template_) {
+            RenderTemplate(out, *obj.template_);
+            out += "\n";
+        }
+
+        bool is_virtual = obj.virtuality && *obj.virtuality != llvm::dwarf::DW_VIRTUALITY_none;
+        if (obj.noreturn) {
+            out += "[[noreturn]] ";
+        }
+        if (is_virtual) {
+            out += "virtual ";
+        }
+        if (obj.is_explicit) {
+            out += "explicit ";
+        }
+        if (obj.is_inline) {
+            out += "inline ";
+        }
+        if (obj.is_static) {
+            out += "static ";
+        }
+        if (Truthy(obj.returns)) {
+            out += *obj.returns + " ";
+        }
+
+        out += Str(obj.name) + "(";
+        for (size_t i = 0; i < obj.parameters.size(); ++i) {
+            const auto &parameter = obj.parameters[i];
+            if (parameter.name == "this") {
+                continue;
+            }
+            if (parameter.kind == ParameterKind::Positional) {
+                out += InsertName(parameter.type, parameter.name);
+            } else {
+                out += "...";
+            }
+            if (i + 1 != obj.parameters.size()) {
+                out += ", ";
+            }
+        }
+        out += ")";
+
+        if (obj.is_const) {
+            out += " const";
+        }
+        if (is_virtual && *obj.virtuality == llvm::dwarf::DW_VIRTUALITY_pure_virtual) {
+            out += " = 0";
+        }
+        if (obj.is_deleted) {
+            out += " = delete";
+        }
+    }
+
+    // The objects of a line that are not implicit, joined by "; " and followed by ";\n".
+    void RenderLine(std::string &out, const std::vector<ObjectPtr> &objects) {
+        std::vector<const Object *> visible;
+        for (const auto &obj : objects) {
+            if (!obj->is_implicit) {
+                visible.push_back(obj.get());
+            }
+        }
+
+        for (size_t i = 0; i < visible.size(); ++i) {
+            const auto &obj = *visible[i];
+            if ((obj.template_ || obj.kind == Kind::Template) && i != 0) {
+                out += "\n";
+            }
+            RenderObject(out, obj);
+            out += i + 1 != visible.size() ? "; " : ";\n";
+        }
+    }
+
+    void RenderStruct(std::string &out, const Struct &obj) {
+        std::string access = obj.kind == Kind::Class ? "private" : "public";
+
+        if (obj.template_) {
+            out += "template<>\n";
+        }
+        out += KindName(obj.kind);
+        if (Truthy(obj.name)) {
+            out += " " + *obj.name;
+        }
+        if (obj.alignment && *obj.alignment) {
+            out += " alignas(" + std::to_string(*obj.alignment) + ")";
+        }
+        if (obj.is_declaration) {
+            return;
+        }
+
+        for (size_t i = 0; i < obj.bases.size(); ++i) {
+            const auto &[base, base_access] = obj.bases[i];
+            out += i == 0 ? " : " : "";
+            if (base_access) {
+                out += std::string(AccessName(*base_access)) + " ";
+            }
+            out += base;
+            out += i + 1 != obj.bases.size() ? ", " : "";
+        }
+        out += " {\n";
+
+        bool first = true;
+        for (const auto &[line, members] : obj.members) {
+            if (!members.empty()) {
+                std::string member_access = AccessName(
+                    members.front()->access.value_or(llvm::dwarf::DW_ACCESS_public));
+                if (member_access != access) {
+                    if (!first) {
+                        out += "\n";
+                    }
+                    out += member_access + ":\n";
+                    access = member_access;
+                }
+            }
+
+            std::string content;
+            RenderLine(content, members);
+            if (!content.empty()) {
+                out += Indent(content);
+            }
+            first = false;
+        }
+        out += "}";
+    }
+
+    void RenderEnum(std::string &out, const Enum &obj) {
+        out += "enum";
+        if (obj.is_class) {
+            out += " class";
+        }
+        if (Truthy(obj.name)) {
+            out += " " + *obj.name;
+        }
+        if (Truthy(obj.base)) {
+            out += " : " + *obj.base;
+        }
+        out += " {\n";
+        for (size_t i = 0; i < obj.values.size(); ++i) {
+            const auto &[name, value] = obj.values[i];
+            out += Indent(Str(name) + " = " + value + (i + 1 != obj.values.size() ? ",\n" : ","));
+        }
+        out += "\n}";
+    }
+
+    void RenderTypeDef(std::string &out, const TypeDef &obj) {
+        std::string alignment;
+        if (obj.alignment && *obj.alignment) {
+            alignment = " alignas(" + std::to_string(*obj.alignment) + ")";
+        }
+
+        if (!obj.value_type) {
+            out += "using " + Str(obj.name) + alignment + " = "
+                   + (Truthy(obj.value) ? *obj.value : "void");
+            return;
+        }
+
+        out += "typedef ";
+        RenderObject(out, *obj.value_type);
+        out += " " + Str(obj.name) + alignment;
+    }
+
+    void RenderImportedDeclaration(std::string &out, const ImportedDeclaration &obj) {
+        if (Truthy(obj.name)) {
+            out += "namespace " + *obj.name + " = ";
+            if (obj.import_namespace) {
+                out += obj.import_namespace->qualifiedName();
+            }
+        } else if (obj.import_namespace) {
+            out += "using " + Repr(obj.import_namespace);
+        } else if (Truthy(obj.import_type)) {
+            out += "using " + *obj.import_type;
+        }
+    }
+
+    void RenderObject(std::string &out, const Object &obj) {
+        switch (obj.kind) {
+            case Kind::ImportedModule:
+                out += "using namespace "
+                       + static_cast<const ImportedModule &>(obj).import_->qualifiedName();
+                break;
+            case Kind::ImportedDeclaration:
+                RenderImportedDeclaration(out, static_cast<const ImportedDeclaration &>(obj));
+                break;
+            case Kind::Attribute:
+                RenderAttribute(out, static_cast<const Attribute &>(obj));
+                break;
+            case Kind::Function:
+                RenderFunction(out, static_cast<const Function &>(obj));
+                break;
+            case Kind::Struct:
+            case Kind::Class:
+            case Kind::Union:
+                RenderStruct(out, static_cast<const Struct &>(obj));
+                break;
+            case Kind::Enum:
+                RenderEnum(out, static_cast<const Enum &>(obj));
+                break;
+            case Kind::TypeDef:
+                RenderTypeDef(out, static_cast<const TypeDef &>(obj));
+                break;
+            case Kind::Template:
+                RenderTemplate(out, static_cast<const Template &>(obj));
+                break;
+        }
+    }
+
+    using Chain = std::vector<const Namespace *>;
+
+    // filters.ns_chain
+    Chain NamespaceChain(const Namespace *ns) {
+        Chain chain;
+        for (; ns != nullptr; ns = ns->parent.get()) {
+            chain.insert(chain.begin(), ns);
+        }
+        return chain;
+    }
+
+    // filters.ns_actions, rendered
+    void RenderNamespaceActions(std::string &out, const Chain &prev, const Chain &curr) {
+        size_t i = 0;
+        while (i < prev.size() && i < curr.size() && prev[i]->name == curr[i]->name
+               && prev[i]->is_inline == curr[i]->is_inline) {
+            ++i;
+        }
+
+        for (size_t j = prev.size(); j > i; --j) {
+            out += "} // namespace "
+                   + (Truthy(prev[j - 1]->name) ? *prev[j - 1]->name : "anonymous") + "\n";
+        }
+
+        for (size_t j = i; j < curr.size(); ++j) {
+            if (Truthy(curr[j]->name)) {
+                out += std::string(curr[j]->is_inline ? "inline namespace " : "namespace ")
+                       + *curr[j]->name + " {\n";
+            } else {
+                out += "namespace {\n";
+            }
+        }
+    }
+
+    struct Pattern {
+        // literal that every match contains, to skip the lines that cannot match
+        const char *literal;
+        std::regex regex;
+        const char *replacement;
+    };
+
+    const std::vector<Pattern> &Patterns() {
+        static const auto flags = std::regex::ECMAScript | std::regex::optimize;
+        static const std::vector<Pattern> patterns = {
+            // std::unique_ptr
+            {"std::unique_ptr<",
+             std::regex(R"(std::unique_ptr<(.+?),\s*std::default_delete<\1\s*>\s*>)", flags),
+             "std::unique_ptr<$1>"},
+            // std::vector
+            {"std::vector<",
+             std::regex(R"(std::vector<(.+?),\s*std::allocator<\1\s*>\s*>)", flags),
+             "std::vector<$1>"},
+            // std::list
+            {"std::list<",
+             std::regex(R"(std::list<(.+?),\s*std::allocator<\1\s*>\s*>)", flags),
+             "std::list<$1>"},
+            // std::deque
+            {"std::deque<",
+             std::regex(R"(std::deque<(.+?),\s*std::allocator<\1\s*>\s*>)", flags),
+             "std::deque<$1>"},
+            // std::queue
+            {"std::queue<",
+             std::regex(R"(std::queue<(.+?),\s*std::deque<\1\s*>\s*>)", flags),
+             "std::queue<$1>"},
+            // std::unordered_map
+            {"std::unordered_map<",
+             std::regex(R"(std::unordered_map<(.+?),\s*(.+?),\s*)"
+                        R"(std::hash<\1\s*>,\s*)"
+                        R"(std::equal_to<\1\s*>,\s*)"
+                        R"(std::allocator<std::pair<(?:const\s*\1|\1\s*const),\s*\2\s*>\s*>\s*>)",
+                        flags),
+             "std::unordered_map<$1, $2>"},
+            // std::unordered_set
+            {"std::unordered_set<",
+             std::regex(R"(std::unordered_set<(.+?),\s*std::hash<\1\s*>,\s*)"
+                        R"(std::equal_to<\1\s*>,\s*std::allocator<\1\s*>\s*>)",
+                        flags),
+             "std::unordered_set<$1>"},
+            // std::map
+            {"std::map<",
+             std::regex(R"(std::map<(.+?),\s*(.+?),\s*std::less<\1\s*>,\s*)"
+                        R"(std::allocator<std::pair<(?:const\s*\1|\1\s*const),\s*\2\s*>\s*>\s*>)",
+                        flags),
+             "std::map<$1, $2>"},
+            // std::set
+            {"std::set<",
+             std::regex(R"(std::set<(.+?),\s*std::less<\1\s*>,\s*std::allocator<\1\s*>\s*>)",
+                        flags),
+             "std::set<$1>"},
+            // gsl::span
+            {"gsl::span<", std::regex(R"(gsl::span<(.+),\s*\d+UL>)", flags), "gsl::span<$1>"},
+            // glm::vec
+            {"glm::vec<",
+             std::regex(R"(glm::vec<(\d),\s*float,\s*\(glm::qualifier\)0>)", flags),
+             "glm::vec$1"},
+            {"glm::vec<",
+             std::regex(R"(glm::vec<(\d),\s*int,\s*\(glm::qualifier\)0>)", flags),
+             "glm::ivec$1"},
+            // glm::mat
+            {"glm::mat<",
+             std::regex(R"(glm::mat<(\d),\s*(\d),\s*float,\s*\(glm::qualifier\)0>)", flags),
+             "glm::mat$1x$2"},
+            // Bedrock::Result
+            {"Bedrock::Result<",
+             std::regex(R"(Bedrock::Result<(.+?),\s*std::error_code>)", flags),
+             "Bedrock::Result<$1>"},
+        };
+        return patterns;
+    }
+
+    void ReplaceAll(std::string &content, const std::string &from, const std::string &to) {
+        std::string result;
+        size_t begin = 0;
+        for (auto pos = content.find(from); pos != std::string::npos;
+             pos = content.find(from, begin)) {
+            result.append(content, begin, pos - begin);
+            result += to;
+            begin = pos + from.size();
+        }
+        if (begin != 0) {
+            result.append(content, begin, std::string::npos);
+            content = std::move(result);
+        }
+    }
+
+    // The patterns never match across lines, so each line is rewritten on its own until it no
+    // longer changes, which spares the lines without any candidate from the regular expressions.
+    std::string CleanupLine(std::string line) {
+        const auto &patterns = Patterns();
+        while (true) {
+            auto output = line;
+            for (const auto &pattern : patterns) {
+                if (output.find(pattern.literal) != std::string::npos) {
+                    output = std::regex_replace(output, pattern.regex, pattern.replacement);
+                }
+            }
+
+            if (output == line) {
+                return line;
+            }
+            line = std::move(output);
+        }
+    }
+} // namespace
+
+std::string RenderFile(const models::File &file) {
+    std::string out;
+    Chain prev;
+    for (const auto &[line, objects] : file) {
+        std::vector<const Object *> visible;
+        for (const auto &obj : objects) {
+            if (!obj->is_implicit) {
+                visible.push_back(obj.get());
+            }
+        }
+
+        for (size_t i = 0; i < visible.size(); ++i) {
+            const auto &obj = *visible[i];
+            auto curr = NamespaceChain(obj.parent.get());
+            RenderNamespaceActions(out, prev, curr);
+            if ((obj.template_ || obj.kind == Kind::Template) && i != 0) {
+                out += "\n";
+            }
+            RenderObject(out, obj);
+            out += i + 1 != visible.size() ? "; " : ";\n";
+            prev = std::move(curr);
+        }
+    }
+    RenderNamespaceActions(out, prev, {});
+    return Cleanup(std::move(out));
+}
+
+std::string Cleanup(std::string content) {
+    ReplaceAll(content, "std::__1::", "std::");
+    ReplaceAll(content, "std::__ndk1::", "std::");
+    ReplaceAll(content,
+               "std::basic_string<char, std::char_traits<char>, std::allocator<char> >",
+               "std::string");
+    ReplaceAll(
+        content, "std::basic_string_view<char, std::char_traits<char> >", "std::string_view");
+    ReplaceAll(content,
+               "std::chrono::time_point<std::chrono::steady_clock, std::chrono::duration<long "
+               "long, std::ratio<1L, 1000000000L> > >",
+               "std::chrono::steady_clock::time_point");
+
+    std::string result;
+    result.reserve(content.size());
+    size_t begin = 0;
+    while (begin < content.size()) {
+        auto end = content.find('\n', begin);
+        if (end == std::string::npos) {
+            end = content.size();
+        }
+        result += CleanupLine(content.substr(begin, end - begin));
+        if (end < content.size()) {
+            result += '\n';
+        }
+        begin = end + 1;
+    }
+    return result;
+}
+
+} // namespace dwarf2cpp
@@ -0,0 +1,19 @@
+#ifndef DWARF2CPP_RENDER_H
+#define DWARF2CPP_RENDER_H
+
+#include "models.h"
+
+#include <string>
+
+namespace dwarf2cpp {
+
+// Render the objects of a file the way render_file in render.py does with the templates, followed
+// by the same cleanup. Both must be kept in sync with the templates and post_process.py.
+std::string RenderFile(const models::File &file);
+
+// Shorten the names of standard library types, as cleanup in post_process.py.
+std::string Cleanup(std::string content);
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_RENDER_H
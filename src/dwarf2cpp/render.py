@@ -0,0 +1,28 @@
+from pathlib import Path
+
+from jinja2 import Environment, FileSystemLoader
+
+from . import profiling
+from .filters import do_insert_name, do_ns_actions, do_ns_chain
+from .models import Object
+from .post_process import cleanup
+
+
+def create_environment() -> Environment:
+    template_dir = Path(__file__).parent / "templates"
+    env = Environment(loader=FileSystemLoader(template_dir), keep_trailing_newline=True)
+    env.filters["ns_chain"] = do_ns_chain
+    env.filters["ns_actions"] = do_ns_actions
+    env.filters["insert_name"] = do_insert_name
+    return env
+
+
+def render_file(env: Environment, file: dict[int, list[Object]]) -> str:
+    with profiling.span("render"):
+        content = env.get_template("file.jinja").render(file=file)
+    with profiling.span("cleanup"):
+        return cleanup(content)
+
+
+def render_object(env: Environment, obj: Object) -> str:
+    return cleanup(env.get_template(f"{obj.kind}.jinja").render(obj=obj))
@@ -0,0 +1,209 @@
+"""
+Serialization of the models to zlib-compressed JSON.
+
+Unlike pickle, loading only ever creates the models and the enums listed below, so that caches, IR files and
+checkpoints shared between users cannot run code. Objects referenced more than once, or in cycles (e.g., a template
+and its declaration), are stored once in a table and referenced by their index, so that they are shared again when
+loaded.
+
+Values are encoded as JSON values, with objects tagging the types JSON has no notation for:
+
+- `{"t": [...]}` a tuple, `{"s": [...]}` a set and `{"d": [[key, value], ...]}` a dict, whose keys can be of any type
+- `{"e": name, "v": value}` a member of an enum
+- `{"r": index}` a model, whose entry in the table is the index of its class followed by the values of its fields
+
+The field names of each class are stored along with the table, so that a change to the models is detected.
+"""
+
+import dataclasses
+import enum
+import json
+import zlib
+from typing import Any
+
+from ._dwarf import AccessAttribute, VirtualityAttribute
+from .models import (
+    Attribute,
+    Class,
+    Enum,
+    Function,
+    ImportedDeclaration,
+    ImportedModule,
+    LayoutMember,
+    Namespace,
+    Parameter,
+    ParameterKind,
+    Struct,
+    StructLayout,
+    Template,
+    TemplateParameter,
+    TemplateParameterKind,
+    TypeDef,
+    Union,
+)
+
+# Bump this whenever the encoding or the fields of the models change.
+SCHEMA_VERSION = 1
+
+_CLASSES: dict[str, type] = {
+    cls.__name__: cls
+    for cls in (
+        Attribute,
+        Class,
+        Enum,
+        Function,
+        ImportedDeclaration,
+        ImportedModule,
+        LayoutMember,
+        Namespace,
+        Parameter,
+        Struct,
+        StructLayout,
+        Template,
+        TemplateParameter,
+        TypeDef,
+        Union,
+    )
+}
+
+_SCALARS = {str, int, float, bool, type(None)}
+
+_ENUMS: dict[str, type[enum.Enum]] = {
+    cls.__name__: cls for cls in (AccessAttribute, VirtualityAttribute, ParameterKind, TemplateParameterKind)
+}
+
+
+class _Encoder:
+    def __init__(self):
+        # class names and their field names, in the order of the values of the table entries
+        self.classes: list[tuple[str, list[str]]] = []
+        self.table: list[list[Any] | None] = []
+        self._class_indices: dict[type, int] = {}
+        self._indices: dict[int, int] = {}
+        self._pending: list[Any] = []
+
+    def encode_root(self, value: Any) -> Any:
+        result = self.encode(value)
+        # the fields of the models are encoded after their reference, so that long chains of references (e.g.,
+        # parents) do not recurse
+        while self._pending:
+            obj = self._pending.pop()
+            class_index = self._class_indices[type(obj)]
+            entry = [class_index] + [self.encode(getattr(obj, name)) for name in self.classes[class_index][1]]
+            self.table[self._indices[id(obj)]] = entry
+
+        return result
+
+    def encode(self, value: Any) -> Any:
+        cls = type(value)
+        if cls in _SCALARS:
+            return value
+        if cls is list:
+            return [self.encode(item) for item in value]
+        if cls is tuple:
+            return {"t": [self.encode(item) for item in value]}
+        if isinstance(value, dict):
+            return {"d": [[self.encode(key), self.encode(item)] for key, item in value.items()]}
+        if isinstance(value, enum.Enum):
+            if _ENUMS.get(cls.__name__) is not cls:
+                raise TypeError(f"Cannot serialize enum {cls.__name__}")
+            return {"e": cls.__name__, "v": value.value}
+        if cls is set or cls is frozenset:
+            return {"s": [self.encode(item) for item in value]}
+
+        index = self._indices.get(id(value))
+        if index is None:
+            if cls not in self._class_indices:
+                if _CLASSES.get(cls.__name__) is not cls:
+                    raise TypeError(f"Cannot serialize {cls.__name__}")
+                self._class_indices[cls] = len(self.classes)
+                self.classes.append((cls.__name__, [f.name for f in dataclasses.fields(cls)]))
+
+            index = self._indices[id(value)] = len(self.table)
+            self.table.append(None)
+            self._pending.append(value)
+
+        return {"r": index}
+
+
+class _Decoder:
+    def __init__(self, classes: list[list[Any]], table: list[list[Any]]):
+        self.classes = []
+        for name, field_names in classes:
+            cls = _CLASSES.get(name)
+            if cls is None:
+                raise ValueError(f"Unknown class {name}")
+
+            fields = {f.name: f for f in dataclasses.fields(cls)}
+            if sorted(field_names) != sorted(fields):
+                raise ValueError(f"Fields of {name} do not match the models")
+            self.classes.append((cls, [fields[name] for name in field_names]))
+
+        self.table = table
+        self.objects = [self.classes[entry[0]][0].__new__(self.classes[entry[0]][0]) for entry in table]
+
+    def decode_root(self, value: Any) -> Any:
+        for obj, entry in zip(self.objects, self.table):
+            fields = self.classes[entry[0]][1]
+            if len(entry) != len(fields) + 1:
+                raise ValueError(f"Malformed {type(obj).__name__}")
+
+            for f, item in zip(fields, entry[1:]):
+                item = self.decode(item)
+                if isinstance(item, dict) and f.default_factory is not dataclasses.MISSING:
+                    # e.g., the defaultdict of the members of a struct
+                    default = f.default_factory()
+                    default.update(item)
+                    item = default
+                setattr(obj, f.name, item)
+
+        return self.decode(value)
+
+    def decode(self, value: Any) -> Any:
+        cls = type(value)
+        if cls is list:
+            return [self.decode(item) for item in value]
+        if cls is not dict:
+            return value
+
+        if "r" in value:
+            return self.objects[value["r"]]
+        if "t" in value:
+            return tuple(self.decode(item) for item in value["t"])
+        if "s" in value:
+            return {self.decode(item) for item in value["s"]}
+        if "d" in value:
+            return {self.decode(key): self.decode(item) for key, item in value["d"]}
+        if "e" in value:
+            cls = _ENUMS.get(value["e"])
+            if cls is None:
+                raise ValueError(f"Unknown enum {value['e']}")
+            return cls(value["v"])
+
+        raise ValueError(f"Unknown value {value}")
+
+
+def dumps(value: Any) -> bytes:
+    """Serialize a value made of models, enums, builtin containers and scalars."""
+    encoder = _Encoder()
+    root = encoder.encode_root(value)
+    data = {"version": SCHEMA_VERSION, "classes": encoder.classes, "table": encoder.table, "value": root}
+    return zlib.compress(json.dumps(data, separators=(",", ":")).encode())
+
+
+def loads(data: bytes) -> Any:
+    """
+    Deserialize a value serialized by dumps.
+
+    Raises:
+        ValueError: if the data is malformed or was serialized with another version of the schema
+    """
+    try:
+        data = json.loads(zlib.decompress(data))
+        version = data["version"]
+        if version != SCHEMA_VERSION:
+            raise ValueError(f"Unsupported schema version {version}, expected {SCHEMA_VERSION}")
+
+        return _Decoder(data["classes"], data["table"]).decode_root(data["value"])
+    except (zlib.error, UnicodeDecodeError, KeyError, IndexError, TypeError, AttributeError) as e:
+        raise ValueError(f"Malformed serialized data: {e}") from e
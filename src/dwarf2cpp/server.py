@@ -0,0 +1,327 @@
+import asyncio
+import inspect
+import json
+import logging
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Any, Callable
+
+from ._dwarf import DWARFContext, DWARFIndex, DWARFIndexEntry
+from .models import Attribute, Enum, Function, Object, Struct, TypeDef, type_name
+from .render import create_environment, render_object
+from .visitor import Visitor
+
+logger = logging.getLogger("dwarf2cpp")
+
+_SCOPE_TAGS = {
+    "DW_TAG_namespace",
+    "DW_TAG_class_type",
+    "DW_TAG_structure_type",
+    "DW_TAG_union_type",
+    "DW_TAG_enumeration_type",
+}
+_TYPE_TAGS = {
+    "DW_TAG_class_type",
+    "DW_TAG_structure_type",
+    "DW_TAG_union_type",
+    "DW_TAG_enumeration_type",
+    "DW_TAG_typedef",
+}
+
+# JSON-RPC 2.0 error codes
+PARSE_ERROR = -32700
+INVALID_REQUEST = -32600
+METHOD_NOT_FOUND = -32601
+INVALID_PARAMS = -32602
+INTERNAL_ERROR = -32603
+NOT_FOUND = -32000
+
+
+class RPCError(Exception):
+    def __init__(self, code: int, message: str):
+        super().__init__(message)
+        self.code = code
+
+
+def split_qualified_name(name: str) -> list[str]:
+    """Split a qualified name on the scope operators that are not inside template arguments."""
+    parts = []
+    depth = 0
+    start = 0
+    i = 0
+    while i < len(name):
+        c = name[i]
+        if c in "<(":
+            depth += 1
+        elif c in ">)":
+            depth -= 1
+        elif depth == 0 and name.startswith("::", i):
+            parts.append(name[start:i])
+            start = i + 2
+            i += 1
+        i += 1
+
+    parts.append(name[start:])
+    return parts
+
+
+def entry_scopes(entry: DWARFIndexEntry) -> list[str]:
+    """Names of the namespaces and types enclosing an index entry, from the outermost."""
+    scopes = []
+    parent = entry.parent
+    while parent is not None and parent.tag in _SCOPE_TAGS:
+        scopes.append(parent.short_name or "(anonymous namespace)")
+        parent = parent.parent
+
+    return scopes[::-1]
+
+
+def find_entries(index: DWARFIndex, name: str) -> list[DWARFIndexEntry]:
+    """Find the entries of an index with the given qualified name."""
+    parts = split_qualified_name(name)
+    return [entry for entry in index.lookup(parts[-1]) if entry_scopes(entry) == parts[:-1]]
+
+
+class QueryEngine:
+    """
+    Answers queries about the declarations of a binary.
+
+    Names are resolved with a DIE index, and the matching DIEs are only visited on demand. The visitor and its type
+    name cache stay resident between queries, so that repeated queries about related types are cheap.
+    """
+
+    def __init__(self, context: DWARFContext, index: DWARFIndex):
+        self.context = context
+        self.index = index
+        self._visitor = Visitor(context, "")
+        self._env = create_environment()
+        # neither the visitor nor the DWARF context can be used from several threads at once
+        self._lock = threading.Lock()
+        self.methods: dict[str, Callable[..., Any]] = {
+            "lookup": self.lookup,
+            "layout": self.layout,
+            "signature": self.signature,
+            "members": self.members,
+        }
+
+    def lookup(self, name: str) -> list[dict[str, Any]]:
+        """Find the DIEs with the given qualified name, only using the index."""
+        return [self._describe(entry) for entry in self._find(name)]
+
+    def layout(self, name: str) -> dict[str, Any]:
+        """Describe the size, alignment, bases and data members of a struct, class or union."""
+        struct = self._definition(name)
+        if not isinstance(struct, Struct):
+            raise RPCError(NOT_FOUND, f"{name} is not a struct, class or union")
+
+        members = []
+        for _, objects in sorted(struct.members.items()):
+            for member in objects:
+                if isinstance(member, Attribute):
+                    members.append(
+                        {
+                            "name": member.name,
+                            "type": type_name(member.type),
+                            "offset": member.offset,
+                            "bit_size": member.bit_size,
+                            "is_static": member.is_static,
+                        }
+                    )
+
+        return {
+            "name": name,
+            "kind": struct.kind,
+            "byte_size": struct.byte_size,
+            "alignment": struct.alignment,
+            "bases": [base for base, _ in struct.bases],
+            "members": members,
+        }
+
+    def signature(self, name: str) -> list[dict[str, Any]]:
+        """Render the declaration of every overload of a function."""
+        entries = [entry for entry in self._find(name) if entry.tag == "DW_TAG_subprogram"]
+        if not entries:
+            raise RPCError(NOT_FOUND, f"No function named {name}")
+
+        result = {}
+        with self._lock:
+            for entry in entries:
+                function = self._model(entry)
+                if not isinstance(function, Function):
+                    continue
+
+                signature = render_object(self._env, function)
+                if signature not in result:
+                    result[signature] = {
+                        "signature": signature,
+                        "linkage_name": function.linkage_name,
+                        **self._location(entry),
+                    }
+
+        return list(result.values())
+
+    def members(self, name: str) -> list[dict[str, Any]]:
+        """List the members of a namespace, struct, class, union or enum."""
+        entries = [entry for entry in self._find(name) if entry.tag in _SCOPE_TAGS]
+        if not entries:
+            raise RPCError(NOT_FOUND, f"No namespace or type named {name}")
+
+        if entries[0].tag == "DW_TAG_namespace":
+            # namespaces are split across compile units
+            result = {}
+            for entry in entries:
+                for child in self.index.children(entry):
+                    if child.short_name and (child.tag, child.short_name) not in result:
+                        result[child.tag, child.short_name] = self._describe(child)
+            return list(result.values())
+
+        obj = self._definition(name)
+        if isinstance(obj, Enum):
+            return [{"kind": "enumerator", "name": n, "value": v} for n, v in obj.values]
+
+        return [
+            {"kind": member.kind, "name": member.name, "line": line}
+            for line, objects in sorted(obj.members.items())
+            for member in objects
+            if not member.is_implicit
+        ]
+
+    def _find(self, name: str) -> list[DWARFIndexEntry]:
+        return find_entries(self.index, name)
+
+    def _definition(self, name: str) -> Struct | Enum:
+        entries = [entry for entry in self._find(name) if entry.tag in _TYPE_TAGS]
+        with self._lock:
+            for entry in entries:
+                obj = self._model(entry)
+                if isinstance(obj, TypeDef):
+                    # typedef struct { ... } name;
+                    obj = obj.value
+
+                if isinstance(obj, (Struct, Enum)) and not obj.is_declaration:
+                    return obj
+
+        raise RPCError(NOT_FOUND, f"No definition of {name}")
+
+    def _model(self, entry: DWARFIndexEntry) -> Object | None:
+        die = self.context.die_at(entry.offset, entry.types_section)
+        return self._visitor.model(die) if die else None
+
+    @staticmethod
+    def _location(entry: DWARFIndexEntry) -> dict[str, Any]:
+        return {"decl_file": entry.decl_file, "decl_line": entry.decl_line}
+
+    def _describe(self, entry: DWARFIndexEntry) -> dict[str, Any]:
+        return {
+            "name": entry.short_name,
+            "qualified_name": "::".join([*entry_scopes(entry), entry.short_name or ""]),
+            "tag": entry.tag,
+            "offset": entry.offset,
+            "types_section": entry.types_section,
+            **self._location(entry),
+        }
+
+
+def open_index(context: DWARFContext, path: Path, index_path: Path | None) -> DWARFIndex:
+    """Open the DIE index of a binary, building it first if it is missing or stale."""
+    index_path = index_path or path.with_name(path.name + ".dieidx")
+    if index_path.is_file():
+        index = DWARFIndex(str(index_path))
+        if index.matches(str(path)):
+            return index
+
+        logger.info(f"{index_path} is stale")
+
+    logger.info(f"Building DIE index {index_path}")
+    context.write_index(str(index_path))
+    return DWARFIndex(str(index_path))
+
+
+class Server:
+    """
+    JSON-RPC 2.0 server, reading one request per line and writing one response per line.
+
+    Requests are handled concurrently in a thread pool, so responses may be written in a different order than the
+    requests were read.
+    """
+
+    def __init__(self, engine: QueryEngine, workers: int = 4):
+        self._engine = engine
+        self._executor = ThreadPoolExecutor(max_workers=workers)
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        tasks = set()
+        try:
+            while line := await reader.readline():
+                if not line.strip():
+                    continue
+
+                task = asyncio.create_task(self._respond(line, writer))
+                tasks.add(task)
+                task.add_done_callback(tasks.discard)
+
+            await asyncio.gather(*tasks)
+        finally:
+            writer.close()
+
+    async def _respond(self, line: bytes, writer: asyncio.StreamWriter) -> None:
+        response = await self._dispatch(line)
+        if response is not None:
+            writer.write(json.dumps(response).encode() + b"\n")
+            await writer.drain()
+
+    async def _dispatch(self, line: bytes) -> dict[str, Any] | None:
+        try:
+            request = json.loads(line)
+        except json.JSONDecodeError as e:
+            return _error(None, PARSE_ERROR, f"Parse error: {e}")
+
+        if not isinstance(request, dict) or request.get("jsonrpc") != "2.0" or "method" not in request:
+            return _error(request.get("id") if isinstance(request, dict) else None, INVALID_REQUEST, "Invalid request")
+
+        request_id = request.get("id")
+        method = self._engine.methods.get(request["method"])
+        if method is None:
+            return _error(request_id, METHOD_NOT_FOUND, f"Method not found: {request['method']}")
+
+        params = request.get("params", [])
+        try:
+            bound = inspect.signature(method).bind(*params) if isinstance(params, list) else None
+            bound = bound or inspect.signature(method).bind(**params)
+        except TypeError as e:
+            return _error(request_id, INVALID_PARAMS, f"Invalid params: {e}")
+
+        loop = asyncio.get_running_loop()
+        try:
+            result = await loop.run_in_executor(self._executor, lambda: method(*bound.args, **bound.kwargs))
+            response = {"jsonrpc": "2.0", "id": request_id, "result": result}
+        except RPCError as e:
+            response = _error(request_id, e.code, str(e))
+        except Exception as e:
+            logger.exception(f"Failed to handle {request['method']}")
+            response = _error(request_id, INTERNAL_ERROR, str(e))
+
+        # notifications have no id and get no response
+        return response if "id" in request else None
+
+    async def serve_unix(self, path: Path) -> None:
+        path.unlink(missing_ok=True)
+        server = await asyncio.start_unix_server(self.handle, path=str(path))
+        logger.info(f"Listening on {path}")
+        async with server:
+            await server.serve_forever()
+
+    async def serve_stdio(self) -> None:
+        loop = asyncio.get_running_loop()
+        reader = asyncio.StreamReader()
+        await loop.connect_read_pipe(lambda: asyncio.StreamReaderProtocol(reader), sys.stdin)
+        transport, protocol = await loop.connect_write_pipe(asyncio.streams.FlowControlMixin, sys.stdout)
+        writer = asyncio.StreamWriter(transport, protocol, reader, loop)
+        logger.info("Listening on stdio")
+        await self.handle(reader, writer)
+
+
+def _error(request_id: Any, code: int, message: str) -> dict[str, Any]:
+    return {"jsonrpc": "2.0", "id": request_id, "error": {"code": code, "message": message}}
@@ -0,0 +1,831 @@
+import bisect
+import hashlib
+import re
+import string
+import struct
+import zlib
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Iterable, Iterator
+
+# ELF
+_ET_REL = 1
+_SHT_PROGBITS = 1
+_SHT_STRTAB = 3
+_SHT_NOBITS = 8
+_SHF_COMPRESSED = 0x800
+_ELFCOMPRESS_ZLIB = 1
+
+# DWARF
+_DW_UT_compile = 1
+_DW_UT_type = 2
+_DW_UT_split_compile = 5
+_DW_UT_skeleton = 4
+_DW_UT_split_type = 6
+
+_DW_TAG_class_type = 0x02
+_DW_TAG_enumeration_type = 0x04
+_DW_TAG_compile_unit = 0x11
+_DW_TAG_structure_type = 0x13
+_DW_TAG_typedef = 0x16
+_DW_TAG_union_type = 0x17
+_DW_TAG_partial_unit = 0x3C
+_DW_TAG_type_unit = 0x41
+_DW_TAG_skeleton_unit = 0x4A
+
+_DW_AT_name = 0x03
+_DW_AT_stmt_list = 0x10
+_DW_AT_comp_dir = 0x1B
+_DW_AT_producer = 0x25
+_DW_AT_declaration = 0x3C
+_DW_AT_linkage_name = 0x6E
+_DW_AT_str_offsets_base = 0x72
+_DW_AT_dwo_name = 0x76
+_DW_AT_MIPS_linkage_name = 0x2007
+_DW_AT_GNU_dwo_name = 0x2130
+
+_DW_FORM_addr = 0x01
+_DW_FORM_block2 = 0x03
+_DW_FORM_block4 = 0x04
+_DW_FORM_data4 = 0x06
+_DW_FORM_data8 = 0x07
+_DW_FORM_string = 0x08
+_DW_FORM_block = 0x09
+_DW_FORM_block1 = 0x0A
+_DW_FORM_flag = 0x0C
+_DW_FORM_sdata = 0x0D
+_DW_FORM_strp = 0x0E
+_DW_FORM_ref_addr = 0x10
+_DW_FORM_indirect = 0x16
+_DW_FORM_sec_offset = 0x17
+_DW_FORM_exprloc = 0x18
+_DW_FORM_strx = 0x1A
+_DW_FORM_line_strp = 0x1F
+_DW_FORM_ref_sig8 = 0x20
+_DW_FORM_implicit_const = 0x21
+_DW_FORM_strx1 = 0x25
+_DW_FORM_strx4 = 0x28
+_DW_FORM_GNU_str_index = 0x1F02
+
+_DW_LNCT_path = 0x1
+
+_FIXED_FORMS = {
+    0x05: 2,  # data2
+    0x06: 4,  # data4
+    0x07: 8,  # data8
+    0x0B: 1,  # data1
+    0x0C: 1,  # flag
+    0x0E: 4,  # strp
+    0x11: 1,  # ref1
+    0x12: 2,  # ref2
+    0x13: 4,  # ref4
+    0x14: 8,  # ref8
+    0x17: 4,  # sec_offset
+    0x19: 0,  # flag_present
+    0x1E: 16,  # data16
+    0x1F: 4,  # line_strp
+    0x20: 8,  # ref_sig8
+    0x21: 0,  # implicit_const
+    0x25: 1,  # strx1
+    0x26: 2,  # strx2
+    0x27: 3,  # strx3
+    0x28: 4,  # strx4
+    0x29: 1,  # addrx1
+    0x2A: 2,  # addrx2
+    0x2B: 3,  # addrx3
+    0x2C: 4,  # addrx4
+}
+# udata, ref_udata, strx, addrx, loclistx, rnglistx, GNU_addr_index, GNU_str_index
+_ULEB_FORMS = {0x0F, 0x15, 0x1A, 0x1B, 0x22, 0x23, 0x1F01, 0x1F02}
+# ref_sup4, strp_sup, ref_sup8, GNU_ref_alt, GNU_strp_alt
+_SUPPLEMENTARY_FORMS = {0x1C, 0x1D, 0x24, 0x1F20, 0x1F21}
+
+_TYPE_TAGS = {
+    _DW_TAG_class_type,
+    _DW_TAG_enumeration_type,
+    _DW_TAG_structure_type,
+    _DW_TAG_typedef,
+    _DW_TAG_union_type,
+}
+_UNIT_TAGS = {_DW_TAG_compile_unit, _DW_TAG_partial_unit, _DW_TAG_type_unit, _DW_TAG_skeleton_unit}
+
+# sections referenced by offset or index from the units, which only hold addresses and are copied as is
+_COPIED_SECTIONS = (".debug_addr", ".debug_ranges", ".debug_rnglists", ".debug_loc", ".debug_loclists")
+
+_KEYWORDS = {
+    *"alignas alignof and and_eq asm auto bitand bitor bool break case catch char char8_t char16_t char32_t class "
+    "compl concept const consteval constexpr constinit const_cast continue co_await co_return co_yield decltype "
+    "default delete do double dynamic_cast else enum explicit export extern false float for friend goto if inline "
+    "int long mutable namespace new noexcept not not_eq nullptr operator or or_eq private protected public register "
+    "reinterpret_cast requires return short signed sizeof static static_assert static_cast struct switch template "
+    "this thread_local throw true try typedef typeid typename union unsigned using virtual void volatile wchar_t "
+    "while xor xor_eq".split(),
+}
+_IDENTIFIER = re.compile(r"[A-Za-z_][A-Za-z0-9_]*")
+_NUMBER = re.compile(r"[0-9]+")
+_LETTERS = string.ascii_letters
+_ALPHANUMERICS = string.ascii_letters + string.digits
+
+
+class Scrambler:
+    """
+    Replace identifiers by random ones of the same length, so that strings can be scrambled in place.
+
+    The same identifier is always replaced by the same one for a given seed, whether it appears alone, in a qualified
+    or template name, in a path or in a mangled name, which keeps the names of the units consistent with each other.
+    Keywords, names reserved to the implementation and identifiers of one or two characters are left as is.
+    """
+
+    def __init__(self, seed: int = 0):
+        self.seed = seed
+        self._mapping: dict[str, str] = {}
+        self._used: set[str] = set()
+
+    def identifier(self, word: str) -> str:
+        if len(word) <= 2 or word in _KEYWORDS or word.startswith("__") or (word[0] == "_" and word[1].isupper()):
+            return word
+
+        if (result := self._mapping.get(word)) is not None:
+            return result
+
+        attempt = 0
+        while True:
+            digest = hashlib.shake_256(f"{self.seed}:{attempt}:{word}".encode()).digest(len(word))
+            result = _LETTERS[digest[0] % len(_LETTERS)] + "".join(
+                _ALPHANUMERICS[b % len(_ALPHANUMERICS)] for b in digest[1:]
+            )
+            if result not in self._used and result not in _KEYWORDS:
+                break
+            attempt += 1
+
+        self._mapping[word] = result
+        self._used.add(result)
+        return result
+
+    def name(self, text: str) -> str:
+        """Scramble every identifier of a name, e.g. ``ns::Pair<int, Item>``."""
+        return _IDENTIFIER.sub(lambda m: self.identifier(m.group()), text)
+
+    def path(self, text: str) -> str:
+        """Scramble each component of a path, keeping the separators and the file extensions."""
+        components = re.split(r"([/\\])", text)
+        for i, component in enumerate(components):
+            stem, dot, extension = component.rpartition(".")
+            components[i] = self.name(stem) + dot + extension if stem else self.name(component)
+        return "".join(components)
+
+    def linkage_name(self, text: str) -> str:
+        """Scramble the source names of an Itanium mangled name, which keeps their length prefixes valid."""
+        if not text.startswith("_Z"):
+            return self.name(text)
+
+        result = []
+        pos = 0
+        while match := _NUMBER.search(text, pos):
+            start, end = match.span()
+            size = int(match.group())
+            word = text[end : end + size]
+            # only what follows the previous source name, whose own last characters could pass for a prefix
+            prefix = text[max(start - 2, pos) : start]
+            # array dimensions, vector sizes, substitutions, template parameters and literals are not source names
+            is_source_name = (
+                size > 0
+                and len(word) == size
+                and _IDENTIFIER.fullmatch(word)
+                and not prefix.endswith(("A", "S", "T", "Dv"))
+                and not (len(prefix) == 2 and prefix[0] == "L" and prefix[1].islower())
+            )
+            if is_source_name:
+                result.append(text[pos:end] + self.identifier(word))
+                pos = end + size
+            else:
+                result.append(text[pos:end])
+                pos = end
+
+        result.append(text[pos:])
+        return "".join(result)
+
+
+@dataclass
+class _Elf:
+    is_64: bool
+    endian: str
+    ident: bytes
+    type: int
+    machine: int
+    flags: int
+    # decompressed contents of the .debug_* sections
+    sections: dict[str, bytes]
+
+
+def _read_elf(path: Path) -> _Elf:
+    data = path.read_bytes()
+    if data[:4] != b"\x7fELF":
+        raise ValueError(f"{path} is not an ELF file")
+
+    is_64 = data[4] == 2
+    endian = "<" if data[5] == 1 else ">"
+    if is_64:
+        header = struct.Struct(endian + "HHIQQQIHHHHHH")
+        section_header = struct.Struct(endian + "IIQQQQIIQQ")
+        compression_header = struct.Struct(endian + "IIQQ")
+    else:
+        header = struct.Struct(endian + "HHIIIIIHHHHHH")
+        section_header = struct.Struct(endian + "IIIIIIIIII")
+        compression_header = struct.Struct(endian + "III")
+
+    (e_type, machine, _, _, _, shoff, flags, _, _, _, shentsize, shnum, shstrndx) = header.unpack_from(data, 16)
+    if e_type == _ET_REL:
+        raise ValueError(f"{path} is a relocatable object file, link it first")
+
+    headers = [section_header.unpack_from(data, shoff + i * shentsize) for i in range(shnum or 1)]
+    # extended numbering, when the values do not fit in the ELF header
+    if shnum == 0 and shoff:
+        headers += [section_header.unpack_from(data, shoff + i * shentsize) for i in range(1, headers[0][5])]
+    if shstrndx == 0xFFFF:
+        shstrndx = headers[0][6]
+
+    names = headers[shstrndx][4]
+    sections = {}
+    for name_offset, sh_type, sh_flags, _, offset, size, *_ in headers[1:]:
+        name = data[names + name_offset : data.index(b"\0", names + name_offset)].decode()
+        if not name.startswith((".debug_", ".zdebug_")) or sh_type == _SHT_NOBITS:
+            continue
+
+        contents = data[offset : offset + size]
+        if sh_flags & _SHF_COMPRESSED:
+            if struct.unpack_from(endian + "I", contents)[0] != _ELFCOMPRESS_ZLIB:
+                raise ValueError(f"{name} of {path} is not compressed with zlib")
+            contents = zlib.decompress(contents[compression_header.size :])
+        elif name.startswith(".zdebug_"):
+            # GNU compressed sections: "ZLIB", the size as a big-endian 64-bit integer, then the zlib stream
+            contents = zlib.decompress(contents[12:])
+            name = "." + name[2:]
+        sections[name] = contents
+
+    return _Elf(is_64, endian, data[:16], e_type, machine, flags, sections)
+
+
+def _write_elf(path: Path, elf: _Elf, sections: list[tuple[str, bytes]]) -> int:
+    """Write an ELF file holding only the given sections, without any program header. Returns its size."""
+    if elf.is_64:
+        header = struct.Struct(elf.endian + "16sHHIQQQIHHHHHH")
+        section_header = struct.Struct(elf.endian + "IIQQQQIIQQ")
+    else:
+        header = struct.Struct(elf.endian + "16sHHIIIIIHHHHHH")
+        section_header = struct.Struct(elf.endian + "IIIIIIIIII")
+
+    names = bytearray(b"\0")
+    sections = [*sections, (".shstrtab", b"")]
+    name_offsets = []
+    for name, _ in sections:
+        name_offsets.append(len(names))
+        names += name.encode() + b"\0"
+    sections[-1] = (".shstrtab", bytes(names))
+
+    body = bytearray()
+    headers = [section_header.pack(*[0] * 10)]
+    for (name, contents), name_offset in zip(sections, name_offsets):
+        sh_type = _SHT_STRTAB if name == ".shstrtab" else _SHT_PROGBITS
+        headers.append(
+            section_header.pack(name_offset, sh_type, 0, 0, header.size + len(body), len(contents), 0, 0, 1, 0)
+        )
+        body += contents
+
+    body += b"\0" * (-(header.size + len(body)) % 8)
+    shoff = header.size + len(body)
+    elf_header = header.pack(
+        elf.ident,
+        elf.type,
+        elf.machine,
+        1,
+        0,
+        0,
+        shoff,
+        elf.flags,
+        header.size,
+        0,
+        0,
+        section_header.size,
+        len(headers),
+        len(headers) - 1,
+    )
+    with path.open("wb") as f:
+        f.write(elf_header)
+        f.write(body)
+        for h in headers:
+            f.write(h)
+
+    return shoff + len(headers) * section_header.size
+
+
+@dataclass
+class _Unit:
+    section: str
+    offset: int
+    end: int
+    version: int
+    unit_type: int
+    address_size: int
+    abbrev_offset: int
+    # offset of the abbreviation offset in the unit header
+    abbrev_field: int
+    signature: int | None
+    # offset of the unit DIE
+    dies: int
+
+    @property
+    def is_type_unit(self) -> bool:
+        return self.unit_type in (_DW_UT_type, _DW_UT_split_type)
+
+
+@dataclass
+class _Abbrev:
+    tag: int
+    has_children: bool
+    # attribute, form and implicit constant
+    attributes: list[tuple[int, int, int | None]]
+
+
+class _Cursor:
+    def __init__(self, data: bytes, endian: str, pos: int = 0):
+        self.data = data
+        self.pos = pos
+        self._byteorder = "little" if endian == "<" else "big"
+
+    def uint(self, size: int) -> int:
+        value = int.from_bytes(self.data[self.pos : self.pos + size], self._byteorder)
+        self.pos += size
+        return value
+
+    def uleb(self) -> int:
+        value = shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def sleb(self) -> int:
+        value = shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value - (1 << shift) if byte & 0x40 else value
+
+    def cstring(self) -> bytes:
+        end = self.data.index(b"\0", self.pos)
+        value = self.data[self.pos : end]
+        self.pos = end + 1
+        return value
+
+    def skip_form(self, form: int, version: int, address_size: int) -> None:
+        """Move past a value of the given form."""
+        if (size := _FIXED_FORMS.get(form)) is not None:
+            self.pos += size
+        elif form in _ULEB_FORMS:
+            self.uleb()
+        elif form == _DW_FORM_sdata:
+            self.sleb()
+        elif form == _DW_FORM_addr:
+            self.pos += address_size
+        elif form == _DW_FORM_ref_addr:
+            self.pos += address_size if version == 2 else 4
+        elif form == _DW_FORM_string:
+            self.pos = self.data.index(b"\0", self.pos) + 1
+        elif form in (_DW_FORM_block, _DW_FORM_exprloc):
+            size = self.uleb()
+            self.pos += size
+        elif form in (_DW_FORM_block1, _DW_FORM_block2, _DW_FORM_block4):
+            size = self.uint({_DW_FORM_block1: 1, _DW_FORM_block2: 2, _DW_FORM_block4: 4}[form])
+            self.pos += size
+        elif form in _SUPPLEMENTARY_FORMS:
+            raise ValueError("References to a supplementary object file (e.g. from dwz) are not supported")
+        else:
+            raise ValueError(f"Unknown form 0x{form:x}")
+
+
+class _Strings:
+    """A string section being built, in which each string is stored once."""
+
+    def __init__(self):
+        self.data = bytearray()
+        self._offsets: dict[bytes, int] = {}
+
+    def add(self, value: bytes) -> int:
+        offset = self._offsets.get(value)
+        if offset is None:
+            offset = self._offsets[value] = len(self.data)
+            self.data += value + b"\0"
+        return offset
+
+
+@dataclass
+class SubsetResult:
+    compile_units: int = 0
+    type_units: int = 0
+    size: int = 0
+    # units that were kept, by section and offset in the input
+    units: list[tuple[str, int]] = field(default_factory=list)
+
+
+class _Subsetter:
+    def __init__(self, elf: _Elf, scrambler: Scrambler | None):
+        self.elf = elf
+        self.sections = elf.sections
+        self.scrambler = scrambler
+        self.units: dict[str, list[_Unit]] = {
+            section: self._read_units(section) for section in (".debug_info", ".debug_types")
+        }
+        self._offsets = {section: [unit.offset for unit in units] for section, units in self.units.items()}
+        self.type_units = {unit.signature: unit for units in self.units.values() for unit in units if unit.is_type_unit}
+        self._abbrevs: dict[int, tuple[dict[int, _Abbrev], int]] = {}
+
+        # sections of the output
+        self.abbrev = bytearray()
+        self.abbrev_offsets: dict[int, int] = {}
+        self.line = bytearray()
+        self.line_offsets: dict[int, int] = {}
+        self.str_offsets = bytearray()
+        self.str_offsets_bases: dict[int, int] = {}
+        self.str = _Strings()
+        self.line_str = _Strings()
+
+    def cursor(self, section: str, pos: int = 0) -> _Cursor:
+        return _Cursor(self.sections.get(section, b""), self.elf.endian, pos)
+
+    def _read_units(self, section: str) -> list[_Unit]:
+        units = []
+        data = self.sections.get(section, b"")
+        c = self.cursor(section)
+        while c.pos < len(data):
+            offset = c.pos
+            length = c.uint(4)
+            if length >= 0xFFFFFFF0:
+                raise ValueError(f"64-bit DWARF is not supported, in the unit at 0x{offset:x} of {section}")
+
+            end = c.pos + length
+            version = c.uint(2)
+            signature = None
+            if version >= 5:
+                unit_type = c.uint(1)
+                address_size = c.uint(1)
+                abbrev_field = c.pos
+                abbrev_offset = c.uint(4)
+                if unit_type in (_DW_UT_type, _DW_UT_split_type):
+                    signature = c.uint(8)
+                    c.pos += 4
+                elif unit_type in (_DW_UT_skeleton, _DW_UT_split_compile):
+                    c.pos += 8
+            else:
+                abbrev_field = c.pos
+                abbrev_offset = c.uint(4)
+                address_size = c.uint(1)
+                unit_type = _DW_UT_compile
+                if section == ".debug_types":
+                    unit_type = _DW_UT_type
+                    signature = c.uint(8)
+                    c.pos += 4
+
+            units.append(
+                _Unit(
+                    section,
+                    offset,
+                    end,
+                    version,
+                    unit_type,
+                    address_size,
+                    abbrev_offset,
+                    abbrev_field,
+                    signature,
+                    c.pos,
+                )
+            )
+            c.pos = end
+
+        return units
+
+    def abbrevs(self, offset: int) -> tuple[dict[int, _Abbrev], int]:
+        """The abbreviation table at an offset of .debug_abbrev, and the offset of its end."""
+        if (result := self._abbrevs.get(offset)) is not None:
+            return result
+
+        table = {}
+        c = self.cursor(".debug_abbrev", offset)
+        while code := c.uleb():
+            tag = c.uleb()
+            has_children = c.uint(1) != 0
+            attributes = []
+            while True:
+                attribute, form = c.uleb(), c.uleb()
+                if attribute == 0 and form == 0:
+                    break
+                attributes.append((attribute, form, c.sleb() if form == _DW_FORM_implicit_const else None))
+            table[code] = _Abbrev(tag, has_children, attributes)
+
+        result = self._abbrevs[offset] = (table, c.pos)
+        return result
+
+    def attributes(self, unit: _Unit, pos: int | None = None) -> Iterator[tuple[int, int, int, int, int]]:
+        """
+        Tag, attribute, form, start and end offsets of the value of each attribute of the DIEs of a unit, or only of
+        the DIE at the given offset.
+        """
+        table, _ = self.abbrevs(unit.abbrev_offset)
+        c = self.cursor(unit.section, unit.dies if pos is None else pos)
+        while c.pos < unit.end:
+            code = c.uleb()
+            if code == 0:
+                continue
+
+            abbrev = table.get(code)
+            if abbrev is None:
+                raise ValueError(f"Unknown abbreviation {code} at 0x{c.pos:x} of {unit.section}")
+
+            for attribute, form, _ in abbrev.attributes:
+                while form == _DW_FORM_indirect:
+                    form = c.uleb()
+                start = c.pos
+                c.skip_form(form, unit.version, unit.address_size)
+                yield abbrev.tag, attribute, form, start, c.pos
+
+            if pos is not None:
+                return
+
+    def unit_at(self, offset: int, section: str = ".debug_info") -> _Unit | None:
+        """The unit containing an offset of .debug_info or .debug_types."""
+        i = bisect.bisect_right(self._offsets[section], offset) - 1
+        if i >= 0 and offset < self.units[section][i].end:
+            return self.units[section][i]
+        return None
+
+    def value(self, unit: _Unit, start: int, end: int) -> int:
+        return self.cursor(unit.section, start).uint(end - start)
+
+    def is_type_definition(self, unit: _Unit, offset: int) -> bool:
+        c = self.cursor(unit.section, offset)
+        table, _ = self.abbrevs(unit.abbrev_offset)
+        abbrev = table.get(c.uleb())
+        if abbrev is None or abbrev.tag not in _TYPE_TAGS:
+            return False
+
+        for _, attribute, form, start, end in self.attributes(unit, offset):
+            if attribute == _DW_AT_declaration:
+                return form != _DW_FORM_flag or self.value(unit, start, end) == 0
+        return True
+
+    def closure(self, units: Iterable[_Unit]) -> list[_Unit]:
+        """The units and every unit they reference through DW_FORM_ref_addr and DW_FORM_ref_sig8."""
+        selected = {(unit.section, unit.offset): unit for unit in units}
+        queue = list(selected.values())
+        while queue:
+            unit = queue.pop()
+            for _, _, form, start, end in self.attributes(unit):
+                if form == _DW_FORM_ref_addr:
+                    referenced = self.unit_at(self.value(unit, start, end))
+                elif form == _DW_FORM_ref_sig8:
+                    # the type unit may be in a .dwo file
+                    referenced = self.type_units.get(self.value(unit, start, end))
+                else:
+                    continue
+
+                if referenced is not None and (referenced.section, referenced.offset) not in selected:
+                    selected[referenced.section, referenced.offset] = referenced
+                    queue.append(referenced)
+
+        return sorted(selected.values(), key=lambda u: (u.section, u.offset))
+
+    def scramble(self, value: bytes, kind: str) -> bytes:
+        if self.scrambler is None or kind == "producer":
+            return value
+
+        text = value.decode("utf-8", "surrogateescape")
+        if kind == "path":
+            text = self.scrambler.path(text)
+        elif kind == "linkage_name":
+            text = self.scrambler.linkage_name(text)
+        else:
+            text = self.scrambler.name(text)
+        return text.encode("utf-8", "surrogateescape")
+
+    @staticmethod
+    def string_kind(tag: int, attribute: int) -> str:
+        if attribute in (_DW_AT_comp_dir, _DW_AT_dwo_name, _DW_AT_GNU_dwo_name):
+            return "path"
+        if attribute == _DW_AT_name and tag in _UNIT_TAGS:
+            return "path"
+        if attribute in (_DW_AT_linkage_name, _DW_AT_MIPS_linkage_name):
+            return "linkage_name"
+        if attribute == _DW_AT_producer:
+            return "producer"
+        return "name"
+
+    def copy_string(self, form: int, offset: int, kind: str) -> int:
+        """Copy a string of .debug_str or .debug_line_str to the same section of the output."""
+        section, strings = (
+            (".debug_line_str", self.line_str) if form == _DW_FORM_line_strp else (".debug_str", self.str)
+        )
+        return strings.add(self.scramble(self.cursor(section, offset).cstring(), kind))
+
+    def copy_abbrevs(self, offset: int) -> int:
+        if (result := self.abbrev_offsets.get(offset)) is None:
+            _, end = self.abbrevs(offset)
+            result = self.abbrev_offsets[offset] = len(self.abbrev)
+            self.abbrev += self.sections[".debug_abbrev"][offset:end]
+        return result
+
+    def copy_str_offsets(self, base: int, kinds: dict[int, str]) -> int:
+        """Copy the contribution of a unit to .debug_str_offsets, whose header precedes its base."""
+        if (result := self.str_offsets_bases.get(base)) is not None:
+            return result
+
+        # unit length, version and padding
+        c = self.cursor(".debug_str_offsets", base - 8)
+        end = base - 4 + c.uint(4)
+        self.str_offsets += self.sections[".debug_str_offsets"][base - 8 : base]
+        result = self.str_offsets_bases[base] = len(self.str_offsets)
+        c.pos = base
+        index = 0
+        while c.pos < end:
+            self.str_offsets += self._bytes(self.copy_string(_DW_FORM_strp, c.uint(4), kinds.get(index, "name")), 4)
+            index += 1
+        return result
+
+    def copy_line_table(self, offset: int) -> int:
+        """Copy a line table, scrambling the paths of its header."""
+        if (result := self.line_offsets.get(offset)) is not None:
+            return result
+
+        c = self.cursor(".debug_line", offset)
+        length = c.uint(4)
+        if length >= 0xFFFFFFF0:
+            raise ValueError(f"64-bit DWARF is not supported, in the line table at 0x{offset:x}")
+
+        end = c.pos + length
+        data = bytearray(self.sections[".debug_line"][offset:end])
+        version = c.uint(2)
+        address_size = c.uint(1) if version >= 5 else 0
+        if version >= 5:
+            c.pos += 1  # segment selector size
+        c.pos += 4  # header length
+        c.pos += 5 if version >= 4 else 4  # instruction lengths, default is_stmt, line base and range
+        opcode_base = c.uint(1)
+        c.pos += opcode_base - 1
+
+        def patch_inline(start: int, kind: str) -> None:
+            value = self.sections[".debug_line"][start : c.pos - 1]
+            data[start - offset : c.pos - 1 - offset] = self.scramble(value, kind)
+
+        if version < 5:
+            # include directories, then file names with their directory index, time and size
+            while True:
+                start = c.pos
+                if not c.cstring():
+                    break
+                patch_inline(start, "path")
+            while True:
+                start = c.pos
+                if not c.cstring():
+                    break
+                patch_inline(start, "path")
+                c.uleb(), c.uleb(), c.uleb()
+        else:
+            for _ in range(2):  # directories, then file names
+                formats = [(c.uleb(), c.uleb()) for _ in range(c.uint(1))]
+                for _ in range(c.uleb()):
+                    for content, form in formats:
+                        kind = "path" if content == _DW_LNCT_path else "name"
+                        start = c.pos
+                        c.skip_form(form, version, address_size)
+                        if form == _DW_FORM_string:
+                            patch_inline(start, kind)
+                        elif form in (_DW_FORM_strp, _DW_FORM_line_strp):
+                            new = self.copy_string(form, self.cursor(".debug_line", c.pos - 4).uint(4), kind)
+                            data[c.pos - 4 - offset : c.pos - offset] = self._bytes(new, 4)
+                        elif _DW_FORM_strx1 <= form <= _DW_FORM_strx4 or form == _DW_FORM_strx:
+                            raise ValueError(f"Indexed strings are not supported in the line table at 0x{offset:x}")
+
+        result = self.line_offsets[offset] = len(self.line)
+        self.line += data
+        return result
+
+    def _bytes(self, value: int, size: int) -> bytes:
+        return value.to_bytes(size, "little" if self.elf.endian == "<" else "big")
+
+    def copy_unit(self, unit: _Unit, unit_offsets: dict[int, int]) -> bytes:
+        """Copy a unit, pointing its offsets into other sections and units to their copies in the output."""
+        data = bytearray(self.sections[unit.section][unit.offset : unit.end])
+
+        def patch(start: int, end: int, value: int) -> None:
+            data[start - unit.offset : end - unit.offset] = self._bytes(value, end - start)
+
+        patch(unit.abbrev_field, unit.abbrev_field + 4, self.copy_abbrevs(unit.abbrev_offset))
+
+        str_offsets_base = None
+        strx_kinds: dict[int, str] = {}
+        for tag, attribute, form, start, end in self.attributes(unit):
+            kind = self.string_kind(tag, attribute)
+            if form in (_DW_FORM_strp, _DW_FORM_line_strp):
+                patch(start, end, self.copy_string(form, self.value(unit, start, end), kind))
+            elif form == _DW_FORM_string:
+                value = self.sections[unit.section][start : end - 1]
+                data[start - unit.offset : end - 1 - unit.offset] = self.scramble(value, kind)
+            elif form in (_DW_FORM_strx, _DW_FORM_GNU_str_index):
+                strx_kinds[self.cursor(unit.section, start).uleb()] = kind
+            elif _DW_FORM_strx1 <= form <= _DW_FORM_strx4:
+                strx_kinds[self.value(unit, start, end)] = kind
+            elif form == _DW_FORM_ref_addr:
+                target = self.value(unit, start, end)
+                referenced = self.unit_at(target)
+                if referenced is None:
+                    raise ValueError(f"Reference to 0x{target:x} out of .debug_info")
+                patch(start, end, unit_offsets[referenced.offset] + target - referenced.offset)
+            elif attribute == _DW_AT_stmt_list and form in (_DW_FORM_sec_offset, _DW_FORM_data4, _DW_FORM_data8):
+                patch(start, end, self.copy_line_table(self.value(unit, start, end)))
+            elif attribute == _DW_AT_str_offsets_base and form == _DW_FORM_sec_offset:
+                str_offsets_base = (start, end)
+
+        if str_offsets_base is not None:
+            start, end = str_offsets_base
+            patch(start, end, self.copy_str_offsets(self.value(unit, start, end), strx_kinds))
+
+        return bytes(data)
+
+
+def subset(
+    path: Path,
+    output_path: Path,
+    compile_units: int | None = None,
+    types: dict[str, list[tuple[int, bool]]] | None = None,
+    scrambler: Scrambler | None = None,
+) -> SubsetResult:
+    """Write an ELF file whose debug sections only hold some units of a binary and the units they reference.
+
+    The units are copied as is, except for their offsets into the string, line and abbreviation sections, which point
+    to copies holding only what the units use. The sections of addresses, ranges and locations are copied as is.
+
+    Args:
+        path: Linked binary with DWARF
+        output_path: ELF file to write
+        compile_units: Number of compile units to keep, from the start of .debug_info
+        types: Offsets of the DIEs that may define each type whose units to keep, and whether they are in .debug_types
+        scrambler: Scrambler of the names and paths, which are kept as is if None
+
+    Returns:
+        The units that were kept and the size of the output
+    """
+    elf = _read_elf(path)
+    if ".debug_info" not in elf.sections:
+        raise ValueError(f"{path} has no .debug_info section")
+
+    subsetter = _Subsetter(elf, scrambler)
+    selected = []
+    if compile_units:
+        selected += [unit for unit in subsetter.units[".debug_info"] if not unit.is_type_unit][:compile_units]
+
+    for name, candidates in (types or {}).items():
+        definitions = []
+        for offset, types_section in candidates:
+            unit = subsetter.unit_at(offset, ".debug_types" if types_section else ".debug_info")
+            if unit is not None and subsetter.is_type_definition(unit, offset):
+                definitions.append(unit)
+        if not definitions:
+            raise ValueError(f"No definition of {name}")
+        selected += definitions
+
+    result = SubsetResult()
+    sections: dict[str, bytearray] = {".debug_info": bytearray(), ".debug_types": bytearray()}
+    units = subsetter.closure(selected)
+    unit_offsets = {}
+    offset = 0
+    for unit in units:
+        if unit.section == ".debug_info":
+            unit_offsets[unit.offset] = offset
+            offset += unit.end - unit.offset
+
+    for unit in units:
+        sections[unit.section] += subsetter.copy_unit(unit, unit_offsets)
+        result.units.append((unit.section, unit.offset))
+        if unit.is_type_unit:
+            result.type_units += 1
+        else:
+            result.compile_units += 1
+
+    sections |= {
+        ".debug_abbrev": subsetter.abbrev,
+        ".debug_str": subsetter.str.data,
+        ".debug_line": subsetter.line,
+        ".debug_line_str": subsetter.line_str.data,
+        ".debug_str_offsets": subsetter.str_offsets,
+    }
+    for name in _COPIED_SECTIONS:
+        if name in elf.sections:
+            sections[name] = elf.sections[name]
+
+    result.size = _write_elf(output_path, elf, [(name, bytes(data)) for name, data in sections.items() if data])
+    return result
@@ -0,0 +1,190 @@
+#include "symbolizer.h"
+
+#include "dwarf_utils.h"
+#include "type_printer.h"
+
+#include <llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace dwarf2cpp {
+namespace {
+    struct Range {
+        uint64_t low;
+        uint64_t high;
+        uint32_t symbol;
+    };
+
+    void addRanges(llvm::Expected<llvm::DWARFAddressRangesVector> ranges,
+                   uint32_t symbol,
+                   std::vector<Range> &result) {
+        if (!ranges) {
+            llvm::consumeError(ranges.takeError());
+            return;
+        }
+        for (const auto &range : *ranges) {
+            // ranges of functions discarded by the linker start at 0 or at a tombstone value
+            if (range.LowPC != 0 && range.LowPC < range.HighPC) {
+                result.push_back({range.LowPC, range.HighPC, symbol});
+            }
+        }
+    }
+} // namespace
+
+Symbolizer::Symbolizer(llvm::DWARFContext &context) {
+    std::vector<Range> ranges;
+    std::unordered_map<uint64_t, uint32_t> unit_symbols;
+    for (const auto &unit : context.compile_units()) {
+        auto unit_symbol = static_cast<uint32_t>(symbols_.size());
+        auto unit_die = unit->getUnitDIE(false);
+        symbols_.emplace_back(unit_die);
+        unit_symbols[unit->getOffset()] = unit_symbol;
+        addRanges(unit_die.getAddressRanges(), unit_symbol, ranges);
+
+        for (const auto &debug_info_entry : unit->dies()) {
+            llvm::DWARFDie die(unit.get(), &debug_info_entry);
+            if (die.getTag() != llvm::dwarf::DW_TAG_subprogram
+                || !(die.find(llvm::dwarf::DW_AT_low_pc) || die.find(llvm::dwarf::DW_AT_ranges))) {
+                continue;
+            }
+
+            auto symbol = static_cast<uint32_t>(symbols_.size());
+            symbols_.emplace_back(die);
+            addRanges(die.getAddressRanges(), symbol, ranges);
+        }
+    }
+
+    // units without ranges of their own may still be described by .debug_aranges
+    llvm::DWARFDataExtractor aranges(
+        context.getDWARFObj().getArangesSection(), context.isLittleEndian(), 0);
+    uint64_t offset = 0;
+    while (aranges.isValidOffset(offset)) {
+        llvm::DWARFDebugArangeSet set;
+        if (auto error = set.extract(aranges, &offset, llvm::consumeError)) {
+            llvm::consumeError(std::move(error));
+            break;
+        }
+        auto it = unit_symbols.find(set.getCompileUnitDIEOffset());
+        if (it == unit_symbols.end()) {
+            continue;
+        }
+        for (const auto &descriptor : set.descriptors()) {
+            if (descriptor.Address != 0 && descriptor.Length != 0) {
+                ranges.push_back(
+                    {descriptor.Address, descriptor.getEndAddress(), it->second});
+            }
+        }
+    }
+
+    // Flatten the ranges into disjoint intervals, where the innermost range wins. Units are wider
+    // than their subprograms, so they come first among ranges starting at the same address.
+    std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) {
+        return a.low != b.low ? a.low < b.low : a.high > b.high;
+    });
+
+    auto emit = [this](uint64_t low, uint64_t high, uint32_t symbol) {
+        if (low >= high) {
+            return;
+        }
+        if (!intervals_.empty() && intervals_.back().high == low
+            && intervals_.back().symbol == symbol) {
+            intervals_.back().high = high;
+            return;
+        }
+        intervals_.push_back({low, high, symbol});
+    };
+
+    std::vector<Range> open;
+    uint64_t cursor = 0;
+    for (const auto &range : ranges) {
+        while (!open.empty() && open.back().high <= range.low) {
+            emit(cursor, open.back().high, open.back().symbol);
+            cursor = std::max(cursor, open.back().high);
+            open.pop_back();
+        }
+        if (!open.empty()) {
+            emit(cursor, range.low, open.back().symbol);
+        }
+        cursor = std::max(cursor, range.low);
+        open.push_back(range);
+    }
+    while (!open.empty()) {
+        emit(cursor, open.back().high, open.back().symbol);
+        cursor = std::max(cursor, open.back().high);
+        open.pop_back();
+    }
+    intervals_.shrink_to_fit();
+}
+
+std::vector<uint32_t> Symbolizer::lookup(llvm::ArrayRef<uint64_t> addresses) const {
+    std::vector<uint32_t> result;
+    result.reserve(addresses.size());
+    for (auto address : addresses) {
+        auto it = std::upper_bound(
+            intervals_.begin(),
+            intervals_.end(),
+            address,
+            [](uint64_t value, const Interval &interval) { return value < interval.low; });
+        if (it != intervals_.begin() && address < std::prev(it)->high) {
+            result.push_back(std::prev(it)->symbol);
+        } else {
+            result.push_back(kNone);
+        }
+    }
+    return result;
+}
+
+const Symbolizer::Symbol &Symbolizer::describe(uint32_t symbol) {
+    std::lock_guard lock(mutex_);
+    auto &result = symbols_[symbol];
+    if (result.described) {
+        return result;
+    }
+    result.described = true;
+
+    auto die = result.die;
+    if (die.getTag() != llvm::dwarf::DW_TAG_subprogram) {
+        // a unit, only its name is known, which is the path of its primary source file
+        if (auto name = llvm::dwarf::toString(die.find(llvm::dwarf::DW_AT_name))) {
+            result.name = *name;
+        }
+        return result;
+    }
+
+    // concrete out-of-line instances and definitions outside of their class refer to the
+    // declaration holding the name and the scopes
+    auto declaration = die;
+    for (int depth = 0; depth < 8; ++depth) {
+        auto origin = getAttributeValueAsReferencedDie(declaration,
+                                                       llvm::dwarf::DW_AT_abstract_origin);
+        if (!origin.isValid()) {
+            origin
+                = getAttributeValueAsReferencedDie(declaration, llvm::dwarf::DW_AT_specification);
+        }
+        if (!origin.isValid()) {
+            break;
+        }
+        declaration = origin;
+    }
+
+    std::string name;
+    llvm::raw_string_ostream os(name);
+    llvm::DWARFTypePrinter printer(os);
+    printer.appendScopes(declaration.getParent());
+    printer.appendUnqualifiedName(declaration);
+    os.flush();
+    if (!name.empty()) {
+        result.name = std::move(name);
+    } else if (const char *linkage_name = die.getLinkageName()) {
+        result.name = linkage_name;
+    }
+
+    result.decl_file = DeclFile(die);
+    result.decl_line = static_cast<uint32_t>(
+        llvm::dwarf::toUnsigned(findRecursively(die, llvm::dwarf::DW_AT_decl_line), 0));
+    return result;
+}
+
+} // namespace dwarf2cpp
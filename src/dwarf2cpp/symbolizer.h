@@ -0,0 +1,62 @@
+#ifndef DWARF2CPP_SYMBOLIZER_H
+#define DWARF2CPP_SYMBOLIZER_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/DebugInfo/DWARF/DWARFDie.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dwarf2cpp {
+
+// Maps code addresses back to the subprograms containing them. The address ranges of every
+// subprogram are flattened once into sorted, non-overlapping intervals, so that each lookup is a
+// binary search. Addresses that are only covered by a compile unit, through its own ranges or
+// .debug_aranges (e.g. code assembled from a .S file), map to the unit itself, named after its
+// DW_AT_name. Building the index parses every unit, so the context must be created thread-safe
+// when other threads can use it.
+class Symbolizer {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Symbol {
+        explicit Symbol(llvm::DWARFDie die) : die(die) {}
+
+        // the subprogram, or the unit DIE
+        llvm::DWARFDie die;
+        // filled by describe
+        bool described = false;
+        std::optional<std::string> name;
+        std::optional<std::string> decl_file;
+        uint32_t decl_line = 0;
+    };
+
+    explicit Symbolizer(llvm::DWARFContext &context);
+
+    // Index of the symbol containing each address, kNone for addresses not covered by any.
+    [[nodiscard]] std::vector<uint32_t> lookup(llvm::ArrayRef<uint64_t> addresses) const;
+
+    // The qualified name and declaration site of a symbol, computed on first use.
+    const Symbol &describe(uint32_t symbol);
+
+    [[nodiscard]] size_t size() const { return symbols_.size(); }
+
+private:
+    struct Interval {
+        uint64_t low;
+        uint64_t high;
+        uint32_t symbol;
+    };
+
+    std::vector<Interval> intervals_;
+    std::vector<Symbol> symbols_;
+    std::mutex mutex_;
+};
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_SYMBOLIZER_H
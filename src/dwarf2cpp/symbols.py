@@ -0,0 +1,112 @@
+import enum
+import logging
+import struct
+from pathlib import Path
+from typing import Generator
+
+from .models import Function, Object, Struct, TypeDef
+from .reflection import fnv1a
+from .render import create_environment
+
+logger = logging.getLogger("dwarf2cpp")
+
+MAGIC = b"D2CSYMT\0"
+
+# Bump this whenever the layout of the file changes.
+SYMBOL_TABLE_VERSION = 1
+
+# all fields are little-endian, see templates/symbols.jinja for the matching C++ structs
+_HEADER = struct.Struct("<8sIIQQ")
+_ENTRY = struct.Struct("<QQIIB7x")
+
+
+class SymbolSource(enum.IntEnum):
+    SYMBOL_TABLE = 1
+    DEBUG_INFO = 2
+
+
+def iter_functions(file: dict[int, list[Object]]) -> Generator[Function, None, None]:
+    """Yield every function of a file, including member functions."""
+    stack = [obj for objects in file.values() for obj in objects]
+    while stack:
+        obj = stack.pop()
+        if isinstance(obj, Function):
+            yield obj
+        elif isinstance(obj, Struct):
+            stack.extend(member for members in obj.members.values() for member in members)
+        elif isinstance(obj, TypeDef) and isinstance(obj.value, Struct):
+            stack.append(obj.value)
+
+
+class SymbolAddressTable:
+    """
+    Writer of the address of every extracted function with a linkage name to a sorted binary table, along with a
+    C++ header to look them up from a memory mapping of the table.
+
+    Addresses come from the symbol tables of the binary (.symtab and .dynsym), and from DW_AT_low_pc for functions
+    without a symbol. Entries are sorted by the 64-bit FNV-1a hash of the linkage name, so that a lookup is a binary
+    search followed by a string comparison.
+    """
+
+    def __init__(self, path: Path, symbols: list[tuple[str, int, int]], namespace: str = "dwarf2cpp::symbols"):
+        if path.suffix == ".h":
+            raise ValueError(f"The symbol table {path} would be overwritten by its header, use another suffix")
+
+        self._path = path
+        self._namespace = namespace
+        self._symbols: dict[str, tuple[int, int]] = {}
+        for name, address, size in symbols:
+            self._symbols.setdefault(name, (address, size))
+
+        # linkage name -> (address, size, source)
+        self._entries: dict[str, tuple[int, int, SymbolSource]] = {}
+
+    def __enter__(self) -> "SymbolAddressTable":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        # the table of a failed extraction would be missing functions but look complete
+        if exc_type is None:
+            self.close()
+
+    @property
+    def header_path(self) -> Path:
+        return self._path.with_suffix(".h")
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        for function in iter_functions(file):
+            name = function.linkage_name
+            if not name or name in self._entries:
+                continue
+
+            if symbol := self._symbols.get(name):
+                self._entries[name] = (*symbol, SymbolSource.SYMBOL_TABLE)
+            elif function.address:
+                self._entries[name] = (function.address, 0, SymbolSource.DEBUG_INFO)
+
+    def close(self) -> None:
+        logger.info(f"Writing the addresses of {len(self._entries)} functions to {self._path}")
+        entries = sorted((fnv1a(name.encode()), name) for name in self._entries)
+
+        strings = bytearray(b"\0")
+        records = []
+        for h, name in entries:
+            address, size, source = self._entries[name]
+            records.append(_ENTRY.pack(h, address, min(size, 0xFFFFFFFF), len(strings), source))
+            strings += name.encode() + b"\0"
+
+        strings_offset = _HEADER.size + _ENTRY.size * len(records)
+        with self._path.open("wb") as f:
+            f.write(_HEADER.pack(MAGIC, SYMBOL_TABLE_VERSION, len(records), strings_offset, len(strings)))
+            f.writelines(records)
+            f.write(strings)
+
+        env = create_environment()
+        content = env.get_template("symbols.jinja").render(
+            namespace=self._namespace,
+            magic=list(MAGIC),
+            version=SYMBOL_TABLE_VERSION,
+            header_size=_HEADER.size,
+            entry_size=_ENTRY.size,
+        )
+        self.header_path.write_text(content)
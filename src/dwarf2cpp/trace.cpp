@@ -0,0 +1,61 @@
+#include "trace.h"
+
+#include <llvm/Support/Threading.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+namespace dwarf2cpp {
+namespace {
+    struct Recorder {
+        std::atomic<bool> enabled{false};
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+    };
+
+    Recorder &recorder() {
+        static Recorder instance;
+        return instance;
+    }
+} // namespace
+
+uint64_t TraceClock() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void StartTrace() {
+    auto &r = recorder();
+    std::lock_guard lock(r.mutex);
+    r.events.clear();
+    r.enabled.store(true, std::memory_order_relaxed);
+}
+
+bool Tracing() {
+    return recorder().enabled.load(std::memory_order_relaxed);
+}
+
+std::vector<TraceEvent> StopTrace() {
+    auto &r = recorder();
+    std::lock_guard lock(r.mutex);
+    r.enabled.store(false, std::memory_order_relaxed);
+    return std::exchange(r.events, {});
+}
+
+TraceSpan::TraceSpan(const char *name, std::optional<uint64_t> unit_offset)
+    : name_(name), unit_offset_(unit_offset),
+      enabled_(Tracing()), start_ns_(enabled_ ? TraceClock() : 0) {}
+
+TraceSpan::~TraceSpan() {
+    if (!enabled_) {
+        return;
+    }
+    auto duration_ns = TraceClock() - start_ns_;
+    auto &r = recorder();
+    std::lock_guard lock(r.mutex);
+    r.events.push_back({name_, start_ns_, duration_ns, llvm::get_threadid(), unit_offset_});
+}
+
+} // namespace dwarf2cpp
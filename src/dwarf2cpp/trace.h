@@ -0,0 +1,51 @@
+#ifndef DWARF2CPP_TRACE_H
+#define DWARF2CPP_TRACE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace dwarf2cpp {
+
+// A span of native work, on the clock of TraceClock.
+struct TraceEvent {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t thread_id;
+    // the unit the work was done for, if any
+    std::optional<uint64_t> unit_offset;
+};
+
+// Nanoseconds on a monotonic clock.
+[[nodiscard]] uint64_t TraceClock();
+
+// Start recording the spans of every thread, dropping those of a previous trace.
+void StartTrace();
+
+// Whether a trace is being recorded.
+[[nodiscard]] bool Tracing();
+
+// Stop recording and return the spans recorded since StartTrace, in the order they ended.
+[[nodiscard]] std::vector<TraceEvent> StopTrace();
+
+// Records the time between its construction and its destruction while a trace is being recorded,
+// and costs a single atomic load otherwise.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, std::optional<uint64_t> unit_offset = std::nullopt);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name_;
+    std::optional<uint64_t> unit_offset_;
+    bool enabled_;
+    uint64_t start_ns_;
+};
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_TRACE_H
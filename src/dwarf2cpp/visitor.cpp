@@ -0,0 +1,1527 @@
+#include "visitor.h"
+
+#include "dwarf_utils.h"
+#include "type_printer.h"
+
+#include <llvm/DebugInfo/DWARF/DWARFTypeUnit.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace dwarf2cpp {
+namespace {
+    uint64_t Key(const llvm::DWARFDie &die) {
+        return die.getOffset() << 1 | (die.getDwarfUnit()->isTypeUnit() ? 1 : 0);
+    }
+
+    std::optional<std::string> OptionalString(const char *value) {
+        if (!value) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool Truthy(const std::optional<std::string> &value) { return value && !value->empty(); }
+
+    bool StartsWith(const std::string &value, const std::string &prefix) {
+        return value.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool EndsWith(const std::string &value, const std::string &suffix) {
+        return value.size() >= suffix.size()
+               && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // The part of a name before its template arguments.
+    std::string StripTemplateArguments(const std::string &name) {
+        return name.substr(0, name.find('<'));
+    }
+
+    std::string Strip(const std::string &value) {
+        const char *whitespace = " \t\n\r\f\v";
+        auto begin = value.find_first_not_of(whitespace);
+        if (begin == std::string::npos) {
+            return "";
+        }
+        return value.substr(begin, value.find_last_not_of(whitespace) - begin + 1);
+    }
+
+    std::string ToPosix(std::string path) {
+        std::replace(path.begin(), path.end(), '\\', '/');
+        return path;
+    }
+
+    // posixpath.normpath
+    std::string NormPath(const std::string &path) {
+        if (path.empty()) {
+            return ".";
+        }
+
+        size_t initial_slashes = path[0] == '/' ? 1 : 0;
+        if (StartsWith(path, "//") && !StartsWith(path, "///")) {
+            initial_slashes = 2;
+        }
+
+        std::vector<std::string> components;
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            auto end = std::min(path.find('/', begin), path.size());
+            auto component = path.substr(begin, end - begin);
+            begin = end + 1;
+            if (component.empty() || component == ".") {
+                continue;
+            }
+            if (component != ".." || (initial_slashes == 0 && components.empty())
+                || (!components.empty() && components.back() == "..")) {
+                components.push_back(component);
+            } else if (!components.empty()) {
+                components.pop_back();
+            }
+        }
+
+        std::string result(initial_slashes, '/');
+        for (size_t i = 0; i < components.size(); ++i) {
+            result += (i != 0 ? "/" : "") + components[i];
+        }
+        return result.empty() ? "." : result;
+    }
+
+    // posixpath.abspath
+    std::string AbsPath(const std::string &path) {
+        if (StartsWith(path, "/")) {
+            return NormPath(path);
+        }
+        llvm::SmallString<256> cwd;
+        if (auto ec = llvm::sys::fs::current_path(cwd)) {
+            throw std::runtime_error("Cannot get the current directory: " + ec.message());
+        }
+        auto base = ToPosix(cwd.str().str());
+        return NormPath(path.empty() ? base : base + "/" + path);
+    }
+
+    std::vector<std::string> SplitComponents(const std::string &path) {
+        std::vector<std::string> components;
+        size_t begin = 0;
+        while (begin < path.size()) {
+            auto end = std::min(path.find('/', begin), path.size());
+            if (end > begin) {
+                components.push_back(path.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+        return components;
+    }
+
+    // posixpath.relpath
+    std::string RelPath(const std::string &path, const std::string &start) {
+        auto start_list = SplitComponents(AbsPath(start));
+        auto path_list = SplitComponents(AbsPath(path));
+        size_t i = 0;
+        while (i < start_list.size() && i < path_list.size() && start_list[i] == path_list[i]) {
+            ++i;
+        }
+
+        std::vector<std::string> rel_list(start_list.size() - i, "..");
+        rel_list.insert(rel_list.end(), path_list.begin() + i, path_list.end());
+        if (rel_list.empty()) {
+            return ".";
+        }
+
+        std::string result;
+        for (size_t j = 0; j < rel_list.size(); ++j) {
+            result += (j != 0 ? "/" : "") + rel_list[j];
+        }
+        return result;
+    }
+
+    std::string TagName(llvm::dwarf::Tag tag) {
+        auto name = llvm::dwarf::TagString(tag);
+        return name.empty() ? "DW_TAG_" + std::to_string(tag) : name.str();
+    }
+
+    std::string AttributeName(llvm::dwarf::Attribute attribute) {
+        auto name = llvm::dwarf::AttributeString(attribute);
+        return name.empty() ? "DW_AT_" + std::to_string(attribute) : name.str();
+    }
+
+    [[noreturn]] void UnhandledAttribute(llvm::dwarf::Attribute attribute) {
+        throw std::runtime_error("Unhandled attribute " + AttributeName(attribute));
+    }
+
+    [[noreturn]] void UnhandledChild(const llvm::DWARFDie &child) {
+        throw std::runtime_error("Unhandled child tag " + TagName(child.getTag()));
+    }
+
+    // DWARFFormValue.as_constant of the bindings, the signed value when the form has one.
+    struct Constant {
+        int64_t value;
+        bool is_unsigned;
+
+        [[nodiscard]] std::string str() const {
+            return is_unsigned ? std::to_string(static_cast<uint64_t>(value))
+                               : std::to_string(value);
+        }
+    };
+
+    Constant AsConstant(const llvm::DWARFFormValue &value) {
+        if (auto s = value.getAsSignedConstant()) {
+            return {*s, false};
+        }
+        if (auto u = value.getAsUnsignedConstant()) {
+            return {static_cast<int64_t>(*u), true};
+        }
+        throw std::runtime_error("Invalid constant value");
+    }
+
+    bool IsBlock(llvm::dwarf::Form form) {
+        switch (form) {
+            case llvm::dwarf::DW_FORM_block:
+            case llvm::dwarf::DW_FORM_block1:
+            case llvm::dwarf::DW_FORM_block2:
+            case llvm::dwarf::DW_FORM_block4:
+            case llvm::dwarf::DW_FORM_exprloc:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    llvm::DWARFDie Referenced(const llvm::DWARFFormValue &value) {
+        auto die = ReferencedDie(value);
+        if (!die.isValid()) {
+            throw std::runtime_error("Invalid reference");
+        }
+        return die;
+    }
+
+    llvm::DWARFDie ReferencedType(const llvm::DWARFDie &die) {
+        auto type = die.find(llvm::dwarf::DW_AT_type);
+        if (!type) {
+            throw std::runtime_error("Expected DW_AT_type in " + TagName(die.getTag()));
+        }
+        return Referenced(*type);
+    }
+
+    llvm::DWARFDie ResolveTypeUnitReference(const llvm::DWARFDie &die) {
+        auto result = die.resolveTypeUnitReference();
+        if (!result.isValid()) {
+            throw std::runtime_error("Invalid type unit reference");
+        }
+        return result;
+    }
+
+    // types that can be declared in place, e.g. `typedef struct { ... } name;`
+    bool IsTypeTag(llvm::dwarf::Tag tag) {
+        switch (tag) {
+            case llvm::dwarf::DW_TAG_class_type:
+            case llvm::dwarf::DW_TAG_union_type:
+            case llvm::dwarf::DW_TAG_enumeration_type:
+            case llvm::dwarf::DW_TAG_structure_type:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // declarations of a compile unit or a namespace that are rendered
+    bool IsDeclarationTag(llvm::dwarf::Tag tag) {
+        switch (tag) {
+            case llvm::dwarf::DW_TAG_typedef:
+            case llvm::dwarf::DW_TAG_variable:
+            case llvm::dwarf::DW_TAG_subprogram:
+            case llvm::dwarf::DW_TAG_imported_module:
+            case llvm::dwarf::DW_TAG_imported_declaration:
+                return true;
+            default:
+                return IsTypeTag(tag);
+        }
+    }
+
+    // children of a compile unit that are only visited through references
+    bool IsReferencedTypeTag(llvm::dwarf::Tag tag) {
+        switch (tag) {
+            case llvm::dwarf::DW_TAG_base_type:
+            case llvm::dwarf::DW_TAG_array_type:
+            case llvm::dwarf::DW_TAG_const_type:
+            case llvm::dwarf::DW_TAG_pointer_type:
+            case llvm::dwarf::DW_TAG_reference_type:
+            case llvm::dwarf::DW_TAG_rvalue_reference_type:
+            case llvm::dwarf::DW_TAG_atomic_type:
+            case llvm::dwarf::DW_TAG_volatile_type:
+            case llvm::dwarf::DW_TAG_restrict_type:
+            case llvm::dwarf::DW_TAG_unspecified_type:
+            case llvm::dwarf::DW_TAG_subroutine_type:
+            case llvm::dwarf::DW_TAG_ptr_to_member_type:
+            case llvm::dwarf::DW_TAG_label:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool IsTemplateParameterTag(llvm::dwarf::Tag tag) {
+        switch (tag) {
+            case llvm::dwarf::DW_TAG_template_type_parameter:
+            case llvm::dwarf::DW_TAG_template_value_parameter:
+            case llvm::dwarf::DW_TAG_GNU_template_parameter_pack:
+            case llvm::dwarf::DW_TAG_GNU_template_template_param:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // float_to_str and double_to_str of visitor.py
+    std::string FormatFloat(double value, int precision) {
+        std::string result = "nan";
+        if (!std::isnan(value)) {
+            char buffer[512];
+            std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+            result = buffer;
+        }
+        result.erase(result.find_last_not_of('0') + 1);
+        if (result.back() == '.') {
+            result += '0';
+        }
+        return result;
+    }
+
+    std::string DefaultValue(const std::string &type, const Constant &constant) {
+        auto bits = static_cast<uint64_t>(constant.value);
+        if (EndsWith(type, "float")) {
+            float value;
+            auto bits32 = static_cast<uint32_t>(bits);
+            std::memcpy(&value, &bits32, sizeof(value));
+            return FormatFloat(value, 7);
+        }
+        if (EndsWith(type, "double")) {
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return FormatFloat(value, 16);
+        }
+        if (EndsWith(type, "char") && !constant.is_unsigned && constant.value >= 32
+            && constant.value < 127) {
+            return std::string("'") + static_cast<char>(constant.value) + "'";
+        }
+        if (EndsWith(type, "bool")) {
+            return constant.value != 0 ? "true" : "false";
+        }
+        return constant.str();
+    }
+} // namespace
+
+Visitor::Visitor(llvm::DWARFContext &context, std::string base_dir)
+    : context_(context), base_dir_(std::move(base_dir)) {}
+
+void Visitor::visitFiles(const FileCallback &callback) {
+    for (const auto &unit : context_.types_section_units()) {
+        if (auto die = unit->getUnitDIE(false); die.isValid()) {
+            visit(die);
+        }
+    }
+
+    auto [pending, units] = scanLineTables();
+
+    size_t i = 0;
+    for (const auto &unit : context_.compile_units()) {
+        if (units[i]) {
+            if (auto die = unit->getUnitDIE(false); die.isValid()) {
+                visit(die);
+            }
+            for (const auto &path : pending[i]) {
+                finalize(path, callback);
+            }
+        }
+        ++i;
+    }
+
+    // files that are not referenced by the line table of any visited compile unit (e.g., only
+    // from type units)
+    std::vector<std::string> paths;
+    for (const auto &[path, file] : files_) {
+        paths.push_back(path);
+    }
+    for (const auto &path : paths) {
+        finalize(path, callback);
+    }
+}
+
+std::pair<std::vector<std::vector<std::string>>, std::vector<bool>> Visitor::scanLineTables() {
+    std::vector<bool> units;
+    std::map<std::string, size_t> last_units;
+    size_t last_cross_unit = 0;
+    for (const auto &unit : context_.compile_units()) {
+        auto i = units.size();
+        llvm::StringRef compilation_dir = unit->getCompilationDir();
+        units.push_back(StartsWith(ToPosix(compilation_dir.str()), base_dir_));
+        if (!units[i]) {
+            continue;
+        }
+
+        if (HasCrossUnitReferences(*unit)) {
+            last_cross_unit = i;
+        }
+
+        for (const auto &file : LineTableFiles(*unit)) {
+            auto path = NormPath(ToPosix(file));
+            if (StartsWith(path, base_dir_)) {
+                last_units[path] = i;
+            }
+        }
+    }
+
+    std::vector<std::vector<std::string>> pending(units.size());
+    for (const auto &[path, i] : last_units) {
+        // references across units can reach any file
+        pending[std::max(i, last_cross_unit)].push_back(path);
+    }
+    return {std::move(pending), std::move(units)};
+}
+
+bool Visitor::finalize(const std::string &path, const FileCallback &callback) {
+    syncParamNames();
+
+    finalized_.insert(path);
+    file_templates_.erase(path);
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+        return false;
+    }
+
+    auto file = std::move(it->second);
+    files_.erase(it);
+
+    // merge file with others that have the same relative path
+    auto rel_path = RelPath(path, base_dir_);
+    if (StartsWith(rel_path, "../")) {
+        return false;
+    }
+
+    for (auto &[line, objects] : file) {
+        objects = models::MergeLine(objects);
+    }
+    callback(rel_path, file);
+    return true;
+}
+
+void Visitor::syncParamNames() {
+    for (const auto &key : dirty_functions_) {
+        const auto &param_names = param_names_[key];
+        for (const auto &function : functions_[key]) {
+            auto count = std::min(function->parameters.size(), param_names.size());
+            for (size_t i = 0; i < count; ++i) {
+                auto &param = function->parameters[i];
+                if (!param.name) {
+                    param.name = param_names[i];
+                }
+            }
+        }
+    }
+    dirty_functions_.clear();
+}
+
+void Visitor::visit(const llvm::DWARFDie &die) {
+    if (isVisited(die)) {
+        return;
+    }
+
+    switch (die.getTag()) {
+        case llvm::dwarf::DW_TAG_compile_unit:
+            handleUnit(die);
+            break;
+        case llvm::dwarf::DW_TAG_type_unit:
+            visitTypeUnit(die);
+            break;
+        case llvm::dwarf::DW_TAG_namespace:
+            visitNamespace(die);
+            break;
+        case llvm::dwarf::DW_TAG_typedef:
+            visitTypedef(die);
+            break;
+        case llvm::dwarf::DW_TAG_class_type:
+            handleStruct(die, models::Kind::Class);
+            break;
+        case llvm::dwarf::DW_TAG_enumeration_type:
+            visitEnumerationType(die);
+            break;
+        case llvm::dwarf::DW_TAG_union_type:
+            handleStruct(die, models::Kind::Union);
+            break;
+        case llvm::dwarf::DW_TAG_structure_type:
+            handleStruct(die, models::Kind::Struct);
+            break;
+        case llvm::dwarf::DW_TAG_variable:
+            handleAttribute(die);
+            break;
+        case llvm::dwarf::DW_TAG_member:
+            visitMember(die);
+            break;
+        case llvm::dwarf::DW_TAG_subprogram:
+            visitSubprogram(die);
+            break;
+        case llvm::dwarf::DW_TAG_imported_module:
+            visitImportedModule(die);
+            break;
+        case llvm::dwarf::DW_TAG_imported_declaration:
+            visitImportedDeclaration(die);
+            break;
+        case llvm::dwarf::DW_TAG_template_type_parameter:
+            visitTemplateTypeParameter(die);
+            break;
+        case llvm::dwarf::DW_TAG_template_value_parameter:
+            visitTemplateValueParameter(die);
+            break;
+        case llvm::dwarf::DW_TAG_GNU_template_parameter_pack:
+            visitTemplateParameterPack(die);
+            break;
+        case llvm::dwarf::DW_TAG_GNU_template_template_param:
+            visitTemplateTemplateParameter(die);
+            break;
+        default:
+            genericVisit(die);
+            break;
+    }
+}
+
+void Visitor::visitSignature(const llvm::DWARFDie &die) { visit(die); }
+
+void Visitor::visitTypeUnit(const llvm::DWARFDie &die) {
+    if (auto *type_unit = llvm::dyn_cast<llvm::DWARFTypeUnit>(die.getDwarfUnit())) {
+        auto type_die
+            = type_unit->getDIEForOffset(type_unit->getTypeOffset() + type_unit->getOffset());
+        if (type_die.isValid()) {
+            visitSignature(type_die);
+        }
+    }
+
+    handleUnit(die);
+}
+
+void Visitor::handleUnit(const llvm::DWARFDie &die) {
+    for (const auto &child : die.children()) {
+        auto tag = child.getTag();
+        if (tag == llvm::dwarf::DW_TAG_namespace) {
+            visit(child);
+        } else if (IsDeclarationTag(tag)) {
+            handleDeclaration(child, nullptr);
+        } else if (!IsReferencedTypeTag(tag)) {
+            UnhandledChild(child);
+        }
+    }
+}
+
+void Visitor::handleDeclaration(const llvm::DWARFDie &child,
+                                const std::shared_ptr<models::Namespace> &namespace_) {
+    auto decl_file = DeclFileName(child);
+    auto decl_line = DeclLine(child);
+    if (!Truthy(decl_file) || !decl_line) {
+        return;
+    }
+
+    auto path = NormPath(ToPosix(*decl_file));
+    if (!StartsWith(path, base_dir_)) {
+        return;
+    }
+
+    visit(child);
+    auto obj = getObject(child);
+    if (!obj) {
+        return;
+    }
+
+    if (namespace_) {
+        if (obj->parent && obj->parent->name != namespace_->name) {
+            throw std::runtime_error("Already has a parent");
+        }
+        obj->parent = namespace_;
+        if (obj->template_) {
+            obj->template_->parent = namespace_;
+        }
+    }
+
+    if (obj->template_) {
+        if (auto tmpl = registerTemplate(file_templates_[path], decl_line, *obj->template_)) {
+            add(path, decl_line, tmpl);
+        }
+    }
+    add(path, decl_line, obj);
+}
+
+void Visitor::visitNamespace(const llvm::DWARFDie &die) {
+    auto namespace_ = std::make_shared<models::Namespace>();
+    namespace_->name = OptionalString(ShortName(die));
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_name:
+                break;
+            case llvm::dwarf::DW_AT_export_symbols:
+                if (namespace_->name) {
+                    namespace_->is_inline = true;
+                }
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    namespaces_[Key(die)] = namespace_;
+
+    for (const auto &child : die.children()) {
+        auto tag = child.getTag();
+        if (tag == llvm::dwarf::DW_TAG_namespace) {
+            visit(child);
+            auto member = getNamespace(child);
+            if (member->parent) {
+                throw std::runtime_error("Already has a parent");
+            }
+            member->parent = namespace_;
+        } else if (IsDeclarationTag(tag)) {
+            handleDeclaration(child, namespace_);
+        } else {
+            UnhandledChild(child);
+        }
+    }
+}
+
+void Visitor::visitTypedef(const llvm::DWARFDie &die) {
+    if (!Truthy(DeclFileName(die)) || !DeclLine(die)) {
+        return;
+    }
+
+    auto typedef_ = std::make_shared<models::TypeDef>();
+    typedef_->name = OptionalString(ShortName(die));
+    if (auto type_attr = die.find(llvm::dwarf::DW_AT_type)) {
+        auto type_die = ResolveTypeUnitReference(Referenced(*type_attr));
+        if (!ShortName(type_die) && IsTypeTag(type_die.getTag())) {
+            // this is an in-place declaration
+            visit(type_die);
+            auto value = getObject(type_die);
+            if (!value) {
+                throw std::runtime_error("Expected a type declared in place");
+            }
+            value->is_implicit = true;
+            typedef_->value_type = value;
+        } else {
+            typedef_->value = resolveType(type_die);
+        }
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_type:
+                break;
+            case llvm::dwarf::DW_AT_alignment:
+                typedef_->alignment = AsConstant(attribute.Value).value;
+                break;
+            case llvm::dwarf::DW_AT_accessibility:
+                typedef_->access = static_cast<llvm::dwarf::AccessAttribute>(
+                    AsConstant(attribute.Value).value);
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    setObject(die, typedef_);
+}
+
+void Visitor::visitEnumerationType(const llvm::DWARFDie &die) {
+    std::shared_ptr<models::Enum> enum_;
+    if (die.find(llvm::dwarf::DW_AT_signature)) {
+        auto signature = ResolveTypeUnitReference(die);
+        visitSignature(signature);
+        auto declaration = getObject(signature);
+        if (!declaration || declaration->kind != models::Kind::Enum) {
+            throw std::runtime_error("Expected valid declaration");
+        }
+        enum_ = std::make_shared<models::Enum>(static_cast<const models::Enum &>(*declaration));
+    } else {
+        enum_ = std::make_shared<models::Enum>();
+        enum_->name = OptionalString(ShortName(die));
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_byte_size:
+            case llvm::dwarf::DW_AT_declaration:
+            case llvm::dwarf::DW_AT_signature:
+                break;
+            case llvm::dwarf::DW_AT_type:
+                enum_->base = resolveType(Referenced(attribute.Value));
+                break;
+            case llvm::dwarf::DW_AT_enum_class:
+                enum_->is_class = true;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    for (const auto &child : die.children()) {
+        if (child.getTag() != llvm::dwarf::DW_TAG_enumerator) {
+            UnhandledChild(child);
+        }
+        auto value = child.find(llvm::dwarf::DW_AT_const_value);
+        if (!value) {
+            throw std::runtime_error("Expected DW_AT_const_value in DW_TAG_enumerator");
+        }
+        enum_->values.emplace_back(OptionalString(ShortName(child)), AsConstant(*value).str());
+    }
+
+    setObject(die, enum_);
+}
+
+void Visitor::visitMember(const llvm::DWARFDie &die) {
+    handleAttribute(die);
+
+    auto member = getObject(die);
+    if (member && die.find(llvm::dwarf::DW_AT_external)) {
+        static_cast<models::Attribute &>(*member).is_static = true;
+    }
+}
+
+void Visitor::visitSubprogram(const llvm::DWARFDie &die) {
+    if (!die.find(llvm::dwarf::DW_AT_decl_file) || !die.find(llvm::dwarf::DW_AT_decl_line)
+        || !Truthy(OptionalString(ShortName(die)))) {
+        return;
+    }
+
+    auto parent = die.getParent();
+    bool is_member_function = parent.isValid() && IsTypeTag(parent.getTag());
+
+    // If a type, variable, or function declared in a namespace is defined outside the body of
+    // the namespace declaration, that type, variable, or function definition entry has a
+    // DW_AT_specification attribute whose value is a reference to the debugging information
+    // entry representing the declaration of the type, variable or function. Type, variable, or
+    // function entries with a DW_AT_specification attribute do not need to duplicate information
+    // provided by the declaration entry referenced by the specification attribute.
+    auto function = std::make_shared<models::Function>();
+    llvm::DWARFDie spec;
+    std::shared_ptr<models::Function> declaration;
+    if (auto spec_attr = die.find(llvm::dwarf::DW_AT_specification)) {
+        spec = Referenced(*spec_attr);
+        if (spec.getTag() != llvm::dwarf::DW_TAG_subprogram) {
+            throw std::runtime_error(
+                "Expected DW_TAG_subprogram for DW_AT_specification attribute.");
+        }
+
+        visit(spec);
+        declaration = std::static_pointer_cast<models::Function>(getObject(spec));
+        if (!declaration) {
+            return;
+        }
+
+        if (die.find(llvm::dwarf::DW_AT_object_pointer) && declaration->is_static) {
+            // we have the object pointer (i.e., this), so this cannot be a static member function
+            throw std::runtime_error("Expect non-static member function.");
+        }
+
+        // this is a definition outside the body of the namespace, use fully qualified name
+        std::string name;
+        llvm::raw_string_ostream os(name);
+        llvm::DWARFTypePrinter printer(os);
+        if (auto scope = spec.getParent(); scope.isValid()) {
+            printer.appendScopes(scope);
+        }
+        printer.appendUnqualifiedName(spec);
+        os.flush();
+
+        function->name = name;
+        function->returns = declaration->returns;
+        function->is_const = declaration->is_const;
+    } else {
+        if (die.find(llvm::dwarf::DW_AT_artificial)) {
+            return;
+        }
+
+        std::string name = ShortName(die);
+        std::optional<std::string> returns = "void";
+        if (auto ret = die.find(llvm::dwarf::DW_AT_type)) {
+            returns = resolveType(Referenced(*ret));
+        }
+
+        // constructors, destructors and operators should have no return type
+        auto parent_name = parent.isValid() ? OptionalString(ShortName(parent)) : std::nullopt;
+        if (StartsWith(name, "operator ")) {
+            returns = std::nullopt;
+        } else if (auto class_name = StripTemplateArguments(parent_name.value_or(""));
+                   !class_name.empty()) {
+            auto function_name = StripTemplateArguments(name);
+            if (function_name == class_name || function_name == "~" + class_name) {
+                returns = std::nullopt;
+            }
+        }
+
+        function->name = name;
+        function->returns = returns;
+        // for member function, we set is_static to true by default, unless we find the `this`
+        // pointer later
+        function->is_static = is_member_function;
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_linkage_name:
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_low_pc:
+            case llvm::dwarf::DW_AT_high_pc:
+            case llvm::dwarf::DW_AT_frame_base:
+            case llvm::dwarf::DW_AT_call_all_calls:
+            case llvm::dwarf::DW_AT_calling_convention:
+            case llvm::dwarf::DW_AT_GNU_all_call_sites:
+            case llvm::dwarf::DW_AT_declaration:
+            case llvm::dwarf::DW_AT_prototyped:
+            case llvm::dwarf::DW_AT_artificial:
+            case llvm::dwarf::DW_AT_specification:
+            case llvm::dwarf::DW_AT_reference:
+            case llvm::dwarf::DW_AT_rvalue_reference:
+            case llvm::dwarf::DW_AT_external:
+            case llvm::dwarf::DW_AT_type:
+            case llvm::dwarf::DW_AT_object_pointer:
+            case llvm::dwarf::DW_AT_abstract_origin:
+            // only used by the vtable slots, which the native driver does not write
+            case llvm::dwarf::DW_AT_vtable_elem_location:
+            case llvm::dwarf::DW_AT_containing_type:
+                break;
+            case llvm::dwarf::DW_AT_inline: {
+                auto inline_ = AsConstant(attribute.Value).value;
+                function->is_inline = inline_ == llvm::dwarf::DW_INL_declared_not_inlined
+                                      || inline_ == llvm::dwarf::DW_INL_declared_inlined;
+                break;
+            }
+            case llvm::dwarf::DW_AT_noreturn:
+                function->noreturn = true;
+                break;
+            case llvm::dwarf::DW_AT_explicit:
+                function->is_explicit = true;
+                break;
+            case llvm::dwarf::DW_AT_accessibility:
+                function->access = static_cast<llvm::dwarf::AccessAttribute>(
+                    AsConstant(attribute.Value).value);
+                break;
+            case llvm::dwarf::DW_AT_virtuality:
+                function->virtuality = static_cast<llvm::dwarf::VirtualityAttribute>(
+                    AsConstant(attribute.Value).value);
+                if (function->virtuality == llvm::dwarf::DW_VIRTUALITY_none) {
+                    throw std::runtime_error("Expected non-NONE virtuality");
+                }
+                break;
+            case llvm::dwarf::DW_AT_deleted:
+                function->is_deleted = true;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    std::vector<llvm::DWARFDie> template_params;
+    bool first_param_seen = false;
+    for (const auto &child : die.children()) {
+        switch (child.getTag()) {
+            case llvm::dwarf::DW_TAG_label:
+            case llvm::dwarf::DW_TAG_lexical_block:
+            case llvm::dwarf::DW_TAG_variable:
+            case llvm::dwarf::DW_TAG_inlined_subroutine:
+            case llvm::dwarf::DW_TAG_call_site:
+            case llvm::dwarf::DW_TAG_typedef:
+            case llvm::dwarf::DW_TAG_imported_module:
+            case llvm::dwarf::DW_TAG_imported_declaration:
+            case llvm::dwarf::DW_TAG_enumeration_type:
+            case llvm::dwarf::DW_TAG_class_type:
+            case llvm::dwarf::DW_TAG_structure_type:
+            case llvm::dwarf::DW_TAG_union_type:
+            case llvm::dwarf::DW_TAG_GNU_call_site:
+                // TODO: handle local variables, types and functions
+                break;
+            case llvm::dwarf::DW_TAG_template_type_parameter:
+            case llvm::dwarf::DW_TAG_template_value_parameter:
+            case llvm::dwarf::DW_TAG_GNU_template_parameter_pack:
+            case llvm::dwarf::DW_TAG_GNU_template_template_param:
+                template_params.push_back(child);
+                break;
+            case llvm::dwarf::DW_TAG_formal_parameter: {
+                bool is_first_param = !first_param_seen;
+                first_param_seen = true;
+                if (child.find(llvm::dwarf::DW_AT_artificial)) {
+                    // this is likely to be the `this` pointer, check for constness
+                    if (is_first_param && is_member_function) {
+                        function->is_static = false;
+                        // it should be a pointer_type to a const_type for a const `this` pointer
+                        auto t = ReferencedType(child).resolveTypeUnitReference();
+                        if (!t.isValid() || t.getTag() != llvm::dwarf::DW_TAG_pointer_type) {
+                            break;
+                        }
+                        t = ReferencedType(t).resolveTypeUnitReference();
+                        if (!t.isValid() || t.getTag() != llvm::dwarf::DW_TAG_const_type) {
+                            break;
+                        }
+                        function->is_const = true;
+                    }
+
+                    // always ignore compiler-generated implicit parameters (e.g., this / vtt)
+                    break;
+                }
+
+                models::Parameter parameter;
+                parameter.name = OptionalString(ShortName(child));
+                parameter.type = resolveSplitType(ReferencedType(child));
+                function->parameters.push_back(std::move(parameter));
+                break;
+            }
+            case llvm::dwarf::DW_TAG_unspecified_parameters: {
+                models::Parameter parameter;
+                parameter.name = "";
+                parameter.kind = models::ParameterKind::Variadic;
+                function->parameters.push_back(std::move(parameter));
+                break;
+            }
+            default:
+                UnhandledChild(child);
+        }
+    }
+
+    function->linkage_name = OptionalString(LinkageName(die));
+
+    // sync parameter names from definition to declaration
+    std::optional<FunctionKey> key;
+    if (Truthy(function->linkage_name)) {
+        // c++ functions with external linkage
+        key = FunctionKey(*function->linkage_name, function->parameters.size());
+    } else if (die.find(llvm::dwarf::DW_AT_external) && !is_member_function) {
+        // c functions with external linkage
+        key = FunctionKey(ShortName(die), function->parameters.size());
+    }
+
+    if (key) {
+        std::vector<std::shared_ptr<models::Function>> functions = {function};
+        // if this is a definition of a class constructor, it has a DW_AT_specification pointing
+        // to the declaration with no DW_AT_linkage_name. Since we know the relationship, we can
+        // manually add the declaration to the function map
+        if (spec.isValid() && !Truthy(OptionalString(LinkageName(spec)))) {
+            functions.push_back(declaration);
+        }
+
+        std::vector<std::optional<std::string>> param_names;
+        for (const auto &parameter : function->parameters) {
+            param_names.push_back(parameter.name);
+        }
+        registerFunction(*key, functions, param_names);
+    }
+
+    if (!template_params.empty()) {
+        // without declaration as there is no trivial way to infer that
+        function->template_ = std::make_shared<models::Template>();
+        function->template_->name = "";
+        for (const auto &template_param : template_params) {
+            visit(template_param);
+            function->template_->parameters.push_back(getTemplateParameter(template_param));
+        }
+    }
+
+    setObject(die, function);
+}
+
+void Visitor::visitImportedModule(const llvm::DWARFDie &die) {
+    if (!Truthy(DeclFileName(die)) || !DeclLine(die)) {
+        throw std::runtime_error("No declaration file or line");
+    }
+
+    auto import_attr = die.find(llvm::dwarf::DW_AT_import);
+    if (!import_attr) {
+        throw std::runtime_error("Expected DW_AT_import in DW_TAG_imported_module");
+    }
+    auto import_die = Referenced(*import_attr);
+    if (import_die.getTag() != llvm::dwarf::DW_TAG_namespace) {
+        throw std::runtime_error("Expected DW_TAG_namespace for DW_AT_import attribute. Got: "
+                                 + TagName(import_die.getTag()));
+    }
+    visit(import_die);
+
+    auto imported_module = std::make_shared<models::ImportedModule>();
+    imported_module->name = "";
+    imported_module->import_ = getNamespace(import_die);
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_import:
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    setObject(die, imported_module);
+}
+
+void Visitor::visitImportedDeclaration(const llvm::DWARFDie &die) {
+    if (!Truthy(DeclFileName(die)) || !DeclLine(die)) {
+        throw std::runtime_error("No declaration file or line");
+    }
+
+    auto import_attr = die.find(llvm::dwarf::DW_AT_import);
+    if (!import_attr) {
+        throw std::runtime_error("Expected DW_AT_import in DW_TAG_imported_declaration");
+    }
+    auto import_die = Referenced(*import_attr);
+    visit(import_die);
+    if (!isVisited(import_die)) {
+        return;
+    }
+
+    auto imported_decl = std::make_shared<models::ImportedDeclaration>();
+    if (import_die.getTag() == llvm::dwarf::DW_TAG_namespace) {
+        imported_decl->name = OptionalString(ShortName(die));
+        imported_decl->import_namespace = getNamespace(import_die);
+    } else {
+        imported_decl->name = "";
+        imported_decl->import_type = resolveType(import_die);
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_import:
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    setObject(die, imported_decl);
+}
+
+void Visitor::visitTemplateTypeParameter(const llvm::DWARFDie &die) {
+    auto param = std::make_shared<models::TemplateParameter>(models::TemplateParameterKind::Type);
+    param->name = OptionalString(ShortName(die));
+
+    // A template type parameter entry has a DW_AT_type attribute describing the actual type by
+    // which the formal is replaced.
+    if (auto type = die.find(llvm::dwarf::DW_AT_type)) {
+        param->type = resolveType(Referenced(*type));
+    } else {
+        param->type = "void";
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_type:
+                break;
+            case llvm::dwarf::DW_AT_default_value:
+                param->default_ = param->type;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    for (const auto &child : die.children()) {
+        UnhandledChild(child);
+    }
+
+    parameters_[Key(die)] = param;
+}
+
+void Visitor::visitTemplateValueParameter(const llvm::DWARFDie &die) {
+    auto param
+        = std::make_shared<models::TemplateParameter>(models::TemplateParameterKind::Constant);
+    param->name = OptionalString(ShortName(die));
+    param->type = resolveType(ReferencedType(die));
+
+    if (auto value = die.find(llvm::dwarf::DW_AT_const_value)) {
+        param->value = AsConstant(*value).str();
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_type:
+            case llvm::dwarf::DW_AT_const_value:
+            case llvm::dwarf::DW_AT_location:
+                break;
+            case llvm::dwarf::DW_AT_default_value:
+                param->default_ = param->value;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    for (const auto &child : die.children()) {
+        UnhandledChild(child);
+    }
+
+    parameters_[Key(die)] = param;
+}
+
+void Visitor::visitTemplateParameterPack(const llvm::DWARFDie &die) {
+    auto param = std::make_shared<models::TemplateParameter>(models::TemplateParameterKind::Pack);
+    param->name = OptionalString(ShortName(die));
+
+    for (const auto &attribute : die.attributes()) {
+        if (attribute.Attr != llvm::dwarf::DW_AT_name) {
+            UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    std::vector<std::shared_ptr<models::TemplateParameter>> parameters;
+    for (const auto &child : die.children()) {
+        auto tag = child.getTag();
+        if (tag != llvm::dwarf::DW_TAG_template_type_parameter
+            && tag != llvm::dwarf::DW_TAG_template_value_parameter) {
+            UnhandledChild(child);
+        }
+        visit(child);
+        parameters.push_back(getTemplateParameter(child));
+    }
+
+    if (!parameters.empty()) {
+        bool all_values = true;
+        bool same_type = true;
+        for (const auto &p : parameters) {
+            if (p->kind != parameters.front()->kind) {
+                throw std::runtime_error("Parameter kind mismatch");
+            }
+            all_values = all_values && p->value.has_value();
+            same_type = same_type && p->type == parameters.front()->type;
+        }
+        if (all_values) {
+            param->type = same_type ? parameters.front()->type : "auto";
+        }
+
+        param->parameters = std::move(parameters);
+    }
+
+    parameters_[Key(die)] = param;
+}
+
+void Visitor::visitTemplateTemplateParameter(const llvm::DWARFDie &die) {
+    auto param
+        = std::make_shared<models::TemplateParameter>(models::TemplateParameterKind::Template);
+    param->name = OptionalString(ShortName(die));
+    if (auto value = die.find(llvm::dwarf::DW_AT_GNU_template_name)) {
+        const char *name = llvm::dwarf::toString(value, nullptr);
+        if (!name) {
+            throw std::runtime_error("Invalid string value");
+        }
+        param->type = name;
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_GNU_template_name:
+                break;
+            case llvm::dwarf::DW_AT_default_value:
+                param->default_ = param->type;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    for (const auto &child : die.children()) {
+        UnhandledChild(child);
+    }
+
+    parameters_[Key(die)] = param;
+}
+
+void Visitor::genericVisit(const llvm::DWARFDie &die) {
+    for (const auto &child : die.children()) {
+        visit(child);
+    }
+}
+
+void Visitor::add(const std::string &path, uint64_t line, const models::ObjectPtr &obj) {
+    if (finalized_.count(path)) {
+        // the file has already been written, this only happens with references across units
+        ++dropped_;
+        return;
+    }
+
+    auto &lines = files_[path][line];
+    if (lines.size() >= 8) {
+        // too many items on a single line (template instantiations?)
+        return;
+    }
+
+    lines.push_back(obj);
+}
+
+std::shared_ptr<models::Template>
+Visitor::registerTemplate(Templates &templates, uint64_t line, const models::Template &tmpl) {
+    if (!tmpl.declaration) {
+        return nullptr;
+    }
+
+    // make a copy for template declaration
+    auto declaration = std::make_shared<models::Template>(tmpl);
+    declaration->parameters.clear();
+    for (const auto &parameter : tmpl.parameters) {
+        declaration->parameters.push_back(parameter->toDeclaration());
+    }
+
+    // try to merge with existing templates
+    auto &existing = templates[line];
+    for (const auto &t : existing) {
+        if (t->merge(*declaration)) {
+            return nullptr;
+        }
+    }
+
+    existing.push_back(declaration);
+    return declaration;
+}
+
+void Visitor::registerFunction(const FunctionKey &key,
+                               const std::vector<std::shared_ptr<models::Function>> &functions,
+                               const std::vector<std::optional<std::string>> &param_names) {
+    dirty_functions_.insert(key);
+    auto &registered = functions_[key];
+    registered.insert(registered.end(), functions.begin(), functions.end());
+
+    auto it = param_names_.find(key);
+    if (it == param_names_.end()) {
+        param_names_.emplace(key, param_names);
+        return;
+    }
+
+    auto &names = it->second;
+    if (names.size() != param_names.size()) {
+        throw std::runtime_error("Parameter count mismatch");
+    }
+    for (size_t i = 0; i < param_names.size(); ++i) {
+        if (!names[i] && param_names[i]) {
+            names[i] = param_names[i];
+        }
+    }
+}
+
+void Visitor::handleAttribute(const llvm::DWARFDie &die) {
+    auto name = OptionalString(ShortName(die));
+    if (!Truthy(DeclFileName(die)) || !DeclLine(die) || !Truthy(name)) {
+        return;
+    }
+
+    if (auto spec = die.find(llvm::dwarf::DW_AT_specification)) {
+        if (Referenced(*spec).getTag() != llvm::dwarf::DW_TAG_member) {
+            throw std::runtime_error("Expected DW_TAG_member");
+        }
+        return;
+    }
+
+    auto variable = std::make_shared<models::Attribute>();
+    variable->name = name;
+    variable->linkage_name = OptionalString(LinkageName(die));
+    auto ty = ResolveTypeUnitReference(ReferencedType(die));
+    if (!ShortName(ty) && IsTypeTag(ty.getTag())) {
+        // this is an in-place declaration
+        visit(ty);
+        auto value = getObject(ty);
+        if (!value) {
+            throw std::runtime_error("Expected a type declared in place");
+        }
+        value->is_implicit = true;
+        variable->inline_type = value;
+    } else {
+        variable->type = resolveSplitType(ty);
+    }
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_linkage_name:
+            case llvm::dwarf::DW_AT_external:
+            case llvm::dwarf::DW_AT_location:
+            case llvm::dwarf::DW_AT_declaration:
+            case llvm::dwarf::DW_AT_byte_size:
+            case llvm::dwarf::DW_AT_data_bit_offset:
+            case llvm::dwarf::DW_AT_bit_offset:
+            case llvm::dwarf::DW_AT_specification:
+            case llvm::dwarf::DW_AT_type:
+                break;
+            case llvm::dwarf::DW_AT_const_value:
+                variable->default_value = DefaultValue(
+                    variable->type ? variable->type->before : "", AsConstant(attribute.Value));
+                break;
+            case llvm::dwarf::DW_AT_alignment:
+                variable->alignment = AsConstant(attribute.Value).value;
+                break;
+            case llvm::dwarf::DW_AT_accessibility:
+                variable->access = static_cast<llvm::dwarf::AccessAttribute>(
+                    AsConstant(attribute.Value).value);
+                break;
+            case llvm::dwarf::DW_AT_data_member_location:
+                // location descriptions (DWARF v2) are not supported, only constant offsets
+                if (!IsBlock(attribute.Value.getForm())) {
+                    variable->offset = AsConstant(attribute.Value).value;
+                }
+                break;
+            case llvm::dwarf::DW_AT_bit_size:
+                variable->bit_size = AsConstant(attribute.Value).value;
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    std::vector<llvm::DWARFDie> template_params;
+    for (const auto &child : die.children()) {
+        auto tag = child.getTag();
+        if (tag != llvm::dwarf::DW_TAG_template_type_parameter
+            && tag != llvm::dwarf::DW_TAG_template_value_parameter
+            && tag != llvm::dwarf::DW_TAG_GNU_template_parameter_pack) {
+            UnhandledChild(child);
+        }
+        template_params.push_back(child);
+    }
+
+    if (!template_params.empty()) {
+        if (!variable->type) {
+            throw std::runtime_error("Expected the type of a variable template");
+        }
+        auto declaration = std::make_shared<models::Attribute>(*variable);
+        declaration->type->before = StripTemplateArguments(declaration->type->before);
+        declaration->default_value = std::nullopt;
+        declaration->is_declaration = true;
+
+        variable->template_ = std::make_shared<models::Template>();
+        variable->template_->name = "";
+        variable->template_->declaration = declaration;
+        for (const auto &template_param : template_params) {
+            visit(template_param);
+            variable->template_->parameters.push_back(getTemplateParameter(template_param));
+        }
+    }
+
+    setObject(die, variable);
+}
+
+void Visitor::handleStruct(const llvm::DWARFDie &die, models::Kind kind) {
+    std::shared_ptr<models::Struct> struct_;
+    if (die.find(llvm::dwarf::DW_AT_signature)) {
+        auto signature = ResolveTypeUnitReference(die);
+        visitSignature(signature);
+        auto declaration = getObject(signature);
+        if (!declaration || !declaration->isStruct()) {
+            throw std::runtime_error("Expected valid declaration");
+        }
+        struct_ = std::static_pointer_cast<models::Struct>(declaration->clone());
+    } else {
+        struct_ = std::make_shared<models::Struct>(kind);
+        struct_->name = OptionalString(ShortName(die));
+    }
+
+    auto access = struct_->kind == models::Kind::Class ? llvm::dwarf::DW_ACCESS_private
+                                                        : llvm::dwarf::DW_ACCESS_public;
+
+    for (const auto &attribute : die.attributes()) {
+        switch (attribute.Attr) {
+            case llvm::dwarf::DW_AT_name:
+            case llvm::dwarf::DW_AT_decl_file:
+            case llvm::dwarf::DW_AT_decl_line:
+            case llvm::dwarf::DW_AT_calling_convention:
+            case llvm::dwarf::DW_AT_declaration:
+            case llvm::dwarf::DW_AT_containing_type:
+            case llvm::dwarf::DW_AT_export_symbols:
+            case llvm::dwarf::DW_AT_signature: // used by DWARFv4, removed in DWARFv5
+                break;
+            case llvm::dwarf::DW_AT_alignment:
+                struct_->alignment = AsConstant(attribute.Value).value;
+                break;
+            case llvm::dwarf::DW_AT_byte_size:
+                struct_->byte_size = AsConstant(attribute.Value).value;
+                break;
+            case llvm::dwarf::DW_AT_accessibility:
+                struct_->access = static_cast<llvm::dwarf::AccessAttribute>(
+                    AsConstant(attribute.Value).value);
+                break;
+            default:
+                UnhandledAttribute(attribute.Attr);
+        }
+    }
+
+    setObject(die, struct_);
+
+    std::vector<llvm::DWARFDie> template_params;
+    for (const auto &child : die.children()) {
+        auto tag = child.getTag();
+        if (IsTypeTag(tag) || tag == llvm::dwarf::DW_TAG_typedef
+            || tag == llvm::dwarf::DW_TAG_member || tag == llvm::dwarf::DW_TAG_subprogram
+            || tag == llvm::dwarf::DW_TAG_imported_module
+            || tag == llvm::dwarf::DW_TAG_imported_declaration) {
+            auto line = DeclLine(child);
+            if (!line) {
+                continue;
+            }
+
+            auto &lines = struct_->members[line];
+            if (lines.size() > 4) {
+                // too many items on a single line (template instantiations?)
+                continue;
+            }
+
+            visit(child);
+            auto member = getObject(child);
+            if (!member) {
+                continue;
+            }
+
+            // If no accessibility attribute is present, private access is assumed for members of
+            // a class and public access is assumed for members of a structure, union, or
+            // interface
+            if (!member->access) {
+                member->access = access;
+            }
+
+            if (const auto &tmpl = member->template_) {
+                if (!tmpl->access) {
+                    tmpl->access = access;
+                }
+                if (auto declaration
+                    = registerTemplate(struct_templates_[die.getOffset()], line, *tmpl)) {
+                    lines.push_back(declaration);
+                }
+            }
+
+            lines.push_back(member);
+        } else if (IsTemplateParameterTag(tag)) {
+            template_params.push_back(child);
+        } else if (tag == llvm::dwarf::DW_TAG_inheritance) {
+            std::optional<llvm::dwarf::AccessAttribute> inherit_access;
+            auto base = resolveType(ReferencedType(child));
+            for (const auto &attribute : child.attributes()) {
+                switch (attribute.Attr) {
+                    case llvm::dwarf::DW_AT_type:
+                    case llvm::dwarf::DW_AT_data_member_location:
+                        break;
+                    case llvm::dwarf::DW_AT_accessibility:
+                        inherit_access = static_cast<llvm::dwarf::AccessAttribute>(
+                            AsConstant(attribute.Value).value);
+                        break;
+                    case llvm::dwarf::DW_AT_virtuality:
+                        if (AsConstant(attribute.Value).value == llvm::dwarf::DW_VIRTUALITY_none) {
+                            throw std::runtime_error("Expected non-NONE virtuality");
+                        }
+                        base = "virtual " + base;
+                        break;
+                    default:
+                        UnhandledAttribute(attribute.Attr);
+                }
+            }
+
+            struct_->bases.emplace_back(base, inherit_access);
+        } else {
+            UnhandledChild(child);
+        }
+    }
+
+    if (!template_params.empty()) {
+        auto declaration = std::make_shared<models::Struct>(*struct_);
+        declaration->name = StripTemplateArguments(struct_->name.value_or(""));
+        declaration->bases.clear();
+        declaration->members.clear();
+        declaration->alignment = std::nullopt;
+        declaration->byte_size = std::nullopt;
+        declaration->is_declaration = true;
+
+        struct_->template_ = std::make_shared<models::Template>();
+        struct_->template_->name = "";
+        struct_->template_->declaration = declaration;
+        for (const auto &template_param : template_params) {
+            visit(template_param);
+            struct_->template_->parameters.push_back(getTemplateParameter(template_param));
+        }
+    }
+}
+
+models::ObjectPtr Visitor::getObject(const llvm::DWARFDie &die) const {
+    auto it = objects_.find(Key(die));
+    return it != objects_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<models::Namespace> Visitor::getNamespace(const llvm::DWARFDie &die) const {
+    auto it = namespaces_.find(Key(die));
+    if (it == namespaces_.end()) {
+        throw std::runtime_error("Expected a namespace");
+    }
+    return it->second;
+}
+
+std::shared_ptr<models::TemplateParameter>
+Visitor::getTemplateParameter(const llvm::DWARFDie &die) const {
+    auto it = parameters_.find(Key(die));
+    if (it == parameters_.end()) {
+        throw std::runtime_error("Expected a template parameter");
+    }
+    return it->second;
+}
+
+bool Visitor::isVisited(const llvm::DWARFDie &die) const {
+    auto key = Key(die);
+    return objects_.count(key) || namespaces_.count(key) || parameters_.count(key);
+}
+
+void Visitor::setObject(const llvm::DWARFDie &die, models::ObjectPtr obj) {
+    objects_.emplace(Key(die), std::move(obj));
+}
+
+std::string Visitor::resolveType(const llvm::DWARFDie &die) {
+    auto type_die = ResolveTypeUnitReference(die);
+    auto key = Key(type_die);
+    if (auto it = types_.find(key); it != types_.end()) {
+        return it->second;
+    }
+
+    std::string buffer;
+    llvm::raw_string_ostream os(buffer);
+    llvm::DWARFTypePrinter printer(os);
+    printer.appendQualifiedName(type_die);
+    os.flush();
+    return types_[key] = Strip(buffer);
+}
+
+models::TypeName Visitor::resolveSplitType(const llvm::DWARFDie &die) {
+    auto type_die = ResolveTypeUnitReference(die);
+    auto key = Key(type_die);
+    if (auto it = split_types_.find(key); it != split_types_.end()) {
+        return it->second;
+    }
+
+    std::string before;
+    llvm::raw_string_ostream before_os(before);
+    llvm::DWARFTypePrinter before_printer(before_os);
+    auto inner = before_printer.appendQualifiedNameBefore(type_die);
+    before_os.flush();
+
+    std::string after;
+    llvm::raw_string_ostream after_os(after);
+    llvm::DWARFTypePrinter after_printer(after_os);
+    after_printer.appendUnqualifiedNameAfter(type_die, inner);
+    after_os.flush();
+
+    return split_types_[key] = models::TypeName{Strip(before), Strip(after), true};
+}
+
+} // namespace dwarf2cpp
@@ -0,0 +1,113 @@
+#ifndef DWARF2CPP_VISITOR_H
+#define DWARF2CPP_VISITOR_H
+
+#include "models.h"
+
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/DebugInfo/DWARF/DWARFDie.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace dwarf2cpp {
+
+// Native port of the Visitor of visitor.py, without the unit cache, the selection of files and the
+// checkpoints. Both must be kept in sync so that the native driver generates the same headers.
+class Visitor {
+public:
+    // Called with the path of a file relative to the base directory and its merged objects.
+    using FileCallback = std::function<void(const std::string &, models::File &)>;
+
+    Visitor(llvm::DWARFContext &context, std::string base_dir);
+
+    // Visit every unit. A file is passed to the callback as soon as the last compile unit whose
+    // line table references it has been visited, after which the visitor releases it. If compile
+    // units reference DIEs of other units, files are held until the last of them was visited.
+    void visitFiles(const FileCallback &callback);
+
+    // The number of objects referenced after their file was passed to the callback, which are
+    // missing from it.
+    size_t dropped() const { return dropped_; }
+
+private:
+    using FunctionKey = std::pair<std::string, size_t>;
+    using Templates = std::map<uint64_t, std::vector<std::shared_ptr<models::Template>>>;
+
+    void visit(const llvm::DWARFDie &die);
+    void visitSignature(const llvm::DWARFDie &die);
+    void visitTypeUnit(const llvm::DWARFDie &die);
+    void handleUnit(const llvm::DWARFDie &die);
+    void visitNamespace(const llvm::DWARFDie &die);
+    void visitTypedef(const llvm::DWARFDie &die);
+    void visitEnumerationType(const llvm::DWARFDie &die);
+    void visitMember(const llvm::DWARFDie &die);
+    void visitSubprogram(const llvm::DWARFDie &die);
+    void visitImportedModule(const llvm::DWARFDie &die);
+    void visitImportedDeclaration(const llvm::DWARFDie &die);
+    void visitTemplateTypeParameter(const llvm::DWARFDie &die);
+    void visitTemplateValueParameter(const llvm::DWARFDie &die);
+    void visitTemplateParameterPack(const llvm::DWARFDie &die);
+    void visitTemplateTemplateParameter(const llvm::DWARFDie &die);
+    void genericVisit(const llvm::DWARFDie &die);
+    void handleAttribute(const llvm::DWARFDie &die);
+    void handleStruct(const llvm::DWARFDie &die, models::Kind kind);
+
+    // The children of a compile unit or of a namespace declared in a file of the base directory.
+    void handleDeclaration(const llvm::DWARFDie &child,
+                           const std::shared_ptr<models::Namespace> &namespace_);
+
+    std::pair<std::vector<std::vector<std::string>>, std::vector<bool>> scanLineTables();
+    bool finalize(const std::string &path, const FileCallback &callback);
+    void syncParamNames();
+
+    void add(const std::string &path, uint64_t line, const models::ObjectPtr &obj);
+    std::shared_ptr<models::Template>
+    registerTemplate(Templates &templates, uint64_t line, const models::Template &tmpl);
+    void registerFunction(const FunctionKey &key,
+                          const std::vector<std::shared_ptr<models::Function>> &functions,
+                          const std::vector<std::optional<std::string>> &param_names);
+
+    [[nodiscard]] models::ObjectPtr getObject(const llvm::DWARFDie &die) const;
+    [[nodiscard]] std::shared_ptr<models::Namespace> getNamespace(const llvm::DWARFDie &die) const;
+    [[nodiscard]] std::shared_ptr<models::TemplateParameter>
+    getTemplateParameter(const llvm::DWARFDie &die) const;
+    [[nodiscard]] bool isVisited(const llvm::DWARFDie &die) const;
+    void setObject(const llvm::DWARFDie &die, models::ObjectPtr obj);
+
+    std::string resolveType(const llvm::DWARFDie &die);
+    models::TypeName resolveSplitType(const llvm::DWARFDie &die);
+
+    llvm::DWARFContext &context_;
+    std::string base_dir_;
+
+    // models by DIE, keyed by the offset of the DIE and whether it is in a type unit
+    std::unordered_map<uint64_t, models::ObjectPtr> objects_;
+    std::unordered_map<uint64_t, std::shared_ptr<models::Namespace>> namespaces_;
+    std::unordered_map<uint64_t, std::shared_ptr<models::TemplateParameter>> parameters_;
+    std::unordered_map<uint64_t, std::string> types_;
+    std::unordered_map<uint64_t, models::TypeName> split_types_;
+
+    std::map<std::string, models::File> files_;
+    std::unordered_set<std::string> finalized_;
+    size_t dropped_ = 0;
+    // template declarations by file, and by the offset of the struct declaring them
+    std::unordered_map<std::string, Templates> file_templates_;
+    std::unordered_map<uint64_t, Templates> struct_templates_;
+
+    // functions with external linkage, keyed by (linkage name, number of parameters)
+    std::map<FunctionKey, std::vector<std::optional<std::string>>> param_names_;
+    std::map<FunctionKey, std::vector<std::shared_ptr<models::Function>>> functions_;
+    std::set<FunctionKey> dirty_functions_;
+};
+
+} // namespace dwarf2cpp
+
+#endif // DWARF2CPP_VISITOR_H
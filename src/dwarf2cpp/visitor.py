@@ -2,20 +2,26 @@ import copy
 import logging
 import posixpath
 import struct
+import threading
 import typing
 from collections import defaultdict
 from typing import Any, Callable, Generator
 
 from tqdm import tqdm
 
+from . import profiling
 from ._dwarf import (
     AccessAttribute,
     DWARFContext,
     DWARFDie,
+    DWARFFormValue,
     DWARFTypePrinter,
+    DWARFUnit,
     InlineAttribute,
     VirtualityAttribute,
 )
+from .cache import TypeCache, TypeContribution, UnitCache, UnitContribution
+from .checkpoint import Checkpoint, CheckpointJournal
 from .models import (
     Attribute,
     Class,
@@ -23,11 +29,13 @@ from .models import (
     Function,
     ImportedDeclaration,
     ImportedModule,
+    LayoutMember,
     Namespace,
     Object,
     Parameter,
     ParameterKind,
     Struct,
+    StructLayout,
     Template,
     TemplateParameter,
     TemplateParameterKind,
@@ -52,18 +60,61 @@ def double_to_str(value: float) -> str:
     return s
 
 
+def vtable_slot(value: DWARFFormValue) -> int | None:
+    """Decode the DW_AT_vtable_elem_location of a virtual function, which compilers emit as DW_OP_constu <slot>."""
+    if not value.form.startswith(("DW_FORM_block", "DW_FORM_exprloc")):
+        return value.as_constant()
+
+    expression = value.as_block()
+    if not expression or expression[0] != 0x10:  # DW_OP_constu
+        return None
+
+    result = shift = 0
+    for byte in expression[1:]:
+        result |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return result
+
+    return None
+
+
 class Visitor:
     """
     Visitor iterators on compile units to extract data from them.
     """
 
-    def __init__(self, context: DWARFContext, base_dir: str):
+    def __init__(
+        self,
+        context: DWARFContext,
+        base_dir: str,
+        cache: UnitCache | None = None,
+        type_cache: TypeCache | None = None,
+        selection: set[str] | None = None,
+        journal: CheckpointJournal | None = None,
+    ):
         self.context = context
+        self._selection = selection
+        self._journal = journal
+        self._next_unit = 0
+        self._cancelled = threading.Event()
+        self._cache = cache
+        self._type_cache = type_cache
+        self._contributions: list[UnitContribution | TypeContribution] = []
         self._files: dict[str, dict[int, list[Object]]] = defaultdict(lambda: defaultdict(list))
         self._base_dir = base_dir
+        # models by DIE offset, those of compile units are released once no unit left can reference them
         self._objects = {}
-        self._param_names: dict[str, list[str]] = {}
-        self._functions: dict[str, list[Function]] = defaultdict(list)
+        self._type_unit_objects = {}
+        # index of the last compile unit to visit whose DIEs can reference DIEs of other units
+        self._last_cross_unit = -1
+        # number of objects referenced after their file was written, which are missing from it
+        self.dropped = 0
+        # functions with external linkage, keyed by (linkage name, number of parameters)
+        self._param_names: dict[tuple[str, int], list[str]] = {}
+        self._functions: dict[tuple[str, int], list[Function]] = defaultdict(list)
+        self._dirty_functions: set[tuple[str, int]] = set()
+        self._finalized: set[str] = set()
         self._templates: dict[str | int, dict[int, list[Template]]] = defaultdict(lambda: defaultdict(list))
         self._types = {}
 
@@ -71,19 +122,39 @@ class Visitor:
     def files(self) -> Generator[tuple[str, dict[int, list[Object]]], None, None]:
         """Build and return the files attached to this visitor.
 
-        This method triggers a complete visit of the compile units.
+        This method triggers a complete visit of the compile units. A file is yielded as soon as the last compile unit
+        whose line table references it has been visited, after which the visitor no longer holds on to it. If compile
+        units reference DIEs of other units (e.g., with LTO), files are held until the last of those units has been
+        visited as well, since the references can reach any file.
+
+        If a selection of files was given, only the compile units referencing them are visited and only those are
+        yielded.
+
+        If a checkpoint journal was given, the state is written to it periodically after a compile unit was visited.
+        If the visitor was restored from a checkpoint, the units visited before it are skipped.
 
         Returns:
             List of files
         """
-        for i, tu in tqdm(
-            enumerate(self.context.types_section_units),
-            desc="Visiting type units",
-            total=self.context.num_type_units,
-            bar_format="[{n_fmt}/{total_fmt}] {desc} [{elapsed}, {rate_fmt}]",
-        ):
-            tu_die = tu.unit_die
-            self.visit(tu_die)
+        # when resuming, the contributions of the type units to the files are part of the checkpoint
+        if self._next_unit == 0:
+            for i, tu in tqdm(
+                enumerate(self.context.types_section_units),
+                desc="Visiting type units",
+                total=self.context.num_type_units,
+                bar_format="[{n_fmt}/{total_fmt}] {desc} [{elapsed}, {rate_fmt}]",
+            ):
+                if self._cancelled.is_set():
+                    return
+
+                with profiling.span("type_units", unit_offset=tu.offset):
+                    self._visit_unit(tu)
+
+            profiling.boundary("type_units")
+
+        with profiling.span("line_tables"):
+            pending, units = self._scan_line_tables()
+        profiling.boundary("line_tables")
 
         for i, cu in (
             pbar := tqdm(
@@ -92,30 +163,212 @@ class Visitor:
                 bar_format="[{n_fmt}/{total_fmt}] {desc}",
             )
         ):
-            cu_die = cu.unit_die
-            compilation_dir = cu.compilation_dir.replace("\\", "/")
+            if self._cancelled.is_set():
+                return
 
-            if not compilation_dir.startswith(self._base_dir):
+            if i < self._next_unit:
+                pbar.set_description_str("Skipping compile units visited before the checkpoint")
+                continue
+
+            if i not in units:
+                compilation_dir = cu.compilation_dir.replace("\\", "/")
                 pbar.set_description_str(f"Skipping compile unit {compilation_dir}")
                 continue
 
+            cu_die = cu.unit_die
             rel_path = posixpath.relpath(cu_die.short_name, self._base_dir)
             pbar.set_description_str(f"Visiting compile unit {rel_path}")
-            self.visit(cu_die)
+            with profiling.span("compile_units", unit=rel_path, unit_offset=cu.offset):
+                self._visit_unit(cu)
+
+            for path in pending.pop(i, []):
+                if result := self._finalize(path):
+                    yield result
+
+            if i >= self._last_cross_unit:
+                # none of the units left to visit can reference the DIEs of the units visited so far
+                self._objects.clear()
+
+            # the files yielded above have been consumed by now
+            if self._journal and self._journal.due():
+                self._journal.write(i + 1, self._checkpoint_state())
+
+        profiling.boundary("compile_units")
+
+        # files that are not referenced by the line table of any visited compile unit (e.g., only from type units)
+        for path in list(self._files.keys()):
+            if result := self._finalize(path):
+                yield result
+
+        profiling.boundary("remaining_files")
+
+        if self.dropped:
+            logger.warning(f"Dropped {self.dropped} declarations referenced after their file was written")
+
+        if self._journal:
+            self._journal.remove()
+
+    def cancel(self) -> None:
+        """Stop the iteration of the files before the next unit is visited. This can be called from any thread."""
+        self._cancelled.set()
+
+    def restore(self, checkpoint: Checkpoint) -> None:
+        """Restore the state of a previous run from a checkpoint. The compile units visited before it are skipped."""
+        state = checkpoint.state
+        for path, file in state["files"].items():
+            self._files[path].update(file)
+        for key, templates in state["templates"].items():
+            self._templates[key].update(templates)
+        self._functions.update(state["functions"])
+        self._param_names = state["param_names"]
+        self._dirty_functions = state["dirty_functions"]
+        self._finalized = state["finalized"]
+        # the models and type names of the DIEs visited before the checkpoint, so that they are not visited again
+        self._objects = state["objects"]
+        self._type_unit_objects = state["type_unit_objects"]
+        self._types = state["types"]
+        self.dropped = state["dropped"]
+        self._next_unit = checkpoint.next_unit
+
+    def _checkpoint_state(self) -> dict[str, Any]:
+        # the nested defaultdicts are restored by restore
+        return {
+            "files": {path: dict(file) for path, file in self._files.items()},
+            "templates": {key: dict(templates) for key, templates in self._templates.items()},
+            "functions": dict(self._functions),
+            "param_names": self._param_names,
+            "dirty_functions": self._dirty_functions,
+            "finalized": self._finalized,
+            "objects": self._objects,
+            "type_unit_objects": self._type_unit_objects,
+            "types": self._types,
+            "dropped": self.dropped,
+        }
+
+    def _visit_unit(self, unit: DWARFUnit) -> None:
+        """Visit a unit, or replay its contribution from the cache if its contents did not change."""
+        key = self._cache.key(unit) if self._cache else None
+        if key and (contribution := self._cache.load(key)) is not None:
+            contribution.rebase(unit.offset)
+            self._read_addresses(contribution)
+            self._replay(contribution)
+            return
+
+        if not key:
+            self.visit(unit.unit_die)
+            return
+
+        contribution = UnitContribution(unit_offset=unit.offset, unit_length=unit.length)
+        self._contributions.append(contribution)
+        try:
+            self.visit(unit.unit_die)
+        finally:
+            self._contributions.pop()
+
+        self._cache.store(key, contribution)
+
+    def _visit_signature(self, die: DWARFDie) -> None:
+        """Visit the type described by a type unit, or load it from the type cache by its signature."""
+        signature = die.unit.type_signature
+        if self._get(die) or not self._type_cache or signature is None:
+            self.visit(die)
+            return
+
+        if (cached := self._type_cache.load(signature)) is not None:
+            self._set(die, cached.type)
+            for key, functions, param_names in cached.functions:
+                self._register_function(key, functions, param_names)
+            return
 
-        for key, param_names in self._param_names.items():
-            functions = self._functions[key]
+        contribution = TypeContribution()
+        self._contributions.append(contribution)
+        try:
+            self.visit(die)
+        finally:
+            self._contributions.pop()
+
+        if isinstance(obj := self._get(die), (Struct, Enum)):
+            contribution.type = obj
+            self._type_cache.store(signature, contribution)
+
+    def _read_addresses(self, contribution: UnitContribution) -> None:
+        """Read the addresses of the functions of a cached contribution again, since relinking moves them."""
+        for offset, functions in contribution.addresses:
+            die = self.context.die_at(offset)
+            low_pc = die.find("DW_AT_low_pc") if die is not None else None
+            # functions discarded by the linker start at 0
+            address = (low_pc.as_address() or None) if low_pc else None
             for function in functions:
-                for i, param in enumerate(function.parameters):
-                    if param.name is None:
-                        param.name = param_names[i]
+                function.address = function.address or address
 
-        # merge file with others that have the same relative path
-        for path, file in self._files.items():
-            rel_path = str(posixpath.relpath(path, self._base_dir))
-            if rel_path.startswith("../"):
+    def _replay(self, contribution: UnitContribution) -> None:
+        for decl_file, decl_line, obj in contribution.objects:
+            if isinstance(obj, Template) and not self._insert_template(decl_file, decl_line, obj):
                 continue
 
+            self._add(decl_file, decl_line, obj)
+
+        for key, functions, param_names in contribution.functions:
+            self._register_function(key, functions, param_names)
+
+    def _is_visited(self, cu: DWARFUnit) -> bool:
+        compilation_dir = cu.compilation_dir.replace("\\", "/")
+        return compilation_dir.startswith(self._base_dir)
+
+    def _scan_line_tables(self) -> tuple[dict[int, list[str]], set[int]]:
+        """Find the compile units to visit and map each of them to the files that can be written after it."""
+        units: set[int] = set()
+        cross_units: set[int] = set()
+        last_units: dict[str, int] = {}
+        for i, cu in tqdm(
+            enumerate(self.context.compile_units),
+            desc="Scanning line tables",
+            total=self.context.num_compile_units,
+            bar_format="[{n_fmt}/{total_fmt}] {desc} [{elapsed}, {rate_fmt}]",
+        ):
+            if not self._is_visited(cu):
+                continue
+
+            if cu.has_cross_unit_references:
+                cross_units.add(i)
+
+            for path in cu.line_table_files:
+                path = posixpath.normpath(path.replace("\\", "/"))
+                if not path.startswith(self._base_dir):
+                    continue
+
+                if self._selection is None or path in self._selection:
+                    units.add(i)
+                    last_units[path] = i
+
+            if self._selection is None:
+                units.add(i)
+
+        self._last_cross_unit = max(units & cross_units, default=-1)
+        pending: dict[int, list[str]] = defaultdict(list)
+        for path, i in last_units.items():
+            pending[max(i, self._last_cross_unit)].append(path)
+
+        return pending, units
+
+    def _finalize(self, path: str) -> tuple[str, dict[int, list[Object]]] | None:
+        """Merge a file and release it from the visitor. No more objects will be added to it afterward."""
+        self._sync_param_names()
+
+        self._finalized.add(path)
+        self._templates.pop(path, None)
+        file = self._files.pop(path, None)
+        if file is None:
+            return None
+
+        self._release_functions(file)
+
+        # merge file with others that have the same relative path
+        rel_path = str(posixpath.relpath(path, self._base_dir))
+        if rel_path.startswith("../"):
+            return None
+
+        with profiling.span("merge", file=rel_path):
             for line, objects in file.items():
                 result = []
 
@@ -131,7 +384,48 @@ class Visitor:
 
                 file[line] = result
 
-            yield rel_path, file
+        return rel_path, file
+
+    def _release_functions(self, file: dict[int, list[Object]]) -> None:
+        """Stop syncing the parameter names of the functions of a file, which is written as is."""
+        stack = [obj for objects in file.values() for obj in objects]
+        while stack:
+            obj = stack.pop()
+            if isinstance(obj, Struct):
+                stack.extend(member for members in obj.members.values() for member in members)
+            elif isinstance(obj, Function) and (functions := self._functions.get(self._function_key(obj))):
+                functions[:] = [function for function in functions if function is not obj]
+
+    @staticmethod
+    def _function_key(function: Function) -> tuple[str, int]:
+        return function.linkage_name or function.name, len(function.parameters)
+
+    def _sync_param_names(self) -> None:
+        """Sync parameter names from definitions to declarations for functions seen since the last sync."""
+        with profiling.span("param_sync", functions=len(self._dirty_functions)):
+            for key in self._dirty_functions:
+                param_names = self._param_names[key]
+                unnamed = []
+                for function in self._functions[key]:
+                    for i, param in enumerate(function.parameters):
+                        if param.name is None:
+                            param.name = param_names[i]
+
+                    # the names of a function are final once all of them are known
+                    if any(param.name is None for param in function.parameters):
+                        unnamed.append(function)
+
+                if unnamed:
+                    self._functions[key] = unnamed
+                else:
+                    del self._functions[key]
+
+            self._dirty_functions.clear()
+
+    def model(self, die: DWARFDie) -> Any | None:
+        """Visit a single DIE on demand and return its model, without adding it to any file."""
+        self.visit(die)
+        return self._get(die)
 
     def visit(self, die: DWARFDie) -> None:
         if self._get(die):
@@ -145,6 +439,9 @@ class Visitor:
         self._handle_unit(die)
 
     def visit_type_unit(self, die: DWARFDie):
+        if type_die := die.unit.type_die:
+            self._visit_signature(type_die)
+
         self._handle_unit(die)
 
     def _handle_unit(self, die: DWARFDie):
@@ -300,7 +597,7 @@ class Visitor:
     def visit_enumeration_type(self, die: DWARFDie) -> None:
         if die.find("DW_AT_signature"):
             sig = die.resolve_type_unit_reference()
-            self.visit(sig)
+            self._visit_signature(sig)
             enum = copy.copy(self._get(sig))
         else:
             enum = Enum(name=die.short_name)
@@ -431,8 +728,6 @@ class Visitor:
                 "DW_AT_prototyped",
                 "DW_AT_artificial",
                 "DW_AT_specification",
-                "DW_AT_vtable_elem_location",
-                "DW_AT_containing_type",  # used by llvm to link a vtable back to the type for which it was created
                 "DW_AT_reference",
                 "DW_AT_rvalue_reference",
                 "DW_AT_external",
@@ -461,6 +756,11 @@ class Visitor:
                     assert function.virtuality != VirtualityAttribute.NONE, "Expected non-NONE virtuality"
                 case "DW_AT_deleted":
                     function.is_deleted = True
+                case "DW_AT_vtable_elem_location":
+                    function.vtable_slot = vtable_slot(attribute.value)
+                case "DW_AT_containing_type":
+                    # the class whose vtable holds the slot, used by llvm to link a vtable back to its class
+                    function.containing_type = self._resolve_type(attribute.value.as_referenced_die())
                 case _:
                     raise ValueError(f"Unhandled attribute {attribute.name}")
 
@@ -527,31 +827,35 @@ class Visitor:
                 case _:
                     raise ValueError(f"Unhandled child tag {child.tag}")
 
+        function.linkage_name = die.linkage_name
+        if low_pc := die.find("DW_AT_low_pc"):
+            # functions discarded by the linker start at 0
+            function.address = low_pc.as_address() or None
+            if spec is not None:
+                declaration.address = declaration.address or function.address
+
+            for contribution in self._contributions:
+                if isinstance(contribution, UnitContribution):
+                    contribution.addresses.append((die.offset, [function] if spec is None else [function, declaration]))
+
         # sync parameter names from definition to declaration
         key = None
-        if die.linkage_name:
+        if function.linkage_name:
             # c++ functions with external linkage
-            key = f"{die.linkage_name}@{len(function.parameters)}"
+            key = (function.linkage_name, len(function.parameters))
         elif die.find("DW_AT_external") and not is_member_function and die.short_name:
             # c functions with external linkage
-            key = f"{die.short_name}@{len(function.parameters)}"
+            key = (die.short_name, len(function.parameters))
 
         if key:
-            self._functions[key].append(function)
+            functions = [function]
             # if this is a definition of a class constructor, it has a DW_AT_specification pointing to the
             # declaration with no DW_AT_linkage_name. Since we know the relationship, we can manually add the
             # declaration to the function map
             if spec and not spec.linkage_name:
-                self._functions[key].append(self._get(spec))
+                functions.append(self._get(spec))
 
-            if key not in self._param_names:
-                self._param_names[key] = [p.name for p in function.parameters]
-            else:
-                param_names = self._param_names[key]
-                assert len(param_names) == len(function.parameters), "Parameter count mismatch"
-                for i, param in enumerate(function.parameters):
-                    if param_names[i] is None and param.name is not None:
-                        param_names[i] = param.name
+            self._register_function(key, functions, [p.name for p in function.parameters])
 
         if template_params:
             function.template = Template(name="")  # without declaration as there is no trivial way to infer that
@@ -720,6 +1024,20 @@ class Visitor:
             self.visit(child)
 
     def _add(self, filepath: str, lineno: int, obj: Object) -> None:
+        for contribution in self._contributions:
+            if isinstance(contribution, UnitContribution):
+                contribution.objects.append((filepath, lineno, obj))
+
+        if self._selection is not None and filepath not in self._selection:
+            return
+
+        if filepath in self._finalized:
+            # the file has already been yielded, this only happens with references across units that the line
+            # tables and the abbreviations of the units did not predict
+            logger.debug(f"Dropping {obj.kind} {obj.name} from finalized file {filepath}")
+            self.dropped += 1
+            return
+
         file = self._files[filepath]
         lines = file[lineno]
 
@@ -733,19 +1051,43 @@ class Visitor:
         if not template.declaration:
             return None
 
-        templates = self._templates[key][lineno]
-
         # make a copy for template declaration
         template = copy.copy(template)
         template.parameters = [p.to_declaration() for p in template.parameters]
 
+        if not self._insert_template(key, lineno, template):
+            return None
+
+        return template
+
+    def _insert_template(self, key: str | int, lineno: int, template: Template) -> bool:
+        templates = self._templates[key][lineno]
+
         # try to merge with existing templates
         for t in templates:
             if t.merge(template):
-                return None
+                return False
 
         templates.append(template)
-        return template
+        return True
+
+    def _register_function(
+        self, key: tuple[str, int], functions: list[Function], param_names: list[str | None]
+    ) -> None:
+        for contribution in self._contributions:
+            contribution.functions.append((key, functions, param_names))
+
+        self._dirty_functions.add(key)
+        self._functions[key].extend(functions)
+
+        if key not in self._param_names:
+            self._param_names[key] = list(param_names)
+        else:
+            names = self._param_names[key]
+            assert len(names) == len(param_names), "Parameter count mismatch"
+            for i, name in enumerate(param_names):
+                if names[i] is None and name is not None:
+                    names[i] = name
 
     def _handle_attribute(self, die: DWARFDie) -> None:
         if not die.decl_file or not die.decl_line or not die.short_name:
@@ -756,7 +1098,7 @@ class Visitor:
             assert spec.tag == "DW_TAG_member", "Expected DW_TAG_member"
             return
 
-        variable = Attribute(name=die.short_name)
+        variable = Attribute(name=die.short_name, linkage_name=die.linkage_name)
         ty = die.find("DW_AT_type")
         ty = ty.as_referenced_die().resolve_type_unit_reference()
         if ty.short_name is None and ty.tag in {
@@ -810,7 +1152,9 @@ class Visitor:
                 case "DW_AT_accessibility":
                     variable.access = AccessAttribute(attribute.value.as_constant())
                 case "DW_AT_data_member_location":
-                    pass
+                    # location descriptions (DWARF v2) are not supported, only constant offsets
+                    if not attribute.value.form.startswith(("DW_FORM_block", "DW_FORM_exprloc")):
+                        variable.offset = attribute.value.as_constant()
                 case "DW_AT_bit_size":
                     variable.bit_size = attribute.value.as_constant()
                 case _:
@@ -846,7 +1190,7 @@ class Visitor:
         signature = die.find("DW_AT_signature")
         if signature is not None:
             signature = die.resolve_type_unit_reference()
-            self.visit(signature)
+            self._visit_signature(signature)
             declaration = self._get(signature)
             assert declaration is not None, "Expected valid declaration"
             struct = copy.deepcopy(declaration)
@@ -861,7 +1205,6 @@ class Visitor:
                 "DW_AT_decl_file",
                 "DW_AT_decl_line",
                 "DW_AT_calling_convention",
-                "DW_AT_byte_size",  # TODO: this can be useful
                 "DW_AT_declaration",
                 "DW_AT_containing_type",
                 "DW_AT_export_symbols",
@@ -872,12 +1215,17 @@ class Visitor:
             match attribute.name:
                 case "DW_AT_alignment":
                     struct.alignment = attribute.value.as_constant()
+                case "DW_AT_byte_size":
+                    struct.byte_size = attribute.value.as_constant()
                 case "DW_AT_accessibility":
                     struct.access = AccessAttribute(attribute.value.as_constant())
                 case _:
                     print(die.dump())
                     raise ValueError(f"Unhandled attribute {attribute.name}")
 
+        if signature is None and struct.byte_size is not None:
+            struct.layout = self._struct_layout(die, struct.byte_size)
+
         self._set(die, struct)
 
         template_params = []
@@ -965,6 +1313,8 @@ class Visitor:
             declaration.bases = []
             declaration.members = {}
             declaration.alignment = None
+            declaration.byte_size = None
+            declaration.layout = None
             declaration.is_declaration = True
 
             struct.template = Template(name="", declaration=declaration)
@@ -972,14 +1322,63 @@ class Visitor:
                 self.visit(template_param)
                 struct.template.parameters.append(self._get(template_param))
 
+    def _struct_layout(self, die: DWARFDie, byte_size: int) -> StructLayout:
+        """Lay out the non-static data members and the non-virtual bases of a struct, class or union."""
+        layout = StructLayout(byte_size=byte_size, alignment=die.type_alignment)
+        for child in die.children:
+            if child.tag not in {"DW_TAG_member", "DW_TAG_inheritance"}:
+                continue
+
+            if child.find("DW_AT_external") or child.find("DW_AT_declaration"):
+                # static data members, used by DWARFv4 and earlier
+                continue
+
+            ty = child.find("DW_AT_type").as_referenced_die().resolve_type_unit_reference()
+            member = LayoutMember(
+                name=child.short_name or "",
+                type=self._resolve_type(ty),
+                offset=0,
+                byte_size=ty.type_size,
+                is_base=child.tag == "DW_TAG_inheritance",
+            )
+
+            # members of a union have no location
+            if location := child.find("DW_AT_data_member_location"):
+                if location.form.startswith(("DW_FORM_block", "DW_FORM_exprloc")):
+                    # virtual bases are located at run time
+                    continue
+                member.offset = location.as_constant()
+
+            if bit_size := child.find("DW_AT_bit_size"):
+                member.bit_size = bit_size.as_constant()
+                if data_bit_offset := child.find("DW_AT_data_bit_offset"):
+                    member.offset = data_bit_offset.as_constant()
+                elif bit_offset := child.find("DW_AT_bit_offset"):
+                    # DWARFv2 and v3 count from the most significant bit of the storage unit
+                    storage = child.find("DW_AT_byte_size")
+                    storage = storage.as_constant() if storage else member.byte_size or 0
+                    if self.context.is_little_endian:
+                        member.offset = (member.offset + storage) * 8 - bit_offset.as_constant() - member.bit_size
+                    else:
+                        member.offset = member.offset * 8 + bit_offset.as_constant()
+                else:
+                    member.offset *= 8
+
+            layout.members.append(member)
+
+        return layout
+
     def _get(self, die: DWARFDie) -> Any | None:
-        key = (die.unit.is_type_unit, die.offset)
-        return self._objects.get(key, None)
+        objects = self._type_unit_objects if die.unit.is_type_unit else self._objects
+        return objects.get(die.offset, None)
 
     def _set(self, die: DWARFDie, obj) -> None:
-        key = (die.unit.is_type_unit, die.offset)
-        assert key not in self._objects
-        self._objects[key] = obj
+        objects = self._type_unit_objects if die.unit.is_type_unit else self._objects
+        assert die.offset not in objects
+        objects[die.offset] = obj
+
+        if isinstance(obj, Object) and not die.unit.is_type_unit:
+            obj.die_offset = die.offset
 
     def _resolve_type(self, die: DWARFDie, split=False) -> str | tuple[str, str]:
         die = die.resolve_type_unit_reference()
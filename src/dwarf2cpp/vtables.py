@@ -0,0 +1,232 @@
+import logging
+import struct
+from dataclasses import dataclass, field, replace
+from pathlib import Path
+
+from .layout import iter_struct_layouts
+from .models import Function, Object, function_signature
+from .reflection import cpp_string, fnv1a
+from .render import create_environment
+
+logger = logging.getLogger("dwarf2cpp")
+
+MAGIC = b"D2CVTBL\0"
+
+# Bump this whenever the layout of the file changes.
+VTABLE_SLOTS_VERSION = 1
+
+# all fields are little-endian, see templates/vtables.jinja for the matching C++ structs
+_HEADER = struct.Struct("<8sIII4xQQ")
+_CLASS = struct.Struct("<QIII4x")
+_SLOT = struct.Struct("<IIIIi")
+
+
+@dataclass
+class VTableSlot:
+    # name and parameter types, e.g. "update(float)"
+    function: str
+    linkage_name: str | None
+    index: int
+    # offset of the vtable pointer in the class, 0 for the primary vtable
+    offset: int
+    # class declaring the final overrider
+    defined_in: str
+
+
+@dataclass
+class _ClassInfo:
+    # non-virtual bases and their offsets
+    bases: list[tuple[str, int]] = field(default_factory=list)
+    # (function, linkage name, slot, containing type)
+    virtuals: list[tuple[str, str | None, int, str | None]] = field(default_factory=list)
+
+
+class VTableResolver:
+    """
+    Resolve the vtable slots of every virtual function of the classes collected so far, including the slots they
+    inherit.
+
+    A base at offset 0 shares the primary vtable of the class, while the vtables of the other non-virtual bases keep
+    their own slots at the offset of the base. Virtual bases are located at run time and are left out.
+    """
+
+    def __init__(self):
+        self._classes: dict[str, _ClassInfo] = {}
+        self._cache: dict[str, list[VTableSlot]] = {}
+
+    @property
+    def names(self) -> list[str]:
+        return list(self._classes)
+
+    def add_file(self, file: dict[int, list[Object]]) -> None:
+        for name, struct_, _ in iter_struct_layouts(file):
+            if name in self._classes:
+                continue
+
+            info = _ClassInfo()
+            info.bases = [(member.type, member.offset) for member in struct_.layout.members if member.is_base]
+            for members in struct_.members.values():
+                for member in members:
+                    if isinstance(member, Function) and member.vtable_slot is not None:
+                        signature = member.name + function_signature(member)
+                        info.virtuals.append(
+                            (signature, member.linkage_name, member.vtable_slot, member.containing_type)
+                        )
+
+            self._classes[name] = info
+            self._cache.clear()
+
+    def slots(self, name: str) -> list[VTableSlot]:
+        """The slots of a class, by vtable offset and index."""
+        return sorted(self._resolve(name), key=lambda slot: (slot.offset, slot.index))
+
+    def _resolve(self, name: str) -> list[VTableSlot]:
+        if name in self._cache:
+            return self._cache[name]
+
+        self._cache[name] = []  # guards against cycles through malformed bases
+        info = self._classes.get(name)
+        if info is None:
+            return []
+
+        slots: dict[tuple[int, int], VTableSlot] = {}
+        for base, base_offset in info.bases:
+            for slot in self._resolve(base):
+                slots[base_offset + slot.offset, slot.index] = replace(slot, offset=base_offset + slot.offset)
+
+        for signature, linkage_name, index, containing_type in info.virtuals:
+            # In the Itanium C++ ABI, every virtual function declared in a class has a slot in its primary vtable,
+            # either the slot it overrides in the primary base or a new one, including the overriders of functions of
+            # the secondary bases. DW_AT_containing_type may still name the base holding the vtable pointer.
+            offset = 0
+            if containing_type and containing_type != name:
+                offset = self._base_offset(name, containing_type) or 0
+            slots[offset, index] = VTableSlot(signature, linkage_name, index, offset, name)
+
+            # an overrider also replaces the slots it overrides in the vtables of the secondary bases, through a
+            # thunk, and the slot of the primary base when a covariant return type needed a new one
+            for key, slot in slots.items():
+                if key != (offset, index) and _overrides(signature, slot.function):
+                    slots[key] = replace(slot, linkage_name=linkage_name, defined_in=name)
+
+        self._cache[name] = list(slots.values())
+        return self._cache[name]
+
+    def _base_offset(self, name: str, base: str, depth: int = 0) -> int | None:
+        info = self._classes.get(name)
+        if info is None or depth > 64:
+            return None
+
+        for base_name, base_offset in info.bases:
+            if base_name == base:
+                return base_offset
+            if (offset := self._base_offset(base_name, base, depth + 1)) is not None:
+                return base_offset + offset
+
+        return None
+
+
+class VTableSlots:
+    """
+    Writer of the vtable slot of every virtual function of every class, to a compact binary table and to a C++
+    header with the same table as constexpr data.
+
+    The slots of a class include the ones it inherits, as resolved by VTableResolver. Bases can be defined in any
+    file, so the classes are collected until close.
+    """
+
+    def __init__(self, path: Path, namespace: str = "dwarf2cpp::vtables"):
+        if path.suffix == ".h":
+            raise ValueError(f"The vtable slots {path} would be overwritten by their header, use another suffix")
+
+        self._path = path
+        self._namespace = namespace
+        self._resolver = VTableResolver()
+
+    def __enter__(self) -> "VTableSlots":
+        return self
+
+    def __exit__(self, exc_type, *args) -> None:
+        # classes whose files were not visited would be missing from a table that looks complete
+        if exc_type is None:
+            self.close()
+
+    @property
+    def header_path(self) -> Path:
+        return self._path.with_suffix(".h")
+
+    def add_file(self, rel_path: str, file: dict[int, list[Object]]) -> None:
+        self._resolver.add_file(file)
+
+    def close(self) -> None:
+        classes = []
+        for name in self._resolver.names:
+            slots = self._resolver.slots(name)
+            if slots:
+                classes.append((name, slots))
+
+        logger.info(f"Writing the vtable slots of {len(classes)} classes to {self._path}")
+        self._write_table(classes)
+
+        # the header looks slots up by class and function with a binary search
+        slots = sorted(
+            ((name, slot) for name, class_slots in classes for slot in class_slots),
+            key=lambda item: (item[0].encode(), item[1].function.encode(), item[1].offset),
+        )
+
+        env = create_environment()
+        env.filters["cpp_string"] = cpp_string
+        content = env.get_template("vtables.jinja").render(
+            namespace=self._namespace,
+            magic=list(MAGIC),
+            version=VTABLE_SLOTS_VERSION,
+            header_size=_HEADER.size,
+            class_size=_CLASS.size,
+            slot_size=_SLOT.size,
+            slots=slots,
+        )
+        self.header_path.write_text(content)
+
+    def _write_table(self, classes: list[tuple[str, list[VTableSlot]]]) -> None:
+        strings = bytearray(b"\0")
+        offsets: dict[str, int] = {}
+
+        def intern(value: str | None) -> int:
+            if not value:
+                return 0
+            if value not in offsets:
+                offsets[value] = len(strings)
+                strings.extend(value.encode() + b"\0")
+            return offsets[value]
+
+        class_records = []
+        slot_records = []
+        for h, name, slots in sorted((fnv1a(name.encode()), name, slots) for name, slots in classes):
+            class_records.append(_CLASS.pack(h, intern(name), len(slot_records), len(slots)))
+            for slot in slots:
+                slot_records.append(
+                    _SLOT.pack(
+                        intern(slot.function),
+                        intern(slot.linkage_name),
+                        intern(slot.defined_in),
+                        slot.index,
+                        slot.offset,
+                    )
+                )
+
+        strings_offset = _HEADER.size + _CLASS.size * len(class_records) + _SLOT.size * len(slot_records)
+        with self._path.open("wb") as f:
+            f.write(
+                _HEADER.pack(
+                    MAGIC, VTABLE_SLOTS_VERSION, len(class_records), len(slot_records), strings_offset, len(strings)
+                )
+            )
+            f.writelines(class_records)
+            f.writelines(slot_records)
+            f.write(strings)
+
+
+def _overrides(signature: str, function: str) -> bool:
+    # The signatures include the parameter types and the const qualifier, so "g() const" does not override "g()".
+    # A class has a single destructor, which overrides the ones of its bases whatever their names.
+    return signature == function or (signature.startswith("~") and function.startswith("~"))
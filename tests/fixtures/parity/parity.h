@@ -0,0 +1,85 @@
+// Declarations shared by the units of the parity fixture, see the native_parity CI job. Each unit
+// references them, so that they are merged across units and, with LTO, referenced across units.
+
+#pragma once
+
+#include <cstdint>
+
+namespace parity {
+
+struct Flags {
+    std::uint32_t enabled : 1;
+    std::uint32_t mode : 3;
+    std::uint32_t : 0;
+    std::uint32_t level : 12;
+    bool dirty;
+    std::int8_t delta : 4;
+};
+
+union Value {
+    std::int64_t integer;
+    double real;
+    struct {
+        std::uint32_t low;
+        std::uint32_t high;
+    } parts;
+};
+
+template <typename T, int N>
+struct Array {
+    T items[N];
+    int size() const { return N; }
+    T &at(int index) { return items[index]; }
+};
+
+template <typename T>
+struct Array<T, 0> {
+    int size() const { return 0; }
+};
+
+template <typename Key, typename Value = int>
+class Map {
+public:
+    Value lookup(const Key &key) const;
+
+private:
+    Array<Key, 4> keys_;
+    Array<Value, 4> values_;
+};
+
+template <typename T>
+T clamp(T value, T low, T high) {
+    return value < low ? low : (high < value ? high : value);
+}
+
+class Shape {
+public:
+    virtual ~Shape();
+    virtual double area() const = 0;
+    virtual const char *name() const;
+
+protected:
+    Flags flags_;
+};
+
+class Named {
+public:
+    virtual ~Named();
+    virtual const char *name() const;
+};
+
+class Circle final : public Shape, public Named {
+public:
+    explicit Circle(double radius);
+    ~Circle() override;
+    double area() const override;
+    const char *name() const override;
+
+private:
+    double radius_;
+};
+
+double total_area(const Shape *const *shapes, int count);
+Value to_value(const Flags &flags);
+
+} // namespace parity
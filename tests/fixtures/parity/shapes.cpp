@@ -0,0 +1,29 @@
+#include "parity.h"
+
+namespace parity {
+
+Shape::~Shape() = default;
+
+const char *Shape::name() const { return "shape"; }
+
+Named::~Named() = default;
+
+const char *Named::name() const { return "named"; }
+
+Circle::Circle(double radius) : radius_(radius) { flags_.enabled = 1; }
+
+Circle::~Circle() = default;
+
+double Circle::area() const { return 3.14159 * radius_ * radius_; }
+
+const char *Circle::name() const { return "circle"; }
+
+double total_area(const Shape *const *shapes, int count) {
+    double total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += shapes[i]->area();
+    }
+    return clamp(total, 0.0, 1e9);
+}
+
+} // namespace parity
@@ -0,0 +1,29 @@
+#include "parity.h"
+
+namespace parity {
+
+template <typename Key, typename Value>
+Value Map<Key, Value>::lookup(const Key &key) const {
+    for (int i = 0; i < keys_.size(); ++i) {
+        if (!(keys_.items[i] < key) && !(key < keys_.items[i])) {
+            return values_.items[i];
+        }
+    }
+    return Value();
+}
+
+template class Map<int>;
+template class Map<long, double>;
+
+Value to_value(const Flags &flags) {
+    Value value{};
+    value.parts.low = flags.mode;
+    value.parts.high = flags.level;
+    return value;
+}
+
+int sum(Array<int, 3> &array, const Array<char, 0> &empty) {
+    return array.at(0) + array.size() + empty.size() + clamp(array.items[1], 0, 10);
+}
+
+} // namespace parity
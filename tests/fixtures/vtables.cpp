@@ -0,0 +1,51 @@
+// Classes whose vtables are checked against the dump of the compiler, see tests/test_vtables.py.
+
+struct Base {
+    virtual ~Base();
+    virtual void f(int);
+    virtual void g() const;
+    virtual void g();
+};
+
+struct Other {
+    virtual ~Other();
+    virtual void h();
+    virtual void g();
+    int x;
+};
+
+// overrides functions of both bases, including one only the secondary base declares, and adds
+// virtuals
+struct Derived : Base, Other {
+    ~Derived() override;
+    void g() override;
+    void h() override;
+    virtual void k();
+    virtual void f(float);
+};
+
+// overrides the const overload only, and adds virtuals after the ones of Derived
+struct Leaf : Derived {
+    void g() const override;
+    void k() override;
+    virtual void m();
+};
+
+Base::~Base() {}
+void Base::f(int) {}
+void Base::g() const {}
+void Base::g() {}
+
+Other::~Other() {}
+void Other::h() {}
+void Other::g() {}
+
+Derived::~Derived() {}
+void Derived::g() {}
+void Derived::h() {}
+void Derived::k() {}
+void Derived::f(float) {}
+
+void Leaf::g() const {}
+void Leaf::k() {}
+void Leaf::m() {}
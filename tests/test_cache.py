@@ -0,0 +1,59 @@
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+from dwarf2cpp._dwarf import DWARFContext
+from dwarf2cpp.cache import UnitCache
+from dwarf2cpp.models import Function
+from dwarf2cpp.visitor import Visitor
+
+SOURCES = {
+    "first.cpp": "int first(int x) { return x + 1; }\n",
+    "second.cpp": "int second(int x) { return x * 2; }\n",
+    "pad.cpp": "int pad(int x) {\n" + "    x = x * 7 + 3;\n" * 64 + "    return x;\n}\n",
+}
+
+
+def addresses(directory: Path, binary: str, cache: UnitCache | None = None) -> dict[str, int | None]:
+    visitor = Visitor(DWARFContext(str(directory / binary)), str(directory), cache=cache)
+    return {
+        obj.name: obj.address
+        for _, file in visitor.files
+        for objs in file.values()
+        for obj in objs
+        if isinstance(obj, Function)
+    }
+
+
+def test_relinked_binary_through_warm_cache(tmp_path):
+    if shutil.which("g++") is None:
+        pytest.skip("g++ is not available")
+
+    for name, source in SOURCES.items():
+        (tmp_path / name).write_text(source)
+        subprocess.run(["g++", "-g", "-O0", "-fPIC", "-c", name], cwd=tmp_path, check=True)
+
+    link = ["g++", "-shared", "-o"]
+    subprocess.run([*link, "before.so", "first.o", "second.o"], cwd=tmp_path, check=True)
+    # the padding comes first, which moves the code and the units of the other objects without changing them
+    subprocess.run([*link, "after.so", "pad.o", "first.o", "second.o"], cwd=tmp_path, check=True)
+
+    cache = UnitCache(tmp_path / "cache", str(tmp_path))
+    before = addresses(tmp_path, "before.so", cache)
+    expected = addresses(tmp_path, "after.so")
+    assert before["first"] != expected["first"]
+
+    hits = 0
+    load = cache.load
+
+    def counting_load(key: str):
+        nonlocal hits
+        contribution = load(key)
+        hits += contribution is not None
+        return contribution
+
+    cache.load = counting_load
+    assert addresses(tmp_path, "after.so", cache) == expected
+    assert hits == 2
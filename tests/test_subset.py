@@ -0,0 +1,82 @@
+import shutil
+import subprocess
+
+import pytest
+
+from dwarf2cpp.subset import Scrambler
+
+
+def test_identifier_is_consistent():
+    scrambler = Scrambler(seed=1)
+    result = scrambler.identifier("Actor")
+
+    assert result != "Actor"
+    assert len(result) == len("Actor")
+    assert scrambler.identifier("Actor") == result
+    assert Scrambler(seed=1).identifier("Actor") == result
+    assert Scrambler(seed=2).identifier("Actor") != result
+    assert scrambler.identifier("Mob") != result
+
+
+@pytest.mark.parametrize("word", ["int", "unsigned", "__cxa_guard", "_Tp", "x", "id"])
+def test_identifier_keeps_keywords_and_reserved_names(word):
+    assert Scrambler().identifier(word) == word
+
+
+def test_name_and_path():
+    scrambler = Scrambler()
+    ns, pair, item, actor = (scrambler.identifier(word) for word in ("ns", "Pair", "Item", "Actor"))
+
+    assert scrambler.name("ns::Pair<int, Item>") == f"{ns}::{pair}<int, {item}>"
+    assert scrambler.path("src/Actor/Item.cpp") == f"{scrambler.identifier('src')}/{actor}/{item}.cpp"
+
+
+def test_linkage_name_after_name_ending_in_prefix_letter():
+    # "AST" ends with A, S and T, which must not make the next name look like an array, a substitution or a template
+    # parameter
+    scrambler = Scrambler()
+    ast, node, eval_ = (scrambler.identifier(word) for word in ("AST", "Node", "eval"))
+
+    assert scrambler.linkage_name("_ZN3AST4Node4evalEv") == f"_ZN3{ast}4{node}4{eval_}Ev"
+
+
+@pytest.mark.parametrize(
+    "mangled, kept",
+    [
+        ("_Z6resizeRA10_i", "RA10_i"),  # array dimension
+        ("_Z6resizeDv4_f", "Dv4_f"),  # vector size
+        ("_Z6resizeILi16EEvv", "ILi16EEvv"),  # literal
+        ("_ZN6Buffer6resizeERKS_", "ERKS_"),  # substitution
+    ],
+)
+def test_linkage_name_keeps_other_numbers(mangled, kept):
+    scrambler = Scrambler()
+    result = scrambler.linkage_name(mangled)
+
+    assert len(result) == len(mangled)
+    assert result.endswith(kept)
+    assert scrambler.identifier("resize") in result
+
+
+def test_linkage_name_of_unmangled_name():
+    scrambler = Scrambler()
+    assert scrambler.linkage_name("main_loop") == scrambler.identifier("main_loop")
+
+
+@pytest.mark.skipif(shutil.which("c++filt") is None, reason="c++filt is not available")
+@pytest.mark.parametrize(
+    "mangled",
+    [
+        "_ZN3AST4Node4evalEv",
+        "_ZN5Actor6updateEf",
+        "_ZNK5Level8getActorERKS_",
+        "_ZN4Pool4takeI4ItemEEPT_v",
+        "_ZN7Storage6resizeERA16_i",
+    ],
+)
+def test_linkage_name_matches_scrambled_demangled_name(mangled):
+    def demangle(name: str) -> str:
+        return subprocess.run(["c++filt", name], capture_output=True, text=True, check=True).stdout.strip()
+
+    scrambler = Scrambler()
+    assert demangle(scrambler.linkage_name(mangled)) == scrambler.name(demangle(mangled))
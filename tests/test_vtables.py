@@ -0,0 +1,196 @@
+import re
+import shutil
+import subprocess
+from collections import defaultdict
+from pathlib import Path
+
+import pytest
+
+from dwarf2cpp._dwarf import DWARFContext
+from dwarf2cpp.models import Function, LayoutMember, Object, Parameter, Struct, StructLayout
+from dwarf2cpp.visitor import Visitor
+from dwarf2cpp.vtables import VTableResolver, VTableSlots
+
+FIXTURE = Path(__file__).parent / "fixtures" / "vtables.cpp"
+CLASSES = ["Base", "Other", "Derived", "Leaf"]
+
+
+def make_class(name: str, bases: list[tuple[str, int]], virtuals: list[tuple[str, list[str], bool, int]]) -> Struct:
+    struct = Struct(name=name, byte_size=24)
+    struct.layout = StructLayout(
+        byte_size=24, members=[LayoutMember(name="", type=base, offset=offset, is_base=True) for base, offset in bases]
+    )
+    for function, parameters, is_const, slot in virtuals:
+        struct.members[1].append(
+            Function(
+                name=function,
+                parameters=[Parameter(name="", type=ty) for ty in parameters],
+                is_const=is_const,
+                vtable_slot=slot,
+                containing_type=name,
+                linkage_name=f"{name}::{function}",
+            )
+        )
+    return struct
+
+
+def fixture_models() -> dict[int, list[Object]]:
+    """The classes of fixtures/vtables.cpp as extracted from GCC's debug info, which has no slots for destructors."""
+    file = defaultdict(list)
+    file[1] = [
+        make_class("Base", [], [("f", ["int"], False, 2), ("g", [], True, 3), ("g", [], False, 4)]),
+        make_class("Other", [], [("h", [], False, 2), ("g", [], False, 3)]),
+        make_class(
+            "Derived",
+            [("Base", 0), ("Other", 8)],
+            [("g", [], False, 4), ("h", [], False, 5), ("k", [], False, 6), ("f", ["float"], False, 7)],
+        ),
+        make_class("Leaf", [("Derived", 0)], [("g", [], True, 3), ("k", [], False, 6), ("m", [], False, 8)]),
+    ]
+    return file
+
+
+def resolved(resolver: VTableResolver, name: str) -> dict[tuple[int, int], tuple[str, str]]:
+    """(vtable offset, index) -> (function name, class defining it), destructors excepted."""
+    return {
+        (slot.offset, slot.index): (slot.function.partition("(")[0], slot.defined_in)
+        for slot in resolver.slots(name)
+        if not slot.function.startswith("~")
+    }
+
+
+def _thunk_target(mangled: str) -> str:
+    # e.g. _ZThn8_N7Derived1hEv, the function is the last component of the nested name
+    pos = mangled.index("_N") + 2
+    if mangled[pos] == "K":
+        pos += 1
+
+    name = ""
+    while (match := re.match(r"\d+", mangled[pos:])) is not None:
+        pos += len(match[0])
+        name = mangled[pos : pos + int(match[0])]
+        pos += int(match[0])
+    return name
+
+
+def parse_class_dump(text: str) -> dict[str, dict[tuple[int, int], tuple[str, str]]]:
+    """
+    The vtables of a dump of GCC's -fdump-lang-class, in the format of resolved.
+
+    Each vtable of the group starts with the offset to the top of the class and the type info, and its offset is the
+    opposite of the former. Classes with virtual bases, whose vtables start with more offsets, are not supported.
+    """
+    result = {}
+    for name, body in re.findall(r"^Vtable for (\S+)\n\S+: \d+ entries\n((?:\d+ .*\n)+)", text, re.MULTILINE):
+        slots = {}
+        offset, index = 0, 0
+        for entry in re.findall(r"^\d+\s+\(int \(\*\)\(\.\.\.\)\)(.*)$", body, re.MULTILINE):
+            if re.fullmatch(r"-?\d+", entry):
+                offset = -int(entry)
+            elif entry.startswith("(& _ZTI"):
+                index = 0
+            else:
+                defined_in, _, function = entry.rpartition("::")
+                if function.startswith("_Z"):
+                    # thunks, e.g. _ZThn8_N7Derived1hEv, including the ones of destructors, e.g. _ZThn8_N7DerivedD1Ev
+                    function = "~" if re.search(r"D[012]Ev$", function) else _thunk_target(function)
+                if not function.startswith("~"):
+                    slots[offset, index] = (function, defined_in)
+                index += 1
+
+        result[name] = slots
+    return result
+
+
+def test_resolve_fixture():
+    resolver = VTableResolver()
+    resolver.add_file(fixture_models())
+
+    # recorded from GCC 12's -fdump-lang-class of fixtures/vtables.cpp, slots 0 and 1 are the destructors
+    assert resolved(resolver, "Derived") == {
+        (0, 2): ("f", "Base"),
+        (0, 3): ("g", "Base"),
+        (0, 4): ("g", "Derived"),
+        (0, 5): ("h", "Derived"),
+        (0, 6): ("k", "Derived"),
+        (0, 7): ("f", "Derived"),
+        (8, 2): ("h", "Derived"),
+        (8, 3): ("g", "Derived"),
+    }
+    assert resolved(resolver, "Leaf") == {
+        (0, 2): ("f", "Base"),
+        (0, 3): ("g", "Leaf"),
+        (0, 4): ("g", "Derived"),
+        (0, 5): ("h", "Derived"),
+        (0, 6): ("k", "Leaf"),
+        (0, 7): ("f", "Derived"),
+        (0, 8): ("m", "Leaf"),
+        (8, 2): ("h", "Derived"),
+        (8, 3): ("g", "Derived"),
+    }
+
+
+def test_const_overload_is_a_separate_slot():
+    resolver = VTableResolver()
+    resolver.add_file(fixture_models())
+
+    slots = {slot.function: slot for slot in resolver.slots("Leaf") if slot.offset == 0}
+    assert (slots["g() const"].index, slots["g() const"].defined_in) == (3, "Leaf")
+    assert (slots["g()"].index, slots["g()"].defined_in) == (4, "Derived")
+
+
+def test_destructor_overrides_secondary_base():
+    resolver = VTableResolver()
+    file = defaultdict(list)
+    file[1] = [
+        make_class("A", [], [("~A", [], False, 0)]),
+        make_class("B", [], [("~B", [], False, 0), ("b", [], False, 2)]),
+        make_class("C", [("A", 0), ("B", 8)], [("~C", [], False, 0)]),
+    ]
+    resolver.add_file(file)
+
+    slots = {(slot.offset, slot.index): slot for slot in resolver.slots("C")}
+    assert slots[0, 0].function == "~C()"
+    assert slots[8, 0].defined_in == "C"
+    assert slots[8, 2].defined_in == "B"
+
+
+def test_table_cannot_be_overwritten_by_its_header(tmp_path):
+    with pytest.raises(ValueError):
+        VTableSlots(tmp_path / "slots.h")
+
+
+@pytest.fixture(scope="module")
+def gcc_dump(tmp_path_factory) -> tuple[Path, dict[str, dict[tuple[int, int], tuple[str, str]]]]:
+    if (
+        shutil.which("g++") is None
+        or "clang" in subprocess.run(["g++", "--version"], capture_output=True, text=True).stdout
+    ):
+        pytest.skip("GCC is not available")
+
+    directory = tmp_path_factory.mktemp("vtables")
+    source = directory / FIXTURE.name
+    shutil.copy(FIXTURE, source)
+    subprocess.run(["g++", "-g", "-c", "-fdump-lang-class", source.name, "-o", "vtables.o"], cwd=directory, check=True)
+    dump = parse_class_dump(next(directory.glob("*.class")).read_text())
+    return directory, dump
+
+
+def test_fixture_matches_gcc_dump(gcc_dump):
+    _, dump = gcc_dump
+    resolver = VTableResolver()
+    resolver.add_file(fixture_models())
+
+    for name in CLASSES:
+        assert resolved(resolver, name) == dump[name], name
+
+
+def test_extracted_slots_match_gcc_dump(gcc_dump):
+    directory, dump = gcc_dump
+    resolver = VTableResolver()
+    visitor = Visitor(DWARFContext(str(directory / "vtables.o")), str(directory))
+    for _, file in visitor.files:
+        resolver.add_file(file)
+
+    for name in CLASSES:
+        assert resolved(resolver, name) == dump[name], name